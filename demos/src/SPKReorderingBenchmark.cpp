@@ -0,0 +1,119 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2011 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+#include <SPARK.h>
+
+// Measures the time spent in the update of a large group with the spatial reordering of the particles enabled and disabled
+// No rendering is performed so that only the update is timed
+
+const size_t NB_PARTICLES = 200000;
+const size_t NB_WARMUP_UPDATES = 10;
+const size_t NB_UPDATES = 100;
+const float DELTA_TIME = 0.01f;
+const float RADIUS = 0.01f;
+const float BOX_SIZE = 4.0f;
+
+float randomFloat(float min,float max)
+{
+	return min + (max - min) * (static_cast<float>(std::rand()) / RAND_MAX);
+}
+
+// Creates a system with a single group whose particles are added at the given positions and velocities
+SPK::Ref<SPK::System> createSystem(const std::vector<SPK::Vector3D>& positions,const std::vector<SPK::Vector3D>& velocities,unsigned int reorderingPeriod)
+{
+	SPK::Ref<SPK::System> particleSystem = SPK::System::create(true);
+
+	SPK::Ref<SPK::Group> particleGroup = particleSystem->createGroup(NB_PARTICLES);
+	particleGroup->setImmortal(true);
+	particleGroup->setRadius(RADIUS);
+	particleGroup->setSpatialReorderingPeriod(reorderingPeriod);
+	particleGroup->addModifier(SPK::Collider::create(0.8f,SPK::COLLIDER_BROADPHASE_GRID));
+	particleGroup->addModifier(SPK::Friction::create(0.2f));
+
+	// Particles are added in a random order so that neighbors in space are far apart in memory
+	for (size_t i = 0; i < NB_PARTICLES; ++i)
+		particleGroup->addParticles(1,positions[i],velocities[i]);
+	particleGroup->flushBufferedParticles();
+
+	return particleSystem;
+}
+
+// Returns the mean time of an update in milliseconds
+double timeUpdates(const SPK::Ref<SPK::System>& particleSystem)
+{
+	for (size_t i = 0; i < NB_WARMUP_UPDATES; ++i)
+		particleSystem->updateParticles(DELTA_TIME);
+
+	std::clock_t start = std::clock();
+	for (size_t i = 0; i < NB_UPDATES; ++i)
+		particleSystem->updateParticles(DELTA_TIME);
+	std::clock_t end = std::clock();
+
+	return 1000.0 * (end - start) / CLOCKS_PER_SEC / NB_UPDATES;
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+	SPK::System::setClampStep(false);
+	SPK::System::useRealStep();
+
+	// The same particles are used for both runs
+	std::srand(1);
+	std::vector<SPK::Vector3D> positions(NB_PARTICLES);
+	std::vector<SPK::Vector3D> velocities(NB_PARTICLES);
+	for (size_t i = 0; i < NB_PARTICLES; ++i)
+	{
+		const float halfSize = BOX_SIZE * 0.5f;
+		positions[i].set(randomFloat(-halfSize,halfSize),randomFloat(-halfSize,halfSize),randomFloat(-halfSize,halfSize));
+		velocities[i].set(randomFloat(-0.1f,0.1f),randomFloat(-0.1f,0.1f),randomFloat(-0.1f,0.1f));
+	}
+
+	std::cout << "SPARK spatial reordering benchmark" << std::endl;
+	std::cout << NB_PARTICLES << " particles, " << NB_UPDATES << " updates" << std::endl;
+
+	double timeWithout = 0.0;
+	double timeWith = 0.0;
+
+	{
+	SPK::Ref<SPK::System> particleSystem = createSystem(positions,velocities,0);
+	timeWithout = timeUpdates(particleSystem);
+	}
+
+	{
+	SPK::Ref<SPK::System> particleSystem = createSystem(positions,velocities,1);
+	timeWith = timeUpdates(particleSystem);
+	}
+
+	std::cout << "Reordering disabled : " << timeWithout << " ms per update" << std::endl;
+	std::cout << "Reordering enabled  : " << timeWith << " ms per update" << std::endl;
+	if (timeWith > 0.0)
+		std::cout << "Speedup : " << timeWithout / timeWith << std::endl;
+
+	SPK_DUMP_MEMORY
+
+	return 0;
+}
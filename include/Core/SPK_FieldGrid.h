@@ -0,0 +1,172 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_FIELDGRID
+#define H_SPK_FIELDGRID
+
+#include <string>
+#include <vector>
+
+namespace SPK
+{
+	/**
+	* @brief A grid of samples of a field stretched over a box
+	*
+	* The grid holds a fixed number of floats per node along 2 or 3 axes.
+	* Nodes are ordered by the first axis first : the node (i,j,k) starts at (i + (j + k * height) * width) * nbComponents.<br>
+	* <br>
+	* The data is either owned by the grid (copied from memory or loaded from a raw binary file)
+	* or referenced from an external buffer such as a memory mapped file, which must remain valid as long as the grid uses it.
+	* When the grid is copied, owned data is copied as well while external data is shared.<br>
+	* <br>
+	* A raw binary file starts with the number of nodes along each axis as unsigned 32 bits integers
+	* followed by the data as 32 bits floats, in the native endianness.<br>
+	* <br>
+	* It is used by the objects sampling a grid in a box (VectorField, Heightfield, DistanceField).
+	* Sampling is left to them as the interpolation depends on the meaning of the data.
+	*/
+	class SPK_PREFIX FieldGrid
+	{
+	public :
+
+		/**
+		* @brief Creates an empty grid
+		* @param nbAxes : the number of axes of the grid (2 or 3)
+		* @param nbComponents : the number of floats per node
+		* @param minNodes : the minimum number of nodes along each axis for the grid to be valid
+		*/
+		FieldGrid(size_t nbAxes,size_t nbComponents,size_t minNodes = 1);
+
+		FieldGrid(const FieldGrid& grid);
+		FieldGrid& operator=(const FieldGrid& grid);
+
+		/**
+		* @brief Tells whether a grid is valid
+		* @param dimensions : the number of nodes along each axis
+		* @param data : the data of the grid
+		* @return true if there are enough nodes along each axis and data, false if not
+		*/
+		bool isValid(const size_t* dimensions,const float* data) const;
+
+		/**
+		* @brief Sets the grid by copying the given data
+		* @param dimensions : the number of nodes along each axis
+		* @param data : the data of the grid
+		* @return true if the grid is set, false if it is not valid
+		*/
+		bool setData(const size_t* dimensions,const float* data);
+
+		/**
+		* @brief Sets the grid by swapping the given data
+		* The data is left with the previous content of the grid if it was owned, empty otherwise.
+		* @param dimensions : the number of nodes along each axis
+		* @param data : the data of the grid
+		* @return true if the grid is set, false if it is not valid
+		*/
+		bool swapData(const size_t* dimensions,std::vector<float>& data);
+
+		/**
+		* @brief Sets the grid from an external buffer without copying it
+		* @param dimensions : the number of nodes along each axis
+		* @param data : the data of the grid
+		* @return true if the grid is set, false if it is not valid
+		*/
+		bool setExternalData(const size_t* dimensions,const float* data);
+
+		/**
+		* @brief Loads the grid from a raw binary file
+		* Errors are logged and leave the grid unchanged.
+		* @param path : the path of the file
+		* @return true if the grid was loaded, false if not
+		*/
+		bool loadFromFile(const std::string& path);
+
+		/**
+		* @brief Saves the grid to a raw binary file
+		* Errors are logged.
+		* @param path : the path of the file
+		* @return true if the grid was saved, false if not
+		*/
+		bool saveToFile(const std::string& path) const;
+
+		/**
+		* @brief Gets the file of the grid
+		* @return the path of the file of the grid or an empty string if the grid was not loaded from a file
+		*/
+		const std::string& getFile() const;
+
+		/**
+		* @brief Gets the number of nodes along an axis
+		* @param axis : the index of the axis
+		* @return the number of nodes along the axis or 0 if the grid is not set
+		*/
+		size_t getDimension(size_t axis) const;
+
+		/**
+		* @brief Gets the data of the grid
+		* @return the data of the grid or NULL if the grid is not set
+		*/
+		const float* getData() const;
+
+		/**
+		* @brief Computes the rows of the matrix mapping an offset in a box into coordinates in [0,1]
+		*
+		* The box is defined by the offsets of its 3 edges from its origin.
+		* The coordinate along an edge of an offset is its dot product with the row of the edge.<br>
+		* If the box is flat, rows are set to null vectors.
+		*
+		* @param edges : the 3 edges of the box
+		* @param rows : the array where to store the 3 rows
+		* @return true if the rows are computed, false if the box is flat
+		*/
+		static bool computeBoxRows(const Vector3D* edges,Vector3D* rows);
+
+	private :
+
+		size_t nbAxes;
+		size_t nbComponents;
+		size_t minNodes;
+
+		size_t dimensions[3];
+		std::vector<float> ownData;
+		const float* data;
+		std::string file;
+
+		size_t getNbFloats(const size_t* dimensions) const;
+	};
+
+	inline const std::string& FieldGrid::getFile() const
+	{
+		return file;
+	}
+
+	inline size_t FieldGrid::getDimension(size_t axis) const
+	{
+		return dimensions[axis];
+	}
+
+	inline const float* FieldGrid::getData() const
+	{
+		return data;
+	}
+}
+
+#endif
@@ -124,6 +124,7 @@ namespace SPK
 		const void* getColorAddress() const;
 		const void* getPositionAddress() const;
 		const void* getVelocityAddress() const;
+		const void* getOldPositionAddress() const;
 		const void* getParamAddress(Param param) const;
 
 		void setRadius(float radius);
@@ -292,6 +293,54 @@ namespace SPK
 
 		void flushBufferedParticles();
 
+		/**
+		* @brief Emits Particles immediately at several positions
+		*
+		* Unlike addParticles methods, the Particles are not buffered but created right away, one per position.
+		* Each Particle is generated by the Emitter as if its Zone was at the given position. The transform of the Emitter is not modified.<br>
+		* This avoids the cost of the creation buffer when spawning many Particles from many sources.<br>
+		* <br>
+		* As with addParticles methods, the number of Particles is deduced from the tank of the Emitter.
+		* Particles are created as long as the tank is not empty and the Group has room for them.
+		* This must not be called on a Group during its own update : use addParticles methods instead.
+		*
+		* @param emitter : the Emitter used to generate the Particles
+		* @param nb : the number of Particles to emit
+		* @param positions : the positions of the Particles
+		* @return the number of Particles actually emitted
+		*/
+		size_t emitParticles(const Ref<Emitter>& emitter,size_t nb,const Vector3D* positions);
+
+		/**
+		* @brief Queues the spawning of Particles at a position
+		*
+		* The Particles are generated by the Emitter as if its Zone was at the given position. The transform of the Emitter is not modified.<br>
+		* Requests are stored in a flat array and executed all at once at the next update of the Group (or at the next call to flushBufferedParticles()).
+		* No Emitter is copied, which makes this method suited to spawn Particles from actions.<br>
+		* As with addParticles methods, the number of Particles is deduced from the tank of the Emitter when the request is executed.
+		*
+		* @param nb : the number of Particles to spawn
+		* @param position : the position at which to spawn the Particles
+		* @param emitter : the Emitter used to generate the Particles
+		*/
+		void spawnParticles(unsigned int nb,const Vector3D& position,const Ref<Emitter>& emitter);
+
+		////////////////////
+		// Kill Particles //
+		////////////////////
+
+		/**
+		* @brief Kills several consecutive Particles at once
+		*
+		* This is the bulk version of Particle::kill() meant to be used with a mask computed by batch (for instance by a zone test).<br>
+		* Dead Particles are removed all at once at the end of the update, after the death action was applied to all of them.
+		*
+		* @param begin : the index of the first Particle
+		* @param nb : the number of Particles
+		* @param mask : the mask telling which Particles to kill (non zero to kill)
+		*/
+		void killParticles(size_t begin,size_t nb,const unsigned char* mask);
+
 		Ref<System> getSystem() const;
 
 		/////////////
@@ -361,6 +410,137 @@ namespace SPK
 		*/
 		Octree* getOctree();
 
+		/**
+		* @brief Sets the maximum depth of the octree of this group
+		* The level 0 is the root of the octree. The maximum level cannot exceed Octree::MAX_LEVEL_LIMIT.
+		* @param maxLevel : the maximum level of the cells
+		*/
+		void setOctreeMaxLevel(unsigned int maxLevel);
+
+		/**
+		* @brief Gets the maximum depth of the octree of this group
+		* @return the maximum level of the cells
+		*/
+		unsigned int getOctreeMaxLevel() const;
+
+		/**
+		* @brief Sets the number of particles from which a cell of the octree is split
+		* Cells at the maximum level are never split and can hold more particles.
+		* @param maxParticlesPerCell : the maximum number of particles per cell
+		*/
+		void setOctreeMaxParticlesPerCell(unsigned int maxParticlesPerCell);
+
+		/**
+		* @brief Gets the number of particles from which a cell of the octree is split
+		* @return the maximum number of particles per cell
+		*/
+		unsigned int getOctreeMaxParticlesPerCell() const;
+
+		/**
+		* @brief Enables or disables the refit of the octree
+		*
+		* When the refit is enabled, the octree keeps its structure from one update to the next
+		* and only the particles whose cells changed are moved.
+		* The octree is fully rebuilt only when the particles leave its bounds or gather in a much smaller volume.<br>
+		* This is well suited to groups that move slowly such as smoke or snow.
+		*
+		* @param refit : true to enable the refit, false to rebuild the octree at every update
+		*/
+		void enableOctreeRefit(bool refit);
+
+		/**
+		* @brief Tells whether the refit of the octree is enabled
+		* @return true if the refit is enabled, false if not
+		*/
+		bool isOctreeRefitEnabled() const;
+
+		/**
+		* @brief Enables or disables the linear build of the octree
+		*
+		* When the linear build is enabled, the Morton codes of the particles are sorted with a radix sort
+		* and the cells are derived from the sorted codes instead of being split while particles are inserted one by one.
+		* The resulting octree is queried the same way.
+		*
+		* @param linearBuild : true to enable the linear build, false to use the insertion build
+		*/
+		void enableOctreeLinearBuild(bool linearBuild);
+
+		/**
+		* @brief Tells whether the linear build of the octree is enabled
+		* @return true if the linear build is enabled, false if not
+		*/
+		bool isOctreeLinearBuildEnabled() const;
+
+		/**
+		* @brief Sets the period of the spatial reordering of the particles
+		*
+		* Particles are stored in the order they are born and swapped at death, so particles close in space are usually far from each other in memory.<br>
+		* When the spatial reordering is enabled, the particles are periodically sorted along a Morton curve at the beginning of the update,
+		* which improves the cache locality of the octree, of the Collider and of any modifier working on neighbors.<br>
+		* <br>
+		* All the data of the particles, including the data of the modifiers, interpolators and renderer, are moved with the particles.
+		* Indices of particles are therefore not stable across a reordering.<br>
+		* The reordering is not performed while the sorting of particles is enabled as it would be undone at rendering.
+		*
+		* @param period : the number of updates between two reorderings, 0 to disable the reordering
+		*/
+		void setSpatialReorderingPeriod(unsigned int period);
+
+		/**
+		* @brief Gets the period of the spatial reordering of the particles
+		* @return the number of updates between two reorderings, 0 if the reordering is disabled
+		*/
+		unsigned int getSpatialReorderingPeriod() const;
+
+		/////////////////////
+		// Spatial queries //
+		/////////////////////
+
+		/**
+		* @brief Finds the particles whose center is within a sphere
+		*
+		* Spatial queries use the octree of the group, which is created if needed and kept as long as the group lives.
+		* The octree is updated at most once per update of the group, or reused if a modifier already needed it.
+		* Queries reflect the state of the particles at the end of the last update.
+		*
+		* @param center : the center of the sphere
+		* @param radius : the radius of the sphere
+		* @param indices : the vector where to store the indices of the particles found, ordered by index (it is cleared first)
+		* @return the number of particles found
+		*/
+		size_t findParticlesInSphere(const Vector3D& center,float radius,std::vector<size_t>& indices);
+
+		/**
+		* @brief Finds the particles whose center is within an axis aligned box
+		* @param boxMin : the minimum position of the box
+		* @param boxMax : the maximum position of the box
+		* @param indices : the vector where to store the indices of the particles found, ordered by index (it is cleared first)
+		* @return the number of particles found
+		*/
+		size_t findParticlesInAABB(const Vector3D& boxMin,const Vector3D& boxMax,std::vector<size_t>& indices);
+
+		/**
+		* @brief Finds the nearest particles from a point
+		* @param point : the point
+		* @param k : the maximum number of particles to find
+		* @param indices : the vector where to store the indices of the particles found, from the nearest to the farthest (it is cleared first)
+		* @return the number of particles found
+		*/
+		size_t findNearestParticles(const Vector3D& point,size_t k,std::vector<size_t>& indices);
+
+		/**
+		* @brief Finds the particles hit by a ray
+		*
+		* Particles are considered as spheres of radius Particle::getRadius().
+		*
+		* @param origin : the origin of the ray
+		* @param direction : the direction of the ray
+		* @param length : the length of the ray
+		* @param indices : the vector where to store the indices of the particles hit, from the nearest to the farthest (it is cleared first)
+		* @return the number of particles hit
+		*/
+		size_t findParticlesOnRay(const Vector3D& origin,const Vector3D& direction,float length,std::vector<size_t>& indices);
+
 		///////////////////////
 		// Virtual interface //
 		///////////////////////
@@ -378,6 +558,11 @@ namespace SPK
 			spk_attribute(bool, sortParticles, enableSorting, isSortingEnabled);
 			spk_attribute(float, physicalRadius, setPhysicalRadius, getPhysicalRadius);
 			spk_attribute(float, graphicalRadius, setGraphicalRadius, getGraphicalRadius);
+			spk_attribute(unsigned int, octreeMaxLevel, setOctreeMaxLevel, getOctreeMaxLevel);
+			spk_attribute(unsigned int, octreeMaxParticlesPerCell, setOctreeMaxParticlesPerCell, getOctreeMaxParticlesPerCell);
+			spk_attribute(bool, octreeRefit, enableOctreeRefit, isOctreeRefitEnabled);
+			spk_attribute(bool, octreeLinearBuild, enableOctreeLinearBuild, isOctreeLinearBuildEnabled);
+			spk_attribute(unsigned int, spatialReorderingPeriod, setSpatialReorderingPeriod, getSpatialReorderingPeriod);
 			spk_attribute(Ref<ColorInterpolator>, colorInterpolator, setColorInterpolator, getColorInterpolator);
 			spk_attribute(Ref<FloatInterpolator>, scaleInterpolator, setScaleInterpolator, getScaleInterpolator);
 			spk_attribute(Ref<FloatInterpolator>, massInterpolator, setMassInterpolator, getMassInterpolator);
@@ -548,6 +733,10 @@ namespace SPK
 		mutable std::vector<WeakModifierDef> activeModifiers;
 		mutable std::vector<WeakModifierDef> initModifiers;
 
+		// For each active modifier, the end index of the run of fusable modifiers starting at it (the next index if it is not fused)
+		mutable std::vector<size_t> fusedModifierEnds;
+		mutable std::vector<FusedForce> fusedForces;
+
 		RendererDef renderer;
 
 		Ref<Action> birthAction;
@@ -570,6 +759,28 @@ namespace SPK
 		float graphicalRadius;
 
 		Octree* octree;
+		unsigned int octreeMaxLevel;
+		unsigned int octreeMaxParticlesPerCell;
+		bool octreeRefitEnabled;
+		bool octreeLinearBuildEnabled;
+
+		// Spatial queries
+		bool modifiersNeedOctree;
+		bool spatialIndexUsed;
+		bool octreeUpToDate;
+		std::vector<size_t> queryCells;
+		std::vector<std::pair<float,size_t> > queryDistances;
+
+		// Spatial reordering
+		static const unsigned int REORDERING_BITS = 10; // Number of bits per axis of the Morton codes
+
+		unsigned int spatialReorderingPeriod;
+		unsigned int nbUpdatesSinceReordering;
+		std::vector<std::pair<unsigned int,size_t> > reorderingKeys;
+		std::vector<size_t> reorderingIndices;
+
+		// Death list filled at each update
+		std::vector<size_t> deadIndices;
 
 		Group(const Ref<System>& system = SPK_NULL_REF,size_t capacity = 100);
 		Group(const Group& group);
@@ -578,6 +789,8 @@ namespace SPK
 		void renderParticles();
 
 		bool initParticle(size_t index,size_t& emitterIndex,size_t& nbManualBorn);
+		void initParticleParameters(size_t index);
+		bool finalizeParticle(size_t index);
 		void swapParticles(size_t index0,size_t index1);
 
 		void recomputeEnabledParamIndices();
@@ -592,6 +805,7 @@ namespace SPK
 		virtual void propagateUpdateTransform();
 
 		void sortParticles();
+		void reorderParticles();
 		void computeAABB();
 
 		void addParticles(
@@ -608,8 +822,26 @@ namespace SPK
 		std::deque<CreationData> creationBuffer;
 		unsigned int nbBufferedParticles;
 
+		// spawn requests
+		struct SpawnRequest
+		{
+			unsigned int nb;
+			Vector3D position;
+			Ref<Emitter> emitter;
+		};
+
+		std::vector<SpawnRequest> spawnRequests;
+
+		size_t emitParticlesAt(Emitter& emitter,const Vector3D& position,size_t nb);
+		void executeSpawnRequests();
+
 		void prepareAdditionnalData();
 		void manageOctreeInstance(bool needsOctree);
+		const Octree& getSpatialIndex();
+		void gatherParticlesInCells(std::vector<size_t>& indices) const;
+
+		void computeFusedModifiers();
+		void applyFusedForces(size_t begin,size_t end,float deltaTime);
 
 		void initData();
 	};
@@ -747,6 +979,7 @@ namespace SPK
 	inline void Group::empty()
 	{
 		particleData.nbParticles = 0;
+		octreeUpToDate = false;
 	}
 
 	inline const Ref<Emitter>& Group::getEmitter(size_t index) const
@@ -796,6 +1029,47 @@ namespace SPK
 		return sortingEnabled;
 	}
 
+	inline unsigned int Group::getOctreeMaxLevel() const
+	{
+		return octreeMaxLevel;
+	}
+
+	inline unsigned int Group::getOctreeMaxParticlesPerCell() const
+	{
+		return octreeMaxParticlesPerCell;
+	}
+
+	inline void Group::enableOctreeRefit(bool refit)
+	{
+		octreeRefitEnabled = refit;
+	}
+
+	inline bool Group::isOctreeRefitEnabled() const
+	{
+		return octreeRefitEnabled;
+	}
+
+	inline void Group::enableOctreeLinearBuild(bool linearBuild)
+	{
+		octreeLinearBuildEnabled = linearBuild;
+	}
+
+	inline bool Group::isOctreeLinearBuildEnabled() const
+	{
+		return octreeLinearBuildEnabled;
+	}
+
+	inline void Group::setSpatialReorderingPeriod(unsigned int period)
+	{
+		spatialReorderingPeriod = period;
+		nbUpdatesSinceReordering = 0;
+	}
+
+	inline unsigned int Group::getSpatialReorderingPeriod() const
+	{
+		return spatialReorderingPeriod;
+	}
+
 	inline const void* Group::getColorAddress() const
 	{
 		return particleData.colors;
@@ -811,6 +1085,11 @@ namespace SPK
 		return particleData.velocities;
 	}
 
+	inline const void* Group::getOldPositionAddress() const
+	{
+		return particleData.oldPositions;
+	}
+
 	inline const void* Group::getParamAddress(Param param) const
 	{
 		return particleData.parameters[param];
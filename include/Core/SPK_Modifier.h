@@ -37,6 +37,29 @@ namespace SPK
 		MODIFIER_PRIORITY_CHECK = 50,			/**< The modifier performs checks over parameters */
 	};
 
+	/**
+	* @brief An elementary operation over the velocity of a particle
+	*
+	* Simple force modifiers can describe their effect with a FusedForce.<br>
+	* A group merges consecutive fusable modifiers of the same priority into a single pass
+	* in which the velocity of each particle is read and written only once.
+	*/
+	struct FusedForce
+	{
+		/** @brief Constants defining the type of a fused force */
+		enum Type
+		{
+			FUSED_FORCE_AFFINE,			/**< velocity = velocity * scale + vector */
+			FUSED_FORCE_DAMPING,		/**< velocity *= 1 - min(1,scale / mass) */
+			FUSED_FORCE_POINT_MASS,		/**< velocity += (vector - position) * scale / (sqrDist(vector,position) + offset) */
+		};
+
+		Type type;
+		Vector3D vector;
+		float scale;
+		float offset;
+	};
+
 	/**
 	* @brief An abstract class that allows to modify the behaviour of a group of particles over time
 	*
@@ -96,6 +119,30 @@ namespace SPK
 
 		virtual void init(Particle& particle,DataSet* dataSet) const {};
 		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const = 0;
+
+		/**
+		* @brief Tells whether this modifier needs the octree of the group
+		* By default, this returns the value given at construction. It can be overridden by modifiers whose needs depend on their settings.
+		* @return true if the octree is needed, false if not
+		*/
+		virtual bool needsOctree() const { return NEEDS_OCTREE; }
+
+		/**
+		* @brief Tells whether this modifier can be fused with its neighbours within the given group
+		* A fusable modifier must not need any data set, octree or init call and its effect must be expressible with a FusedForce.
+		* @param group : the group the modifier is applied to
+		* @return true if the modifier can be fused, false if not
+		*/
+		virtual bool isFusable(const Group& group) const { return false; }
+
+		/**
+		* @brief Gets the fused force equivalent to a call to modify(Group&,DataSet*,float)
+		* This is only called if isFusable(const Group&) returns true for the group.
+		* @param force : the fused force to fill
+		* @param group : the group the modifier is applied to
+		* @param deltaTime : the time step
+		*/
+		virtual void getFusedForce(FusedForce& force,const Group& group,float deltaTime) const {}
 	};
 
 	inline Modifier::Modifier(unsigned int PRIORITY,bool NEEDS_DATASET,bool CALL_INIT,bool NEEDS_OCTREE) :
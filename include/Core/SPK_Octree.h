@@ -23,6 +23,7 @@
 #define H_SPK_OCTREE
 
 #include <set>
+#include <vector>
 
 namespace SPK
 {
@@ -37,7 +38,16 @@ namespace SPK
 	* Typically algorithms where each particle is affected by every other particles in the group (particle vs particle collision, flocking, nbody simulations...).<br>
 	* <br>
 	* A Octree is automatically generated within a group if at least one of its modifiers needs it (by setting its NEEDS_OCTREE constant to true at init).<br>
-	* If no more modifiers need an octree and an octree exists within the group, it is deleted.
+	* If no more modifiers need an octree and an octree exists within the group, it is deleted.<br>
+	* <br>
+	* The depth of the octree and the number of particles from which a cell is split are set per group
+	* (see Group::setOctreeMaxLevel(unsigned int) and Group::setOctreeMaxParticlesPerCell(unsigned int)).
+	* If the refit is enabled in the group (see Group::enableOctreeRefit(bool)), the structure is kept from one update to the next
+	* and only the particles whose cells changed are moved.
+	* The structure is built again once the cells split by the refits make it grow too much or hold too few particles.<br>
+	* <br>
+	* If the linear build is enabled in the group (see Group::enableOctreeLinearBuild(bool)),
+	* the cells are derived from the particles sorted by Morton code instead of being split while particles are inserted.
 	*/
 	class SPK_PREFIX Octree
 	{
@@ -45,6 +55,10 @@ namespace SPK
 
 	public :
 
+		static const size_t DEFAULT_MAX_LEVEL_INDEX = 4;
+		static const size_t DEFAULT_MAX_PARTICLES_NB_PER_CELL = 32;
+		static const size_t MAX_LEVEL_LIMIT = 10; // A too high number will be highly memory comsuming
+
         class Cell;
 
         // A fast and simple self reallocating array (faster than generic std::vectors)
@@ -138,6 +152,11 @@ namespace SPK
 
 		private :
 
+			static const size_t NO_ACTIVE_INDEX = static_cast<size_t>(-1);
+
+			bool modified; // Set when particles are added to the cell during a refit
+			size_t activeIndex; // Index of the cell in the active cells or NO_ACTIVE_INDEX if the cell is empty
+
 			void init(size_t level,size_t offsetX,size_t offsetY,size_t offsetZ)
 			{
 				this->level = level;
@@ -146,6 +165,8 @@ namespace SPK
 				this->offsetZ = offsetZ;
 				hasChildren = false;
 				particles.clear();
+				modified = false;
+				activeIndex = NO_ACTIVE_INDEX;
 			}
 
 			Cell(size_t level = 0,size_t offsetX = 0,size_t offsetY = 0,size_t offsetZ = 0) :
@@ -154,7 +175,9 @@ namespace SPK
 				offsetY(offsetY),
 				offsetZ(offsetZ),
 				hasChildren(false),
-				particles(MAX_PARTICLES_NB_PER_CELL)
+				particles(DEFAULT_MAX_PARTICLES_NB_PER_CELL),
+				modified(false),
+				activeIndex(NO_ACTIVE_INDEX)
 			{}
 
 			// Not safe but optimized and hidden
@@ -164,7 +187,9 @@ namespace SPK
 				offsetY(cell.offsetY),
 				offsetZ(cell.offsetZ),
 				hasChildren(false),
-				particles(MAX_PARTICLES_NB_PER_CELL)
+				particles(DEFAULT_MAX_PARTICLES_NB_PER_CELL),
+				modified(false),
+				activeIndex(NO_ACTIVE_INDEX)
 			{} // Not called
 
 			// Not safe but optimized and hidden
@@ -177,6 +202,8 @@ namespace SPK
 				hasChildren = cell.hasChildren;
 				std::memcpy(children,cell.children,8 * sizeof(size_t));
 				particles = cell.particles;
+				modified = cell.modified;
+				activeIndex = cell.activeIndex;
 				return *this;
 			}
 		};
@@ -217,7 +244,32 @@ namespace SPK
 		*/
 		const Vector3D& getAABBMax() const { return AABBMax; }
 
-		// TODO Allows to tweak the octree param
+		/**
+		* @brief Gets the bounds of a given cell
+		* @param index : the index of the cell
+		* @param cellMin : the vector where to store the minimum position of the cell
+		* @param cellMax : the vector where to store the maximum position of the cell
+		*/
+		void getCellBounds(size_t index,Vector3D& cellMin,Vector3D& cellMax) const;
+
+		/**
+		* @brief Finds the active cells overlapping a box
+		* The cells found may also hold particles outside the box.
+		* @param boxMin : the minimum position of the box
+		* @param boxMax : the maximum position of the box
+		* @param cellIndices : the vector where to store the indices of the cells found (it is cleared first)
+		*/
+		void findCells(const Vector3D& boxMin,const Vector3D& boxMax,std::vector<size_t>& cellIndices) const;
+
+		/**
+		* @brief Finds the active cells crossed by a segment
+		* The cells found may also hold particles that are not crossed by the segment.
+		* @param origin : the start of the segment
+		* @param direction : the normalized direction of the segment
+		* @param length : the length of the segment
+		* @param cellIndices : the vector where to store the indices of the cells found (it is cleared first)
+		*/
+		void findCellsOnRay(const Vector3D& origin,const Vector3D& direction,float length,std::vector<size_t>& cellIndices) const;
 
 	private :
 
@@ -231,12 +283,21 @@ namespace SPK
 				value[1] = static_cast<int>(v.y);
 				value[2] = static_cast<int>(v.z);
 			}
+
+			bool equals(const Triplet& t) const
+			{
+				return value[0] == t.value[0] && value[1] == t.value[1] && value[2] == t.value[2];
+			}
 		};
 
-		static const size_t MAX_LEVEL_INDEX;
-		static const size_t MAX_PARTICLES_NB_PER_CELL;
 		static const float OPTIMAL_CELL_SIZE_FACTOR;
 		static const float MIN_CELL_SIZE;
+		static const float REFIT_MARGIN;
+		static const float REFIT_MIN_EXTENT_RATIO;
+		static const float REFIT_MAX_CELLS_GROWTH;
+		static const float REFIT_MIN_OCCUPANCY_RATIO;
+		static const size_t RADIX_BITS = 10;
+		static const size_t QUERY_STACK_SIZE = 8 * MAX_LEVEL_LIMIT + 1;
 
 		Group& group;
 
@@ -247,6 +308,7 @@ namespace SPK
 
 		Array<size_t>* particleCells; // Cells to which particles belongs
 		size_t nbParticles;
+		size_t nbCellEntries; // Total number of particles in the cells, a particle being counted once per cell
 
 		Triplet* minPos;
 		Triplet* maxPos;
@@ -254,6 +316,27 @@ namespace SPK
 		Vector3D AABBMin;
 		Vector3D AABBMax;
 
+		// Parameters of the current structure, kept to refit it
+		bool built;
+		size_t maxLevelIndex;
+		size_t maxParticlesPerCell;
+		size_t maxLevel;
+		Vector3D offset;
+		Vector3D ratio;
+		float builtExtent;
+		size_t nbBuiltParticles;
+		size_t nbBuiltCells;
+		float builtOccupancy;
+
+		bool trackModifiedCells;
+		bool splitCells;
+		Array<size_t> modifiedCells;
+		Array<size_t> movedParticles;
+
+		// Buffers of the linear build, kept from one build to the next
+		std::vector<unsigned int> mortonCodes;
+		std::vector<unsigned int> tmpMortonCodes;
+
 		// Octree life time is managed by Group
 		Octree(const Ref<Group>& group);
 		~Octree();
@@ -262,10 +345,22 @@ namespace SPK
 		Octree& operator=(const Octree& octree); // never used
 
 		void update();  // Used by Group only
+		void invalidate(); // Used by Group only
+
+		void build(const Vector3D& particlesMin,const Vector3D& particlesMax,float meanRadius);
+		void refit();
+		void buildLinear();
+		void buildLinearCell(size_t cellIndex,size_t begin,size_t end);
+		void sortMortonCodes(size_t nbBits);
+		void removeFromCells(size_t particleIndex);
+		void activateCell(size_t cellIndex);
+		void deactivateCell(size_t cellIndex);
 
 		size_t initNextCell(size_t level,size_t offsetX,size_t offsetY,size_t offsetZ);
 		void addToCell(size_t cellIndex,size_t particleIndex,size_t maxLevel);
 		void addToChildrenCells(size_t parentIndex,size_t particleIndex,size_t maxLevel);
+
+		static bool segmentIntersectsBox(const Vector3D& origin,const Vector3D& direction,float length,const Vector3D& boxMin,const Vector3D& boxMax);
 	};
 }
 
@@ -0,0 +1,174 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_UNIFORMGRID
+#define H_SPK_UNIFORMGRID
+
+#include <vector>
+
+namespace SPK
+{
+	/**
+	* @brief A uniform grid sorting positions by cell
+	*
+	* The grid is built from scratch from an array of positions with a counting sort into flat arrays :
+	* the indices of the positions are stored cell after cell and each cell is a range within them.<br>
+	* As the sort is stable, indices are ordered within a cell.
+	* Cells along x are contiguous so that a row of neighboring cells is a single range.<br>
+	* <br>
+	* It is used by the modifiers that look for neighbors within a given distance (Collider, GroupCollider, Fluid, Flock).
+	* With cells at least as large as that distance, the neighbors of a position are in the cell of the position and in the cells around it.
+	*/
+	class SPK_PREFIX UniformGrid
+	{
+	public :
+
+		UniformGrid();
+
+		/**
+		* @brief Builds the grid
+		*
+		* Cells are at least as large as cellSize.
+		* If maxCellsPerAxis is not 0, cells are enlarged so that the grid has no more than maxCellsPerAxis cells along each axis.
+		* Then they are enlarged until the grid has no more than maxCellsPerPosition cells per position.
+		* Enlarged cells remain correct to find neighbors but give more positions to test.
+		*
+		* @param positions : the positions to sort
+		* @param nbPositions : the number of positions
+		* @param cellSize : the minimum size of the cells
+		* @param maxCellsPerPosition : the maximum number of cells per position
+		* @param maxCellsPerAxis : the maximum number of cells along each axis or 0 for no limit
+		*/
+		void build(const Vector3D* positions,size_t nbPositions,float cellSize,size_t maxCellsPerPosition,size_t maxCellsPerAxis = 0);
+
+		/**
+		* @brief Gets the number of cells along an axis
+		* @param axis : the axis (0 for x, 1 for y and 2 for z)
+		* @return the number of cells along the axis
+		*/
+		size_t getDimension(size_t axis) const;
+
+		/**
+		* @brief Gets the number of cells of the grid
+		* @return the number of cells
+		*/
+		size_t getNbCells() const;
+
+		/**
+		* @brief Gets the index of a cell from its coordinates
+		* @param x : the coordinate of the cell along x
+		* @param y : the coordinate of the cell along y
+		* @param z : the coordinate of the cell along z
+		* @return the index of the cell
+		*/
+		size_t getCellIndex(size_t x,size_t y,size_t z) const;
+
+		/**
+		* @brief Gets the cell of a position
+		* @param index : the index of the position in the array the grid was built from
+		* @return the index of the cell of the position
+		*/
+		size_t getCell(size_t index) const;
+
+		/**
+		* @brief Gets the start of a cell in the sorted indices
+		* @param cell : the index of the cell
+		* @return the first sorted index of the cell
+		*/
+		size_t getCellStart(size_t cell) const;
+
+		/**
+		* @brief Gets the end of a cell in the sorted indices
+		*
+		* The end of a cell is the start of the next one.
+		*
+		* @param cell : the index of the cell
+		* @return the sorted index following the last one of the cell
+		*/
+		size_t getCellEnd(size_t cell) const;
+
+		/**
+		* @brief Gets the index of a position from its sorted index
+		* @param sortedIndex : the sorted index
+		* @return the index of the position in the array the grid was built from
+		*/
+		size_t getSortedIndex(size_t sortedIndex) const;
+
+		/**
+		* @brief Gets the range of the cells around a cell
+		*
+		* The range includes the cell itself and is clamped to the grid.
+		*
+		* @param cell : the index of the cell
+		* @param minX : the minimum coordinate along x
+		* @param minY : the minimum coordinate along y
+		* @param minZ : the minimum coordinate along z
+		* @param maxX : the maximum coordinate along x
+		* @param maxY : the maximum coordinate along y
+		* @param maxZ : the maximum coordinate along z
+		*/
+		void getNeighborCells(size_t cell,size_t& minX,size_t& minY,size_t& minZ,size_t& maxX,size_t& maxY,size_t& maxZ) const;
+
+	private :
+
+		size_t dimensions[3];
+		std::vector<size_t> positionCells;
+		std::vector<size_t> cellStarts;
+		std::vector<size_t> sortedIndices;
+	};
+
+	inline size_t UniformGrid::getDimension(size_t axis) const
+	{
+		return dimensions[axis];
+	}
+
+	inline size_t UniformGrid::getNbCells() const
+	{
+		return cellStarts.size() - 1;
+	}
+
+	inline size_t UniformGrid::getCellIndex(size_t x,size_t y,size_t z) const
+	{
+		return x + dimensions[0] * (y + dimensions[1] * z);
+	}
+
+	inline size_t UniformGrid::getCell(size_t index) const
+	{
+		return positionCells[index];
+	}
+
+	inline size_t UniformGrid::getCellStart(size_t cell) const
+	{
+		return cellStarts[cell];
+	}
+
+	inline size_t UniformGrid::getCellEnd(size_t cell) const
+	{
+		return cellStarts[cell + 1];
+	}
+
+	inline size_t UniformGrid::getSortedIndex(size_t sortedIndex) const
+	{
+		return sortedIndices[sortedIndex];
+	}
+}
+
+#endif
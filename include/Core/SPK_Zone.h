@@ -25,6 +25,7 @@
 namespace SPK
 {
 	class Particle;
+	class Group;
 
 #ifdef SPK_DOXYGEN_ONLY // For documentation purpose only
 
@@ -80,6 +81,44 @@ namespace SPK
 		virtual bool contains(const Vector3D& v,float radius = 0.0f) const = 0;
 		virtual bool intersects(const Vector3D& v0,const Vector3D& v1,float radius = 0.0f,Vector3D* normal = NULL) const = 0;
 		virtual Vector3D computeNormal(const Vector3D& v) const = 0;
+
+		/**
+		* @brief Checks whether several spheres are contained within the zone
+		*
+		* This is the batch version of contains(const Vector3D&,float).
+		* Zones override it with a loop that avoids a virtual call per point.
+		*
+		* @param v : the centers of the spheres
+		* @param radii : the radii of the spheres (if NULL, all radii are 0)
+		* @param nb : the number of spheres
+		* @param mask : the array where to store the results (1 if the sphere is contained, 0 otherwise)
+		*/
+		virtual void containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const;
+
+		/**
+		* @brief Checks whether several moving spheres intersect the zone
+		*
+		* This is the batch version of intersects(const Vector3D&,const Vector3D&,float,Vector3D*).
+		* Normals are not computed.
+		*
+		* @param v0 : the start positions of the spheres
+		* @param v1 : the end positions of the spheres
+		* @param radii : the radii of the spheres (if NULL, all radii are 0)
+		* @param nb : the number of spheres
+		* @param mask : the array where to store the results (1 if the sphere intersects the zone, 0 otherwise)
+		*/
+		virtual void intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const;
+
+		/**
+		* @brief Computes the axis aligned bounding box of the zone
+		*
+		* The bounds are expressed in world coordinates (the transform is taken into account).
+		* The default implementation returns unbounded limits, which is what infinite zones need.
+		*
+		* @param boundsMin : the vector where to store the minimum coordinates of the bounds
+		* @param boundsMax : the vector where to store the maximum coordinates of the bounds
+		*/
+		virtual void computeBounds(Vector3D& boundsMin,Vector3D& boundsMax) const;
 		
 		/**
 		* Performs a check for a particle on the zone
@@ -90,6 +129,19 @@ namespace SPK
 		*/
 		bool check(const Particle& particle,ZoneTest zoneTest,Vector3D* normal = NULL) const;
 
+		/**
+		* Performs a check for consecutive particles of a group on the zone
+		*
+		* This gives the same results as check(const Particle&,ZoneTest,Vector3D*) but tests the particles by batches.
+		*
+		* @param group : the group of the particles
+		* @param begin : the index of the first particle to test
+		* @param nb : the number of particles to test
+		* @param zoneTest : the type of test to perform
+		* @param mask : the array where to store the results (1 if the test is fullfilled, 0 otherwise)
+		*/
+		void checkBatch(const Group& group,size_t begin,size_t nb,ZoneTest zoneTest,unsigned char* mask) const;
+
 	public :
 		spark_description(Zone, Transformable)
 		(
@@ -105,6 +157,8 @@ namespace SPK
 
 	private :
 
+		static const size_t BATCH_SIZE = 256;
+
 		Vector3D position;
 		Vector3D tPosition;
 
@@ -101,6 +101,7 @@ namespace SPK
 	protected :
 
 		static const unsigned int ZONE_TEST_FLAG_ALL = 0xFFFFFFFF;	/**< Enables all zone tests */
+		static const size_t ZONE_BATCH_SIZE = 256;					/**< The number of particles checked at once by zoned modifiers */
 
 		/**
 		* @brief Constructor of zonedModifier
@@ -128,6 +129,16 @@ namespace SPK
 		*/
 		bool checkZone(const Particle& particle,Vector3D* normal = NULL) const;
 
+		/**
+		* @brief Check whether the zone test passes for consecutive particles of a group
+		* Normals are not computed. If needed, they can be computed by calling checkZone(const Particle&,Vector3D*) for the particles that pass.
+		* @param group : the group of the particles
+		* @param begin : the index of the first particle to test
+		* @param nb : the number of particles to test
+		* @param mask : the array where to store the results (1 if the zone test passes, 0 otherwise)
+		*/
+		void checkZoneBatch(const Group& group,size_t begin,size_t nb,unsigned char* mask) const;
+
 		virtual void propagateUpdateTransform();
 
 	private :
@@ -159,6 +170,11 @@ namespace SPK
 	{
 		return zone->check(particle,zoneTest,normal);
 	}
+
+	inline void ZonedModifier::checkZoneBatch(const Group& group,size_t begin,size_t nb,unsigned char* mask) const
+	{
+		zone->checkBatch(group,begin,nb,zoneTest,mask);
+	}
 }
 
 #endif
@@ -22,8 +22,6 @@
 #ifndef H_SPK_SPAWNPARTICLESACTION
 #define H_SPK_SPAWNPARTICLESACTION
 
-#include <deque>
-
 namespace SPK
 {
 	/**
@@ -32,10 +30,12 @@ namespace SPK
 	* This allows to have some particles spawn at some particle's position when the action is triggered.<br>
 	* Note that this is only for a punctual spawning. For a continuous spawning, consider using an EmitterAttacher.<br>
 	* <br>
-	* To set up particle spawning, an base Emitter is used. The emitter and its zone are copied and the copied emitter is transformed accordingly to
-	* the particle's position when an action is triggered.<br>
+	* To set up particle spawning, a base Emitter is used. When the action is triggered, a spawn request is queued in the target group
+	* and the particles are generated by the emitter as if its zone was at the particle's position (see Group::spawnParticles(unsigned int,const Vector3D&,const Ref<Emitter>&)).<br>
 	* <br>
-	* A pool of copied emitter is used internally to avoid creating too many emitters.
+	* No emitter is copied and requests are executed in bulk at the next update of the target group.
+	* The spawned particles are deduced from the tank of the emitter, which is shared by all the requests :
+	* use an emitter with an infinite tank to always spawn the requested number of particles.
 	*/
 	class SPK_PREFIX SpawnParticlesAction : public Action
 	{
@@ -95,15 +95,13 @@ namespace SPK
 
 		/**
 		* @brief Sets the base emitter used to spawn particles
-		* The emitter is copied for every particle and is transformed accordingly to particle's position.<br>
-		* Note that the zone of the emitter must not be shared as its zone is copied as well, else the base emitter is considered as invalid.
-		* @param emitter : the base emitter used to create emitters
+		* The emitter is not copied nor transformed : its zone is used relatively to the particle's position.
+		* @param emitter : the base emitter used to spawn particles
 		*/
 		void setEmitter(const Ref<Emitter>& emitter);
 
 		/**
 		* @brief Gets the base emitter
-		* If the base emitter is modified, a call to resetPool() will allow the changes to take effects
 		* @return the base emitter
 		*/
 		const Ref<Emitter>& getEmitter() const;
@@ -130,9 +128,6 @@ namespace SPK
 		// Interface //
 		///////////////
 
-		/** @brief Resets the pool of particles */
-		void resetPool();
-
 		virtual void apply(Particle& particle) const;
 		virtual Ref<SPKObject> findByName(const std::string& name);
 
@@ -152,8 +147,6 @@ namespace SPK
 		Ref<Emitter> baseEmitter;
 		Ref<Group> targetGroup;
 
-		mutable std::deque<Ref<Emitter> > emitterPool;
-		
 		SpawnParticlesAction(
 			unsigned int minNb = 1,
 			unsigned int maxNb = 1,
@@ -163,7 +156,6 @@ namespace SPK
 		SpawnParticlesAction(const SpawnParticlesAction& action);
 
 		bool checkValidity() const;
-		const Ref<Emitter>& getNextAvailableEmitter() const;
 	};
 
 	inline void SpawnParticlesAction::setNb(unsigned int nb)
@@ -190,6 +182,11 @@ namespace SPK
 		return SPK_NEW(SpawnParticlesAction,minNb,maxNb,group,emitter);
 	}
 
+	inline void SpawnParticlesAction::setEmitter(const Ref<Emitter>& emitter)
+	{
+		baseEmitter = emitter;
+	}
+
 	inline const Ref<Emitter>& SpawnParticlesAction::getEmitter() const
 	{
 		return baseEmitter;
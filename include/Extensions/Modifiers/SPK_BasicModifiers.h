@@ -53,6 +53,9 @@ namespace SPK
 		Gravity(const Gravity& gravity);
 
 		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+
+		virtual bool isFusable(const Group& group) const { return true; }
+		virtual void getFusedForce(FusedForce& force,const Group& group,float deltaTime) const;
 	};
 
 	class SPK_PREFIX Friction : public Modifier
@@ -78,6 +81,9 @@ namespace SPK
 		Friction(const Friction& friction);
 
 		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+
+		virtual bool isFusable(const Group& group) const { return true; }
+		virtual void getFusedForce(FusedForce& force,const Group& group,float deltaTime) const;
 	};
 
 	inline Gravity::Gravity(const Vector3D& value) :
@@ -22,8 +22,27 @@
 #ifndef H_SPK_COLLIDER
 #define H_SPK_COLLIDER
 
+#include <vector>
+
 namespace SPK
 {
+#ifdef SPK_DOXYGEN_ONLY // For documentation purpose only
+
+	/** Constants defining the broadphase used by a Collider to find the particles that may collide */
+	enum ColliderBroadphase
+	{
+		COLLIDER_BROADPHASE_OCTREE,	/**< The octree of the group is used */
+		COLLIDER_BROADPHASE_GRID,	/**< A uniform grid sized from the radius of the particles is built by the collider */
+	};
+
+#endif
+
+	#define SPK_ENUM_COLLIDER_BROADPHASE(XX)	\
+		XX(COLLIDER_BROADPHASE_OCTREE,)			\
+		XX(COLLIDER_BROADPHASE_GRID,)
+
+	SPK_DECLARE_ENUM(ColliderBroadphase,SPK_ENUM_COLLIDER_BROADPHASE)
+
 	/**
 	* @class Collider
 	* @brief A Modifier that perfoms particle against particle collisions in the Group
@@ -45,7 +64,16 @@ namespace SPK
 	* Tries to limitate the number of particles to perform collision on. More than 1000 particles can require a lot of processing time even of recent hardware.<br>
 	* <br>
 	* The accuracy of the collisions is better with small update steps.
-	* Therefore try to keep the update time small by for instance multiplying the number of updates per frame.
+	* Therefore try to keep the update time small by for instance multiplying the number of updates per frame.<br>
+	* <br>
+	* The particles that may collide are found either with the octree of the group or with a uniform grid (see setBroadphase(ColliderBroadphase)).
+	* The grid uses cells as large as the biggest particle and is built with a counting sort into flat arrays,
+	* which is faster than the octree for large groups of particles of similar sizes.<br>
+	* <br>
+	* By default, pairs are resolved one after the other and each resolution modifies both particles in place,
+	* so the result depends on the order of the pairs.
+	* When the deterministic resolution is enabled, all pairs are evaluated from the state of the particles at the beginning of the update
+	* and the resulting changes are accumulated per particle, then applied in a second pass (see enableDeterministicResolution(bool)).
 	*/
 	class SPK_PREFIX Collider : public Modifier
 	{
@@ -58,8 +86,9 @@ namespace SPK
 		/**
 		* @brief Creates and registers a new collider
 		* @param elasticity : the elasticity of the collisions
+		* @param broadphase : the broadphase used to find the particles that may collide
 		*/
-		static  Ref<Collider> create(float elasticity = 1.0f);
+		static  Ref<Collider> create(float elasticity = 1.0f,ColliderBroadphase broadphase = COLLIDER_BROADPHASE_OCTREE);
 
 		/////////////////
 		// Elascticity //
@@ -81,42 +110,140 @@ namespace SPK
 		*/
 		float getElasticity() const;
 
+		////////////////
+		// Broadphase //
+		////////////////
+
+		/**
+		* @brief Sets the broadphase used to find the particles that may collide
+		*
+		* With COLLIDER_BROADPHASE_OCTREE, the octree of the group is used.<br>
+		* With COLLIDER_BROADPHASE_GRID, the collider builds its own uniform grid at each update and the group does not need an octree anymore.
+		*
+		* @param broadphase : the broadphase to use
+		*/
+		void setBroadphase(ColliderBroadphase broadphase);
+
+		/**
+		* @brief Gets the broadphase used to find the particles that may collide
+		* @return the broadphase used
+		*/
+		ColliderBroadphase getBroadphase() const;
+
+		//////////////////////////////
+		// Deterministic resolution //
+		//////////////////////////////
+
+		/**
+		* @brief Enables or disables the deterministic resolution of the collisions
+		*
+		* In deterministic mode, each particle computes its own change of velocity from all its neighbors,
+		* in a fixed order and from the state of the group at the beginning of the update.
+		* The changes are applied once all particles are processed.<br>
+		* The first pass only writes data of the particle being processed, therefore it can be split into any ranges of particles
+		* and always gives the same result.<br>
+		* <br>
+		* This mode always uses the grid broadphase, whatever the broadphase set.
+		* Note that each pair is evaluated twice (once per particle).
+		*
+		* @param deterministic : true to enable the deterministic resolution, false to disable it
+		*/
+		void enableDeterministicResolution(bool deterministic);
+
+		/**
+		* @brief Tells whether the deterministic resolution is enabled
+		* @return true if the deterministic resolution is enabled, false if not
+		*/
+		bool isDeterministicResolutionEnabled() const;
+
 	public :
 		spark_description(Collider, Modifier)
 		(
 			spk_attribute(float, elasticity, setElasticity, getElasticity);
+			spk_attribute(ColliderBroadphase, broadphase, setBroadphase, getBroadphase);
+			spk_attribute(bool, deterministicResolution, enableDeterministicResolution, isDeterministicResolutionEnabled);
 		);
 
 	private :
 
+		static const size_t MAX_CELLS_PER_AXIS = 1024;
+		static const size_t MAX_CELLS_PER_PARTICLE = 4;
+
 		float elasticity;
+		ColliderBroadphase broadphase;
+		bool deterministic;
 
-		Collider(float elasticity = 1.0f);
+		// Grid rebuilt at each update when the grid broadphase is used
+		// Particles are sorted by cell and, as the sort is stable, by index within a cell
+		mutable UniformGrid grid;
+
+		// Changes accumulated per particle by the deterministic resolution
+		mutable std::vector<Vector3D> velocityDeltas;
+		mutable std::vector<unsigned char> positionResets;
+
+		Collider(float elasticity = 1.0f,ColliderBroadphase broadphase = COLLIDER_BROADPHASE_OCTREE);
 		Collider(const Collider& collider);
 
 		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+		virtual bool needsOctree() const;
+
+		void modifyWithOctree(Group& group) const;
+		void modifyWithGrid(Group& group) const;
+		void modifyDeterministic(Group& group) const;
+		void buildGrid(const Group& group) const;
+		void collide(Particle& particle0,Particle& particle1,float radius0,float m0,float groupSqrRadius) const;
+		void accumulateCollision(const Particle& particle0,const Particle& particle1,float groupSqrRadius,Vector3D& deltaVelocity,bool& resetPosition) const;
 	};
 
-	inline Collider::Collider(float elasticity) :
-		Modifier(MODIFIER_PRIORITY_COLLISION,false,false,true)
+	inline Collider::Collider(float elasticity,ColliderBroadphase broadphase) :
+		Modifier(MODIFIER_PRIORITY_COLLISION,false,false,true),
+		broadphase(broadphase),
+		deterministic(false)
 	{
 		setElasticity(elasticity);
 	}
 
 	inline Collider::Collider(const Collider& collider) :
 		Modifier(collider),
-		elasticity(collider.elasticity)
+		elasticity(collider.elasticity),
+		broadphase(collider.broadphase),
+		deterministic(collider.deterministic)
 	{}
 
-	inline Ref<Collider> Collider::create(float elasticity)
+	inline Ref<Collider> Collider::create(float elasticity,ColliderBroadphase broadphase)
 	{
-		return SPK_NEW(Collider,elasticity);
+		return SPK_NEW(Collider,elasticity,broadphase);
 	}
 
 	inline float Collider::getElasticity() const
 	{
 		return elasticity;
 	}
+
+	inline void Collider::setBroadphase(ColliderBroadphase broadphase)
+	{
+		this->broadphase = broadphase;
+	}
+
+	inline ColliderBroadphase Collider::getBroadphase() const
+	{
+		return broadphase;
+	}
+
+	inline void Collider::enableDeterministicResolution(bool deterministic)
+	{
+		this->deterministic = deterministic;
+	}
+
+	inline bool Collider::isDeterministicResolutionEnabled() const
+	{
+		return deterministic;
+	}
+
+	inline bool Collider::needsOctree() const
+	{
+		return broadphase == COLLIDER_BROADPHASE_OCTREE && !deterministic;
+	}
 }
 
 #endif
@@ -0,0 +1,76 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_COLLISIONRESPONSE
+#define H_SPK_COLLISIONRESPONSE
+
+// Internal header shared by the Collider and the GroupCollider, it is not included by SPARK.h
+
+namespace SPK
+{
+	/**
+	* @brief Computes the change of velocity of a particle colliding with another one
+	*
+	* normal goes from particle1 to particle0 and is normalized.
+	* normal0 and normal1 are the components of the velocities of the particles along normal.<br>
+	* The change of particle1 is obtained by swapping the particles and reverting the normal.<br>
+	* <br>
+	* If the particles were already overlapping at the previous update, the collision is not considered as punctual
+	* and the particles are only separated.
+	*
+	* @param normal : the normal of the collision
+	* @param normal0 : the normal component of the velocity of particle0
+	* @param normal1 : the normal component of the velocity of particle1
+	* @param m0 : the mass of particle0
+	* @param m1 : the mass of particle1
+	* @param elasticity : the elasticity of the collision
+	* @param overlapping : true if the particles were overlapping at the previous update
+	* @return the change of velocity of particle0
+	*/
+	inline Vector3D computeCollisionDeltaVelocity(const Vector3D& normal,const Vector3D& normal0,const Vector3D& normal1,float m0,float m1,float elasticity,bool overlapping)
+	{
+		Vector3D deltaVelocity;
+
+		if (overlapping)
+		{
+			// Tweak to separate particles that intersects at both t - deltaTime and t
+			// In that case the collision is no more considered as punctual
+			if (dotProduct(normal,normal0) < 0.0f)
+				deltaVelocity -= normal0;
+
+			if (dotProduct(normal,normal1) > 0.0f)
+				deltaVelocity += normal1;
+		}
+		else
+		{
+			// Else classic collision equations are applied
+			// Tangent components of the velocities are left untouched
+			float invM01 = 1 / (m0 + m1);
+
+			deltaVelocity -= (1.0f + (elasticity * m1 - m0) * invM01) * normal0;
+			deltaVelocity += normal1 * ((elasticity * m1 + m1) * invM01);
+		}
+
+		return deltaVelocity;
+	}
+}
+
+#endif
@@ -72,9 +72,13 @@ namespace SPK
 
 	inline void Destroyer::modify(Group& group,DataSet* dataSet,float deltaTime) const
 	{
-		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
-			if (checkZone(*particleIt))
-				particleIt->kill();
+		unsigned char mask[ZONE_BATCH_SIZE];
+		for (size_t begin = 0; begin < group.getNbParticles(); begin += ZONE_BATCH_SIZE)
+		{
+			const size_t nb = group.getNbParticles() - begin < ZONE_BATCH_SIZE ? group.getNbParticles() - begin : ZONE_BATCH_SIZE;
+			checkZoneBatch(group,begin,nb,mask);
+			group.killParticles(begin,nb,mask); // Dead particles are removed all at once by the group
+		}
 	}
 }
 
@@ -22,6 +22,8 @@
 #ifndef H_SPK_EMITTERATTACHER
 #define H_SPK_EMITTERATTACHER
 
+#include <vector>
+
 namespace SPK
 {
 	class Emitter;
@@ -49,6 +51,15 @@ namespace SPK
 		bool isEmitterOrientationEnabled() const;
 		bool isEmitterRotationEnabled() const;
 
+		// In batched mode, no emitter is copied per particle : only the fraction of particle left to emit is stored
+		// and all particles are emitted at once into the target group at the positions of the particles.
+		// Each particle has its own tank, drawn from the tank of the base emitter when the particle is born, and stops emitting once it is empty.
+		// The tank of the base emitter itself is left untouched. A negative tank means the particles emit as long as they live.
+		// The zone of the base emitter is used relatively to the position of the particles, including when the target group is the group itself.
+		// Orientation and rotation are not supported in batched mode.
+		void enableBatchedMode(bool batched);
+		bool isBatchedModeEnabled() const;
+
 	public :
 		spark_description(EmitterAttacher, Modifier)
 		(
@@ -56,6 +67,7 @@ namespace SPK
 			spk_attribute(Ref<Group>, targetGroup, setTargetGroup, getTargetGroup);
 			spk_attribute(bool, enableOrientation, enableEmitterOrientation, isEmitterOrientationEnabled);
 			spk_attribute(bool, enableRotation, enableEmitterRotation, isEmitterRotationEnabled);
+			spk_attribute(bool, enableBatchedMode, enableBatchedMode, isBatchedModeEnabled);
 		);
 
 	protected :
@@ -66,8 +78,10 @@ namespace SPK
 	private :
 
 		// Data indices
-		static const size_t NB_DATA = 1;
+		static const size_t NB_DATA = 3;
 		static const size_t EMITTER_INDEX = 0;
+		static const size_t FRACTION_INDEX = 1;
+		static const size_t TANK_INDEX = 2;
 
 		class EmitterData : public Data
 		{
@@ -79,6 +93,9 @@ namespace SPK
 			void setGroup(Group* group);
 			Group* getGroup() const;
 
+			void setBatched(bool batched);
+			bool isBatched() const;
+
 			void setEmitter(size_t index,const Ref<Emitter>& emitter);
 
 		private :
@@ -87,6 +104,7 @@ namespace SPK
 			size_t dataSize;
 
 			Group* group;
+			bool batched;
 
 			~EmitterData();
 
@@ -98,6 +116,9 @@ namespace SPK
 
 		bool orientationEnabled;
 		bool rotationEnabled;
+		bool batchedModeEnabled;
+
+		mutable std::vector<Vector3D> spawnPositions;
 
 		EmitterAttacher(
 			const Ref<Group>& group = SPK_NULL_REF,
@@ -109,10 +130,11 @@ namespace SPK
 
 		bool checkValidity() const;
 
-		void initData(EmitterData& data,const Group& group) const;
+		void initData(DataSet& dataSet,const Group& group) const;
 
 		virtual void init(Particle& particle,DataSet* dataSet) const;
 		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+		void modifyBatched(Group& group,DataSet* dataSet,float deltaTime) const;
 	};
 
 	inline Ref<EmitterAttacher> EmitterAttacher::create(
@@ -164,6 +186,16 @@ namespace SPK
 		return rotationEnabled;
 	}
 
+	inline void EmitterAttacher::enableBatchedMode(bool batched)
+	{
+		batchedModeEnabled = batched;
+	}
+
+	inline bool EmitterAttacher::isBatchedModeEnabled() const
+	{
+		return batchedModeEnabled;
+	}
+
 	inline Ref<Emitter>* EmitterAttacher::EmitterData::getEmitters() const
 	{
 		return data;
@@ -179,6 +211,16 @@ namespace SPK
 		return group;
 	}
 
+	inline void EmitterAttacher::EmitterData::setBatched(bool batched)
+	{
+		this->batched = batched;
+	}
+
+	inline bool EmitterAttacher::EmitterData::isBatched() const
+	{
+		return batched;
+	}
+
 	inline void EmitterAttacher::EmitterData::swap(size_t index0,size_t index1)
 	{
 		SPK::swap(data[index0],data[index1]); // Calls the optimized swap of Ref instead of the std::swap
@@ -0,0 +1,300 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_FLOCK
+#define H_SPK_FLOCK
+
+namespace SPK
+{
+	/**
+	* @class Flock
+	* @brief A modifier that makes particles behave as a flock (boids)
+	*
+	* Each particle steers with three rules computed from the neighbors within its view radius :
+	* <ul>
+	* <li>the separation, which moves it away from its neighbors, more strongly as they get closer</li>
+	* <li>the alignment, which matches its velocity with the mean velocity of its neighbors</li>
+	* <li>the cohesion, which moves it towards the center of its neighbors</li>
+	* </ul>
+	* The steering is the weighted sum of the three rules and is applied as an acceleration.
+	* The speed of the particles is then limited to the maximum speed.<br>
+	* <br>
+	* Neighbors are found with a uniform grid whose cells are as large as the view radius.
+	* The number of neighbors taken into account per particle can be capped, the particles of its own cell being examined first.<br>
+	* <br>
+	* The steering of each particle is kept in the dataset of the modifier.
+	* With an update stride of n, only one particle out of n computes its steering again at each update,
+	* the others reuse their last steering. A newly born particle has no steering until it is computed.
+	*/
+	class SPK_PREFIX Flock : public Modifier
+	{
+	public :
+
+		/**
+		* @brief Creates and registers a new flock
+		* @param viewRadius : the distance within which particles see their neighbors
+		* @param maxSpeed : the maximum speed of the particles
+		*/
+		static Ref<Flock> create(float viewRadius = 1.0f,float maxSpeed = 1.0f);
+
+		/////////////////
+		// View radius //
+		/////////////////
+
+		/**
+		* @brief Sets the view radius
+		*
+		* The view radius is the distance within which a particle sees its neighbors.
+		* It must be strictly positive.
+		*
+		* @param viewRadius : the view radius
+		*/
+		void setViewRadius(float viewRadius);
+
+		/**
+		* @brief Gets the view radius
+		* @return the view radius
+		*/
+		float getViewRadius() const;
+
+		///////////////
+		// Max speed //
+		///////////////
+
+		/**
+		* @brief Sets the maximum speed of the particles
+		* @param maxSpeed : the maximum speed, 0 for no limit
+		*/
+		void setMaxSpeed(float maxSpeed);
+
+		/**
+		* @brief Gets the maximum speed of the particles
+		* @return the maximum speed
+		*/
+		float getMaxSpeed() const;
+
+		/////////////
+		// Weights //
+		/////////////
+
+		/**
+		* @brief Sets the weight of the separation rule
+		* @param weight : the weight of the separation
+		*/
+		void setSeparationWeight(float weight);
+
+		/**
+		* @brief Gets the weight of the separation rule
+		* @return the weight of the separation
+		*/
+		float getSeparationWeight() const;
+
+		/**
+		* @brief Sets the weight of the alignment rule
+		* @param weight : the weight of the alignment
+		*/
+		void setAlignmentWeight(float weight);
+
+		/**
+		* @brief Gets the weight of the alignment rule
+		* @return the weight of the alignment
+		*/
+		float getAlignmentWeight() const;
+
+		/**
+		* @brief Sets the weight of the cohesion rule
+		* @param weight : the weight of the cohesion
+		*/
+		void setCohesionWeight(float weight);
+
+		/**
+		* @brief Gets the weight of the cohesion rule
+		* @return the weight of the cohesion
+		*/
+		float getCohesionWeight() const;
+
+		///////////////////
+		// Neighbors cap //
+		///////////////////
+
+		/**
+		* @brief Sets the maximum number of neighbors taken into account per particle
+		* @param maxNeighbors : the maximum number of neighbors, 0 for no limit
+		*/
+		void setMaxNeighbors(unsigned int maxNeighbors);
+
+		/**
+		* @brief Gets the maximum number of neighbors taken into account per particle
+		* @return the maximum number of neighbors, 0 if there is no limit
+		*/
+		unsigned int getMaxNeighbors() const;
+
+		///////////////////
+		// Update stride //
+		///////////////////
+
+		/**
+		* @brief Sets the update stride
+		*
+		* With a stride of n, each particle computes its steering once every n updates and reuses it in between.
+		* A stride of 1 computes the steering of all particles at each update.
+		*
+		* @param updateStride : the update stride
+		*/
+		void setUpdateStride(unsigned int updateStride);
+
+		/**
+		* @brief Gets the update stride
+		* @return the update stride
+		*/
+		unsigned int getUpdateStride() const;
+
+	public :
+		spark_description(Flock, Modifier)
+		(
+			spk_attribute(float, viewRadius, setViewRadius, getViewRadius);
+			spk_attribute(float, maxSpeed, setMaxSpeed, getMaxSpeed);
+			spk_attribute(float, separationWeight, setSeparationWeight, getSeparationWeight);
+			spk_attribute(float, alignmentWeight, setAlignmentWeight, getAlignmentWeight);
+			spk_attribute(float, cohesionWeight, setCohesionWeight, getCohesionWeight);
+			spk_attribute(unsigned int, maxNeighbors, setMaxNeighbors, getMaxNeighbors);
+			spk_attribute(unsigned int, updateStride, setUpdateStride, getUpdateStride);
+		);
+
+	private :
+
+		static const size_t MAX_CELLS_PER_PARTICLE = 4;
+
+		// Data indices
+		static const size_t NB_DATA = 2;
+		static const size_t STEERING_INDEX = 0;
+		static const size_t STRIDE_INDEX = 1;
+
+		// Offset of the particles computing their steering at the current update, kept per group
+		class StrideData : public Data
+		{
+		public :
+
+			unsigned int offset;
+
+			StrideData() : offset(0) {}
+
+		private :
+
+			virtual void swap(size_t index0,size_t index1) {}
+		};
+
+		float viewRadius;
+		float maxSpeed;
+		float separationWeight;
+		float alignmentWeight;
+		float cohesionWeight;
+		unsigned int maxNeighbors;
+		unsigned int updateStride;
+
+		// Grid rebuilt at each update
+		mutable UniformGrid grid;
+
+		Flock(float viewRadius = 1.0f,float maxSpeed = 1.0f);
+		Flock(const Flock& flock);
+
+		virtual void createData(DataSet& dataSet,const Group& group) const;
+		virtual void init(Particle& particle,DataSet* dataSet) const;
+		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+
+		void buildGrid(const Group& group) const;
+		Vector3D computeSteering(const Group& group,size_t index) const;
+		bool examineCell(const Group& group,size_t cell,size_t index,Vector3D& separation,Vector3D& meanVelocity,Vector3D& center,size_t& nbNeighbors) const;
+	};
+
+	inline Flock::Flock(const Flock& flock) :
+		Modifier(flock),
+		viewRadius(flock.viewRadius),
+		maxSpeed(flock.maxSpeed),
+		separationWeight(flock.separationWeight),
+		alignmentWeight(flock.alignmentWeight),
+		cohesionWeight(flock.cohesionWeight),
+		maxNeighbors(flock.maxNeighbors),
+		updateStride(flock.updateStride)
+	{}
+
+	inline Ref<Flock> Flock::create(float viewRadius,float maxSpeed)
+	{
+		return SPK_NEW(Flock,viewRadius,maxSpeed);
+	}
+
+	inline float Flock::getViewRadius() const
+	{
+		return viewRadius;
+	}
+
+	inline float Flock::getMaxSpeed() const
+	{
+		return maxSpeed;
+	}
+
+	inline void Flock::setSeparationWeight(float weight)
+	{
+		separationWeight = weight;
+	}
+
+	inline float Flock::getSeparationWeight() const
+	{
+		return separationWeight;
+	}
+
+	inline void Flock::setAlignmentWeight(float weight)
+	{
+		alignmentWeight = weight;
+	}
+
+	inline float Flock::getAlignmentWeight() const
+	{
+		return alignmentWeight;
+	}
+
+	inline void Flock::setCohesionWeight(float weight)
+	{
+		cohesionWeight = weight;
+	}
+
+	inline float Flock::getCohesionWeight() const
+	{
+		return cohesionWeight;
+	}
+
+	inline void Flock::setMaxNeighbors(unsigned int maxNeighbors)
+	{
+		this->maxNeighbors = maxNeighbors;
+	}
+
+	inline unsigned int Flock::getMaxNeighbors() const
+	{
+		return maxNeighbors;
+	}
+
+	inline unsigned int Flock::getUpdateStride() const
+	{
+		return updateStride;
+	}
+}
+
+#endif
@@ -0,0 +1,218 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_FLUID
+#define H_SPK_FLUID
+
+#include <vector>
+
+namespace SPK
+{
+	/**
+	* @class Fluid
+	* @brief A modifier that simulates a fluid with smoothed particle hydrodynamics
+	*
+	* Each particle is a sample of the fluid carrying its mass (PARAM_MASS).
+	* At each update, the density of the fluid at each particle is computed from its neighbors within the smoothing length,
+	* then the pressure is derived from the density and the rest density of the fluid.<br>
+	* The pressure pushes particles apart where the fluid is denser than at rest
+	* and the viscosity smoothes the velocities of neighboring particles.<br>
+	* <br>
+	* Pressure is clamped to 0 so that the fluid does not attract itself at its free surface,
+	* which suits splashes and drops falling apart.<br>
+	* <br>
+	* Neighbors are found with a uniform grid whose cells are as large as the smoothing length.
+	* The grid is built with a counting sort and the positions, velocities and masses are gathered in the order of the cells,
+	* so that the kernels are evaluated on contiguous arrays.<br>
+	* The density and the pressure of the particles are kept in the dataset of the modifier.<br>
+	* <br>
+	* As with Collider, the stability depends on the update step, the stiffness and the viscosity.
+	*/
+	class SPK_PREFIX Fluid : public Modifier
+	{
+	public :
+
+		/**
+		* @brief Creates and registers a new fluid
+		* @param smoothingLength : the radius within which particles interact
+		* @param restDensity : the density of the fluid at rest
+		* @param stiffness : the ratio between the pressure and the difference of density
+		* @param viscosity : the viscosity of the fluid
+		*/
+		static Ref<Fluid> create(float smoothingLength = 1.0f,float restDensity = 1.0f,float stiffness = 1.0f,float viscosity = 0.1f);
+
+		//////////////////////
+		// Smoothing length //
+		//////////////////////
+
+		/**
+		* @brief Sets the smoothing length
+		*
+		* The smoothing length is the radius within which particles interact with each other.
+		* It must be strictly positive.
+		*
+		* @param smoothingLength : the smoothing length
+		*/
+		void setSmoothingLength(float smoothingLength);
+
+		/**
+		* @brief Gets the smoothing length
+		* @return the smoothing length
+		*/
+		float getSmoothingLength() const;
+
+		//////////////////
+		// Rest density //
+		//////////////////
+
+		/**
+		* @brief Sets the density of the fluid at rest
+		* @param restDensity : the rest density
+		*/
+		void setRestDensity(float restDensity);
+
+		/**
+		* @brief Gets the density of the fluid at rest
+		* @return the rest density
+		*/
+		float getRestDensity() const;
+
+		///////////////
+		// Stiffness //
+		///////////////
+
+		/**
+		* @brief Sets the stiffness of the fluid
+		*
+		* The pressure of a particle is the stiffness multiplied by the difference between its density and the rest density.
+		*
+		* @param stiffness : the stiffness of the fluid
+		*/
+		void setStiffness(float stiffness);
+
+		/**
+		* @brief Gets the stiffness of the fluid
+		* @return the stiffness of the fluid
+		*/
+		float getStiffness() const;
+
+		///////////////
+		// Viscosity //
+		///////////////
+
+		/**
+		* @brief Sets the viscosity of the fluid
+		* @param viscosity : the viscosity of the fluid
+		*/
+		void setViscosity(float viscosity);
+
+		/**
+		* @brief Gets the viscosity of the fluid
+		* @return the viscosity of the fluid
+		*/
+		float getViscosity() const;
+
+	public :
+		spark_description(Fluid, Modifier)
+		(
+			spk_attribute(float, smoothingLength, setSmoothingLength, getSmoothingLength);
+			spk_attribute(float, restDensity, setRestDensity, getRestDensity);
+			spk_attribute(float, stiffness, setStiffness, getStiffness);
+			spk_attribute(float, viscosity, setViscosity, getViscosity);
+		);
+
+	private :
+
+		static const float PI;
+
+		static const size_t MAX_CELLS_PER_PARTICLE = 4;
+
+		// Data indices
+		static const size_t NB_DATA = 2;
+		static const size_t DENSITY_INDEX = 0;
+		static const size_t PRESSURE_INDEX = 1;
+
+		float smoothingLength;
+		float restDensity;
+		float stiffness;
+		float viscosity;
+
+		// Grid rebuilt at each update
+		mutable UniformGrid grid;
+
+		// Particles data gathered in the order of the cells
+		mutable std::vector<Vector3D> sortedPositions;
+		mutable std::vector<Vector3D> sortedVelocities;
+		mutable std::vector<float> sortedMasses;
+		mutable std::vector<float> sortedDensities;
+		mutable std::vector<float> sortedPressures;
+
+		Fluid(float smoothingLength = 1.0f,float restDensity = 1.0f,float stiffness = 1.0f,float viscosity = 0.1f);
+		Fluid(const Fluid& fluid);
+
+		virtual void createData(DataSet& dataSet,const Group& group) const;
+		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+
+		void buildGrid(const Group& group) const;
+		void computeDensities() const;
+		void computeAccelerations(Group& group,float deltaTime) const;
+	};
+
+	inline Fluid::Fluid(const Fluid& fluid) :
+		Modifier(fluid),
+		smoothingLength(fluid.smoothingLength),
+		restDensity(fluid.restDensity),
+		stiffness(fluid.stiffness),
+		viscosity(fluid.viscosity)
+	{}
+
+	inline Ref<Fluid> Fluid::create(float smoothingLength,float restDensity,float stiffness,float viscosity)
+	{
+		return SPK_NEW(Fluid,smoothingLength,restDensity,stiffness,viscosity);
+	}
+
+	inline float Fluid::getSmoothingLength() const
+	{
+		return smoothingLength;
+	}
+
+	inline float Fluid::getRestDensity() const
+	{
+		return restDensity;
+	}
+
+	inline void Fluid::setStiffness(float stiffness)
+	{
+		this->stiffness = stiffness;
+	}
+
+	inline float Fluid::getStiffness() const
+	{
+		return stiffness;
+	}
+
+	inline float Fluid::getViscosity() const
+	{
+		return viscosity;
+	}
+}
+
+#endif
@@ -0,0 +1,491 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_FORCEFIELD
+#define H_SPK_FORCEFIELD
+
+#include <vector>
+
+namespace SPK
+{
+	/**
+	* @brief A Modifier applying the forces of many sources in a single pass
+	*
+	* A force field holds 3 kinds of sources :
+	* <ul>
+	* <li>point masses : attract or repel particles with the same law as PointMass</li>
+	* <li>vortices : make particles swirl around an axis and optionally attract them toward it</li>
+	* <li>directional forces : apply a constant force</li>
+	* </ul>
+	* Using a force field is much faster than using one modifier per source as all sources are evaluated for a particle at once.
+	* Sources are stored as structures of arrays.<br>
+	* <br>
+	* Each source can have a range. A particle further than the range from the position of the source is not affected by it.
+	* A range of 0 means an infinite range.<br>
+	* When a culling cell size is set, sources with a finite range are sorted in a uniform grid
+	* so that only the sources that can reach a particle are evaluated for it.
+	*/
+	class SPK_PREFIX ForceField : public Modifier
+	{
+	public :
+
+		/**
+		* @brief Creates a new empty force field
+		* @param cullingCellSize : the size of the cells of the culling grid (0 to disable culling)
+		* @return a new force field
+		*/
+		static Ref<ForceField> create(float cullingCellSize = 0.0f);
+
+		//////////////////
+		// Point masses //
+		//////////////////
+
+		/**
+		* @brief Adds a point mass to the force field
+		* @param position : the position of the point mass
+		* @param mass : the mass (negative to repel particles)
+		* @param offset : the offset added to the distance to prevent the force from reaching the infinity
+		* @param range : the range of the point mass (0 for infinite)
+		* @return the index of the point mass
+		*/
+		unsigned int addPointMass(const Vector3D& position,float mass,float offset = 0.01f,float range = 0.0f);
+
+		/**
+		* @brief Sets a point mass of the force field
+		* See addPointMass(const Vector3D&,float,float,float) for the description of the parameters.
+		* @param index : the index of the point mass
+		*/
+		void setPointMass(unsigned int index,const Vector3D& position,float mass,float offset = 0.01f,float range = 0.0f);
+
+		/** @brief Adds a point mass of mass 1 at the origin to the force field */
+		void createPointMass();
+
+		/**
+		* @brief Removes a point mass of the force field
+		* The point masses after the removed one are shifted down by one index.
+		* @param index : the index of the point mass
+		*/
+		void removePointMass(unsigned int index);
+
+		/**
+		* @brief Gets the number of point masses
+		* @return the number of point masses
+		*/
+		unsigned int getNbPointMasses() const;
+
+		/** @brief Removes all the point masses of the force field */
+		void removeAllPointMasses();
+
+		void setPointMassPosition(unsigned int index,const Vector3D& position);
+		void setPointMassMass(unsigned int index,float mass);
+		void setPointMassOffset(unsigned int index,float offset);
+		void setPointMassRange(unsigned int index,float range);
+
+		const Vector3D& getPointMassPosition(unsigned int index) const;
+		float getPointMassMass(unsigned int index) const;
+		float getPointMassOffset(unsigned int index) const;
+		float getPointMassRange(unsigned int index) const;
+
+		//////////////
+		// Vortices //
+		//////////////
+
+		/**
+		* @brief Adds a vortex to the force field
+		*
+		* The force of a vortex is function of the inverse of the distance of the particle to its axis.
+		*
+		* @param position : a point on the axis of the vortex
+		* @param axis : the direction of the axis
+		* @param rotationStrength : the strength of the rotation around the axis
+		* @param attractionStrength : the strength of the attraction toward the axis (negative to repel particles)
+		* @param offset : the offset added to the distance to prevent the force from reaching the infinity
+		* @param range : the range of the vortex from its position (0 for infinite)
+		* @return the index of the vortex
+		*/
+		unsigned int addVortex(const Vector3D& position,const Vector3D& axis,float rotationStrength,float attractionStrength = 0.0f,float offset = 0.01f,float range = 0.0f);
+
+		/**
+		* @brief Sets a vortex of the force field
+		* See addVortex(const Vector3D&,const Vector3D&,float,float,float,float) for the description of the parameters.
+		* @param index : the index of the vortex
+		*/
+		void setVortex(unsigned int index,const Vector3D& position,const Vector3D& axis,float rotationStrength,float attractionStrength = 0.0f,float offset = 0.01f,float range = 0.0f);
+
+		/** @brief Adds a vortex of strength 1 around the y axis to the force field */
+		void createVortex();
+
+		/**
+		* @brief Removes a vortex of the force field
+		* The vortices after the removed one are shifted down by one index.
+		* @param index : the index of the vortex
+		*/
+		void removeVortex(unsigned int index);
+
+		/**
+		* @brief Gets the number of vortices
+		* @return the number of vortices
+		*/
+		unsigned int getNbVortices() const;
+
+		/** @brief Removes all the vortices of the force field */
+		void removeAllVortices();
+
+		void setVortexPosition(unsigned int index,const Vector3D& position);
+		void setVortexAxis(unsigned int index,const Vector3D& axis);
+		void setVortexRotationStrength(unsigned int index,float rotationStrength);
+		void setVortexAttractionStrength(unsigned int index,float attractionStrength);
+		void setVortexOffset(unsigned int index,float offset);
+		void setVortexRange(unsigned int index,float range);
+
+		const Vector3D& getVortexPosition(unsigned int index) const;
+		const Vector3D& getVortexAxis(unsigned int index) const;
+		float getVortexRotationStrength(unsigned int index) const;
+		float getVortexAttractionStrength(unsigned int index) const;
+		float getVortexOffset(unsigned int index) const;
+		float getVortexRange(unsigned int index) const;
+
+		////////////////////////
+		// Directional forces //
+		////////////////////////
+
+		/**
+		* @brief Adds a directional force to the force field
+		* @param force : the force vector
+		* @param position : the position from which the range is computed
+		* @param range : the range of the force (0 for infinite)
+		* @return the index of the directional force
+		*/
+		unsigned int addDirectionalForce(const Vector3D& force,const Vector3D& position = Vector3D(),float range = 0.0f);
+
+		/**
+		* @brief Sets a directional force of the force field
+		* See addDirectionalForce(const Vector3D&,const Vector3D&,float) for the description of the parameters.
+		* @param index : the index of the directional force
+		*/
+		void setDirectionalForce(unsigned int index,const Vector3D& force,const Vector3D& position = Vector3D(),float range = 0.0f);
+
+		/** @brief Adds a null directional force to the force field */
+		void createDirectionalForce();
+
+		/**
+		* @brief Removes a directional force of the force field
+		* The directional forces after the removed one are shifted down by one index.
+		* @param index : the index of the directional force
+		*/
+		void removeDirectionalForce(unsigned int index);
+
+		/**
+		* @brief Gets the number of directional forces
+		* @return the number of directional forces
+		*/
+		unsigned int getNbDirectionalForces() const;
+
+		/** @brief Removes all the directional forces of the force field */
+		void removeAllDirectionalForces();
+
+		void setDirectionalForceVector(unsigned int index,const Vector3D& force);
+		void setDirectionalForcePosition(unsigned int index,const Vector3D& position);
+		void setDirectionalForceRange(unsigned int index,float range);
+
+		const Vector3D& getDirectionalForceVector(unsigned int index) const;
+		const Vector3D& getDirectionalForcePosition(unsigned int index) const;
+		float getDirectionalForceRange(unsigned int index) const;
+
+		/** @brief Removes all the sources of the force field */
+		void removeAllSources();
+
+		/////////////
+		// Culling //
+		/////////////
+
+		/**
+		* @brief Sets the size of the cells of the culling grid
+		*
+		* When culling is enabled, sources with a finite range are sorted in a uniform grid
+		* and only the sources overlapping the cell of a particle are evaluated.<br>
+		* This is only worth it when there are many sources with a small range compared to the size of the field.
+		*
+		* @param cullingCellSize : the size of the cells (0 to disable culling)
+		*/
+		void setCullingCellSize(float cullingCellSize);
+
+		/**
+		* @brief Gets the size of the cells of the culling grid
+		* @return the size of the cells or 0 if culling is disabled
+		*/
+		float getCullingCellSize() const;
+
+	public :
+		spark_description(ForceField, Modifier)
+		(
+			spk_attribute(float, cullingCellSize, setCullingCellSize, getCullingCellSize);
+			spk_structure(pointMasses, createPointMass, removePointMass, removeAllPointMasses, getNbPointMasses)
+			(
+				spk_field(Vector3D, position, setPointMassPosition, getPointMassPosition);
+				spk_field(float, mass, setPointMassMass, getPointMassMass);
+				spk_field(float, offset, setPointMassOffset, getPointMassOffset);
+				spk_field(float, range, setPointMassRange, getPointMassRange);
+			);
+			spk_structure(vortices, createVortex, removeVortex, removeAllVortices, getNbVortices)
+			(
+				spk_field(Vector3D, position, setVortexPosition, getVortexPosition);
+				spk_field(Vector3D, axis, setVortexAxis, getVortexAxis);
+				spk_field(float, rotationStrength, setVortexRotationStrength, getVortexRotationStrength);
+				spk_field(float, attractionStrength, setVortexAttractionStrength, getVortexAttractionStrength);
+				spk_field(float, offset, setVortexOffset, getVortexOffset);
+				spk_field(float, range, setVortexRange, getVortexRange);
+			);
+			spk_structure(directionalForces, createDirectionalForce, removeDirectionalForce, removeAllDirectionalForces, getNbDirectionalForces)
+			(
+				spk_field(Vector3D, force, setDirectionalForceVector, getDirectionalForceVector);
+				spk_field(Vector3D, position, setDirectionalForcePosition, getDirectionalForcePosition);
+				spk_field(float, range, setDirectionalForceRange, getDirectionalForceRange);
+			);
+		);
+
+	protected :
+
+		virtual void innerUpdateTransform();
+
+	private :
+
+		static const size_t MAX_CELLS_PER_AXIS = 64;
+
+		enum SourceType
+		{
+			SOURCE_POINT_MASS,
+			SOURCE_VORTEX,
+			SOURCE_DIRECTIONAL_FORCE,
+			NB_SOURCE_TYPES,
+		};
+
+		struct PointMassDef
+		{
+			Vector3D position;
+			Vector3D tPosition;
+			float mass;
+			float offset;
+			float range;
+		};
+
+		struct VortexDef
+		{
+			Vector3D position;
+			Vector3D tPosition;
+			Vector3D axis;
+			Vector3D tAxis;
+			float rotationStrength;
+			float attractionStrength;
+			float offset;
+			float range;
+		};
+
+		struct DirectionalForceDef
+		{
+			Vector3D force;
+			Vector3D tForce;
+			Vector3D position;
+			Vector3D tPosition;
+			float range;
+		};
+
+		// Transformed sources stored as structures of arrays
+		struct PointMassArrays
+		{
+			std::vector<float> x, y, z;
+			std::vector<float> mass;
+			std::vector<float> sqrOffset;
+			std::vector<float> sqrRange;
+		};
+
+		struct VortexArrays
+		{
+			std::vector<float> x, y, z;
+			std::vector<float> axisX, axisY, axisZ;
+			std::vector<float> rotationStrength;
+			std::vector<float> attractionStrength;
+			std::vector<float> sqrOffset;
+			std::vector<float> sqrRange;
+		};
+
+		struct DirectionalForceArrays
+		{
+			std::vector<float> x, y, z;
+			std::vector<float> forceX, forceY, forceZ;
+			std::vector<float> sqrRange;
+		};
+
+		std::vector<PointMassDef> pointMasses;
+		std::vector<VortexDef> vortices;
+		std::vector<DirectionalForceDef> directionalForces;
+
+		float cullingCellSize;
+
+		// The arrays of sources and the grid are rebuilt at the next update when this flag is set
+		mutable bool sourcesDirty;
+
+		mutable PointMassArrays pointMassArrays;
+		mutable VortexArrays vortexArrays;
+		mutable DirectionalForceArrays directionalForceArrays;
+
+		// Culling grid
+		// For each cell, the indices of the sources of each type are stored contiguously
+		// The last cell holds the sources with an infinite range and is used for particles outside the grid
+		mutable Vector3D gridMin;
+		mutable Vector3D gridInvCellSize;
+		mutable size_t gridDimensions[3];
+		mutable std::vector<size_t> cellOffsets;
+		mutable std::vector<size_t> cellSources;
+
+		// Bounding spheres of the sources, kept from one rebuild of the grid to the next
+		mutable std::vector<Vector3D> sourceCenters;
+		mutable std::vector<float> sourceRanges;
+		mutable std::vector<size_t> sourceTypes;
+		mutable std::vector<size_t> sourceIndices;
+
+		ForceField(float cullingCellSize = 0.0f);
+		ForceField(const ForceField& forceField);
+
+		void updateSources() const;
+		void updateGrid() const;
+		size_t getCellIndex(const Vector3D& pos) const;
+
+		void accumulatePointMasses(Vector3D& force,const Vector3D& pos,const size_t* indices,size_t nb) const;
+		void accumulateVortices(Vector3D& force,const Vector3D& pos,const size_t* indices,size_t nb) const;
+		void accumulateDirectionalForces(Vector3D& force,const Vector3D& pos,const size_t* indices,size_t nb) const;
+
+		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+	};
+
+	inline Ref<ForceField> ForceField::create(float cullingCellSize)
+	{
+		return SPK_NEW(ForceField,cullingCellSize);
+	}
+
+	inline unsigned int ForceField::getNbPointMasses() const
+	{
+		return static_cast<unsigned int>(pointMasses.size());
+	}
+
+	inline const Vector3D& ForceField::getPointMassPosition(unsigned int index) const
+	{
+		return pointMasses[index].position;
+	}
+
+	inline float ForceField::getPointMassMass(unsigned int index) const
+	{
+		return pointMasses[index].mass;
+	}
+
+	inline float ForceField::getPointMassOffset(unsigned int index) const
+	{
+		return pointMasses[index].offset;
+	}
+
+	inline float ForceField::getPointMassRange(unsigned int index) const
+	{
+		return pointMasses[index].range;
+	}
+
+	inline unsigned int ForceField::getNbVortices() const
+	{
+		return static_cast<unsigned int>(vortices.size());
+	}
+
+	inline const Vector3D& ForceField::getVortexPosition(unsigned int index) const
+	{
+		return vortices[index].position;
+	}
+
+	inline const Vector3D& ForceField::getVortexAxis(unsigned int index) const
+	{
+		return vortices[index].axis;
+	}
+
+	inline float ForceField::getVortexRotationStrength(unsigned int index) const
+	{
+		return vortices[index].rotationStrength;
+	}
+
+	inline float ForceField::getVortexAttractionStrength(unsigned int index) const
+	{
+		return vortices[index].attractionStrength;
+	}
+
+	inline float ForceField::getVortexOffset(unsigned int index) const
+	{
+		return vortices[index].offset;
+	}
+
+	inline float ForceField::getVortexRange(unsigned int index) const
+	{
+		return vortices[index].range;
+	}
+
+	inline unsigned int ForceField::getNbDirectionalForces() const
+	{
+		return static_cast<unsigned int>(directionalForces.size());
+	}
+
+	inline const Vector3D& ForceField::getDirectionalForceVector(unsigned int index) const
+	{
+		return directionalForces[index].force;
+	}
+
+	inline const Vector3D& ForceField::getDirectionalForcePosition(unsigned int index) const
+	{
+		return directionalForces[index].position;
+	}
+
+	inline float ForceField::getDirectionalForceRange(unsigned int index) const
+	{
+		return directionalForces[index].range;
+	}
+
+	inline float ForceField::getCullingCellSize() const
+	{
+		return cullingCellSize;
+	}
+
+	inline void ForceField::innerUpdateTransform()
+	{
+		for (std::vector<PointMassDef>::iterator it = pointMasses.begin(); it != pointMasses.end(); ++it)
+			transformPos(it->tPosition,it->position);
+
+		for (std::vector<VortexDef>::iterator it = vortices.begin(); it != vortices.end(); ++it)
+		{
+			transformPos(it->tPosition,it->position);
+			transformDir(it->tAxis,it->axis);
+			it->tAxis.normalize();
+		}
+
+		for (std::vector<DirectionalForceDef>::iterator it = directionalForces.begin(); it != directionalForces.end(); ++it)
+		{
+			transformDir(it->tForce,it->force);
+			transformPos(it->tPosition,it->position);
+		}
+
+		sourcesDirty = true;
+	}
+}
+
+#endif
@@ -0,0 +1,127 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_GROUPCOLLIDER
+#define H_SPK_GROUPCOLLIDER
+
+#include <vector>
+
+namespace SPK
+{
+	/**
+	* @class GroupCollider
+	* @brief A Modifier that performs collisions between the particles of several groups
+	*
+	* The collider must be added to each group of the set.
+	* The set is made of the groups that call the collider, it is not stored as references so that it does not keep the groups alive.<br>
+	* Only pairs of particles from different groups are resolved, a Collider can be added to a group for the collisions within the group.<br>
+	* <br>
+	* Each particle collides with its own radius (see Particle::getRadius()) and its own mass, so that groups with different physical radii,
+	* interpolators or renderers can interact.<br>
+	* <br>
+	* The collisions are resolved once per step, when the last group of the set calls the collider.
+	* At that time, all the groups of the set have moved their particles.
+	* A single uniform grid is built over the particles of all the groups with a counting sort into flat arrays,
+	* with cells as large as the biggest particle.<br>
+	* If some groups of the set are not updated, the collisions are resolved when a group calls the collider for the second time
+	* and the groups that were not updated are removed from the set until they call the collider again.<br>
+	* <br>
+	* The elasticity has the same meaning as in Collider.
+	*/
+	class SPK_PREFIX GroupCollider : public Modifier
+	{
+	public :
+
+		/**
+		* @brief Creates and registers a new group collider
+		* @param elasticity : the elasticity of the collisions
+		*/
+		static Ref<GroupCollider> create(float elasticity = 1.0f);
+
+		virtual ~GroupCollider();
+
+		////////////////
+		// Elasticity //
+		////////////////
+
+		/**
+		* @brief Sets the elasticity of the collisions
+		* @param elasticity : the elasticity of the collisions
+		*/
+		void setElasticity(float elasticity);
+
+		/**
+		* @brief Gets the elasticity of the collisions
+		* @return the elasticity of the collisions
+		*/
+		float getElasticity() const;
+
+	public :
+		spark_description(GroupCollider, Modifier)
+		(
+			spk_attribute(float, elasticity, setElasticity, getElasticity);
+		);
+
+	private :
+
+		static const size_t MAX_CELLS_PER_AXIS = 1024;
+		static const size_t MAX_CELLS_PER_PARTICLE = 4;
+
+		float elasticity;
+
+		// Groups that call the collider, they are not owned by the collider
+		mutable std::vector<Group*> groups;
+
+		// Groups of the set that called the collider since the last resolution
+		mutable std::vector<unsigned char> updatedGroups;
+		mutable size_t nbUpdatedGroups;
+
+		// Shared grid rebuilt at each resolution
+		// Particles of all the groups are numbered one after the other, group by group
+		mutable std::vector<size_t> groupStarts;
+		mutable std::vector<size_t> particleGroups;
+		mutable std::vector<float> particleRadii;
+		mutable std::vector<Vector3D> particlePositions;
+		mutable UniformGrid grid;
+
+		GroupCollider(float elasticity = 1.0f);
+		GroupCollider(const GroupCollider& collider);
+
+		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+
+		size_t findGroup(const Group& group) const;
+		void resolveCollisions() const;
+		void buildGrid() const;
+		void collide(Particle& particle0,Particle& particle1,float radius0,float radius1) const;
+	};
+
+	inline Ref<GroupCollider> GroupCollider::create(float elasticity)
+	{
+		return SPK_NEW(GroupCollider,elasticity);
+	}
+
+	inline float GroupCollider::getElasticity() const
+	{
+		return elasticity;
+	}
+}
+
+#endif
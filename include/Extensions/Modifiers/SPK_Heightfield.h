@@ -0,0 +1,316 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_HEIGHTFIELD
+#define H_SPK_HEIGHTFIELD
+
+namespace SPK
+{
+	/**
+	* @brief A Modifier making particles bounce on a terrain defined by a height grid
+	*
+	* The grid holds one height per node and is stretched over a box defined in the local space of the modifier :
+	* the nodes are spread over the x and z axes of the box and a height of 0 is at the bottom of the box while a height of 1 is at its top.
+	* Heights outside [0,1] are allowed and simply extend beyond the box.<br>
+	* <br>
+	* The height of the terrain under a particle is computed by bilinear interpolation of the 4 surrounding nodes,
+	* so the cost per particle does not depend on the size of the grid.
+	* Particles outside the footprint of the grid are not affected.<br>
+	* <br>
+	* A particle under the terrain bounces with the same rules as an Obstacle :
+	* it is moved back to its previous position and its velocity is split along the normal of the terrain
+	* into a normal component scaled by the bouncing ratio and a tangent component scaled by the friction.<br>
+	* If its previous position is under the terrain as well, it is lifted onto the terrain instead.<br>
+	* <br>
+	* The grid can be loaded from a raw binary file (see loadFromFile(const std::string&)),
+	* copied from memory or referenced from an external buffer such as a memory mapped file.
+	*/
+	class SPK_PREFIX Heightfield : public Modifier
+	{
+	public :
+
+		/**
+		* @brief Creates a new heightfield
+		* @param boundsMin : the minimum corner of the box of the grid
+		* @param boundsMax : the maximum corner of the box of the grid
+		* @param bouncingRatio : the bouncing ratio
+		* @param friction : the friction
+		* @return a new heightfield
+		*/
+		static Ref<Heightfield> create(
+			const Vector3D& boundsMin = Vector3D(-1.0f,0.0f,-1.0f),
+			const Vector3D& boundsMax = Vector3D(1.0f,1.0f,1.0f),
+			float bouncingRatio = 1.0f,
+			float friction = 1.0f);
+
+		//////////
+		// Grid //
+		//////////
+
+		/**
+		* @brief Sets the grid by copying the given heights
+		*
+		* Heights are ordered by x first, then z : the height of node (i,k) is at i + k * width.
+		*
+		* @param width : the number of nodes along the x axis
+		* @param depth : the number of nodes along the z axis
+		* @param heights : the heights of the grid
+		*/
+		void setGrid(size_t width,size_t depth,const float* heights);
+
+		/**
+		* @brief Sets the grid from an external buffer without copying it
+		*
+		* This is useful to sample a memory mapped file or a buffer shared between several heightfields.<br>
+		* The buffer must remain valid as long as it is used by the heightfield.
+		* See setGrid(size_t,size_t,const float*) for the layout of the data.
+		*
+		* @param width : the number of nodes along the x axis
+		* @param depth : the number of nodes along the z axis
+		* @param heights : the heights of the grid
+		*/
+		void setExternalGrid(size_t width,size_t depth,const float* heights);
+
+		/**
+		* @brief Loads the grid from a raw binary file
+		*
+		* The file starts with the width and the depth of the grid as 2 unsigned 32 bits integers.
+		* Then the heights follow as 32 bits floats with the layout described in setGrid(size_t,size_t,const float*).<br>
+		* The data is expected to be in the native endianness.
+		*
+		* @param path : the path of the file
+		* @return true if the grid was loaded, false if not
+		*/
+		bool loadFromFile(const std::string& path);
+
+		/**
+		* @brief Sets the file of the grid
+		* This is the same as loadFromFile(const std::string&) but fits the attribute interface.
+		* @param path : the path of the file
+		*/
+		void setFile(const std::string& path);
+
+		/**
+		* @brief Gets the file of the grid
+		* @return the path of the file of the grid or an empty string if the grid was not loaded from a file
+		*/
+		const std::string& getFile() const;
+
+		/**
+		* @brief Gets the number of nodes along the x axis
+		* @return the width of the grid
+		*/
+		size_t getWidth() const;
+
+		/**
+		* @brief Gets the number of nodes along the z axis
+		* @return the depth of the grid
+		*/
+		size_t getDepth() const;
+
+		////////////
+		// Bounds //
+		////////////
+
+		/**
+		* @brief Sets the box over which the grid is stretched
+		* The first node of the grid is at the minimum corner and the last node is at the maximum corner (heights excepted).
+		* @param boundsMin : the minimum corner
+		* @param boundsMax : the maximum corner
+		*/
+		void setBounds(const Vector3D& boundsMin,const Vector3D& boundsMax);
+
+		/**
+		* @brief Sets the minimum corner of the box of the grid
+		* @param boundsMin : the minimum corner
+		*/
+		void setBoundsMin(const Vector3D& boundsMin);
+
+		/**
+		* @brief Sets the maximum corner of the box of the grid
+		* @param boundsMax : the maximum corner
+		*/
+		void setBoundsMax(const Vector3D& boundsMax);
+
+		/**
+		* @brief Gets the minimum corner of the box of the grid
+		* @return the minimum corner
+		*/
+		const Vector3D& getBoundsMin() const;
+
+		/**
+		* @brief Gets the maximum corner of the box of the grid
+		* @return the maximum corner
+		*/
+		const Vector3D& getBoundsMax() const;
+
+		////////////////////
+		// Bouncing ratio //
+		////////////////////
+
+		/**
+		* @brief Sets the bouncing ratio of the terrain
+		*
+		* The bouncing ratio is the multiplier applied to the normal component of the rebound.
+		*
+		* @param bouncingRatio : the bouncing ratio of the terrain
+		*/
+		void setBouncingRatio(float bouncingRatio);
+
+		/**
+		* @brief Gets the bouncing ratio of the terrain
+		* @return the bouncing ratio of the terrain
+		*/
+		float getBouncingRatio() const;
+
+		//////////////
+		// Friction //
+		//////////////
+
+		/**
+		* @brief Sets the friction of the terrain
+		*
+		* The friction is the multiplier applied to the tangent component of the rebound.
+		*
+		* @param friction : the friction of the terrain
+		*/
+		void setFriction(float friction);
+
+		/**
+		* @brief Gets the friction of the terrain
+		* @return the friction of the terrain
+		*/
+		float getFriction() const;
+
+	public :
+		spark_description(Heightfield, Modifier)
+		(
+			spk_attribute(std::string, file, setFile, getFile);
+			spk_attribute(Vector3D, boundsMin, setBoundsMin, getBoundsMin);
+			spk_attribute(Vector3D, boundsMax, setBoundsMax, getBoundsMax);
+			spk_attribute(float, bouncingRatio, setBouncingRatio, getBouncingRatio);
+			spk_attribute(float, friction, setFriction, getFriction);
+		);
+
+	protected :
+
+		virtual void innerUpdateTransform();
+
+	private :
+
+		static const size_t BATCH_SIZE = 64;
+
+		FieldGrid grid;
+
+		Vector3D boundsMin;
+		Vector3D boundsMax;
+
+		float bouncingRatio;
+		float friction;
+
+		// Transformed frame of the grid
+		Vector3D tOrigin;
+		Vector3D tGridRows[3];	// rows of the matrix transforming a world offset from the origin into grid coordinates
+		Vector3D tUp;			// world offset of a unit of height
+
+		Heightfield(const Vector3D& boundsMin = Vector3D(-1.0f,0.0f,-1.0f),const Vector3D& boundsMax = Vector3D(1.0f,1.0f,1.0f),float bouncingRatio = 1.0f,float friction = 1.0f);
+		Heightfield(const Heightfield& heightfield);
+
+		void checkBatch(const Vector3D* positions,size_t nb,float* depths,unsigned char* mask) const;
+		float sampleGrid(const Vector3D& pos,Vector3D* normal) const;
+
+		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+	};
+
+	inline Ref<Heightfield> Heightfield::create(const Vector3D& boundsMin,const Vector3D& boundsMax,float bouncingRatio,float friction)
+	{
+		return SPK_NEW(Heightfield,boundsMin,boundsMax,bouncingRatio,friction);
+	}
+
+	inline void Heightfield::setFile(const std::string& path)
+	{
+		loadFromFile(path);
+	}
+
+	inline const std::string& Heightfield::getFile() const
+	{
+		return grid.getFile();
+	}
+
+	inline size_t Heightfield::getWidth() const
+	{
+		return grid.getDimension(0);
+	}
+
+	inline size_t Heightfield::getDepth() const
+	{
+		return grid.getDimension(1);
+	}
+
+	inline void Heightfield::setBounds(const Vector3D& boundsMin,const Vector3D& boundsMax)
+	{
+		this->boundsMin = boundsMin;
+		this->boundsMax = boundsMax;
+		innerUpdateTransform();
+	}
+
+	inline void Heightfield::setBoundsMin(const Vector3D& boundsMin)
+	{
+		setBounds(boundsMin,boundsMax);
+	}
+
+	inline void Heightfield::setBoundsMax(const Vector3D& boundsMax)
+	{
+		setBounds(boundsMin,boundsMax);
+	}
+
+	inline const Vector3D& Heightfield::getBoundsMin() const
+	{
+		return boundsMin;
+	}
+
+	inline const Vector3D& Heightfield::getBoundsMax() const
+	{
+		return boundsMax;
+	}
+
+	inline void Heightfield::setBouncingRatio(float bouncingRatio)
+	{
+		this->bouncingRatio = bouncingRatio;
+	}
+
+	inline float Heightfield::getBouncingRatio() const
+	{
+		return bouncingRatio;
+	}
+
+	inline void Heightfield::setFriction(float friction)
+	{
+		this->friction = friction;
+	}
+
+	inline float Heightfield::getFriction() const
+	{
+		return friction;
+	}
+}
+
+#endif
@@ -319,8 +319,13 @@ namespace SPK
 		LinearForce(const LinearForce& linearForce);
 	
 		float getDiscreteFactor(const Particle& particle) const;
+		bool isFactorByParticle(const Group& group) const;
+		float getRealCoef(const Group& group) const;
 		
 		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+
+		virtual bool isFusable(const Group& group) const;
+		virtual void getFusedForce(FusedForce& force,const Group& group,float deltaTime) const;
 	};
 
 	inline Ref<LinearForce> LinearForce::create(const Vector3D& value,const Ref<Zone>& zone,ZoneTest zoneTest)
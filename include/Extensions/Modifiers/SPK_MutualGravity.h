@@ -0,0 +1,189 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_MUTUALGRAVITY
+#define H_SPK_MUTUALGRAVITY
+
+#include <vector>
+
+namespace SPK
+{
+	/**
+	* @brief A Modifier making the particles of a group attract each other
+	*
+	* Each particle behaves as a point mass attracting all the other particles of the group (see PointMass).<br>
+	* If the mass parameter is enabled in the group, the mass of a particle is multiplied by its mass parameter.<br>
+	* <br>
+	* To remain usable with a large number of particles, forces are approximated with a Barnes-Hut tree rebuilt at each update.
+	* Groups of distant particles are considered as a single mass located at their center of mass.
+	* The complexity is therefore in O(n log n) instead of O(n²).<br>
+	* The precision of the approximation is controlled by the opening angle.
+	*/
+	class SPK_PREFIX MutualGravity : public Modifier
+	{
+	public :
+
+		/**
+		* @brief Creates a new mutual gravity
+		* @param mass : the mass of a particle
+		* @param offset : the offset
+		* @param openingAngle : the opening angle
+		*/
+		static Ref<MutualGravity> create(float mass = 1.0f,float offset = 0.01f,float openingAngle = 0.5f);
+
+		//////////
+		// Mass //
+		//////////
+
+		/**
+		* @brief Sets the mass of a particle
+		*
+		* The mass defines the strength of the attraction between particles.<br>
+		* A positive mass will result into an attraction while a negative mass will result into a repulsion.
+		*
+		* @param mass : the mass
+		*/
+		void setMass(float mass);
+
+		/**
+		* @brief Gets the mass of a particle
+		* @return the mass
+		*/
+		float getMass() const;
+
+		////////////
+		// Offset //
+		////////////
+
+		/**
+		* @brief Sets the offset
+		*
+		* The offset is added to the distance between particles during force computation.<br>
+		* It prevents the force from approaching infinity as particles get closer.<br>
+		* <br>
+		* Note that the offset must be strictly positive.
+		*
+		* @param offset : the offset
+		*/
+		void setOffset(float offset);
+
+		/**
+		* @brief Gets the offset
+		* @return the offset
+		*/
+		float getOffset() const;
+
+		///////////////////
+		// Opening angle //
+		///////////////////
+
+		/**
+		* @brief Sets the opening angle
+		*
+		* A cell of the tree is approximated by its center of mass when the ratio of its size on its distance is lower than the opening angle.<br>
+		* A value of 0 computes the exact forces but is very slow. Common values are between 0.3 and 1.0.
+		*
+		* @param openingAngle : the opening angle
+		*/
+		void setOpeningAngle(float openingAngle);
+
+		/**
+		* @brief Gets the opening angle
+		* @return the opening angle
+		*/
+		float getOpeningAngle() const;
+
+	public :
+		spark_description(MutualGravity, Modifier)
+		(
+			spk_attribute(float, mass, setMass, getMass);
+			spk_attribute(float, offset, setOffset, getOffset);
+			spk_attribute(float, openingAngle, setOpeningAngle, getOpeningAngle);
+		);
+
+	private :
+
+		static const size_t MAX_PARTICLES_PER_LEAF = 8;
+		static const size_t MAX_DEPTH = 24;
+
+		struct Node
+		{
+			Vector3D center;		// center of the cell
+			float halfSize;			// half size of the cell
+			Vector3D massCenter;	// center of mass of the particles in the cell
+			float mass;				// total mass of the particles in the cell
+			size_t begin;			// first particle (leaf) or first child (branch)
+			size_t end;				// last particle (leaf) or last child (branch) excluded
+			bool leaf;
+		};
+
+		float mass;
+		float offset;
+		float openingAngle;
+
+		// Tree data rebuilt at each update
+		mutable std::vector<Node> nodes;
+		mutable std::vector<size_t> indices;		// index of the particles in tree order
+		mutable std::vector<size_t> tmpIndices;
+		mutable std::vector<Vector3D> positions;	// in particle order
+		mutable std::vector<float> masses;			// in particle order
+		mutable std::vector<Vector3D> sortedPositions;	// in tree order
+		mutable std::vector<float> sortedMasses;		// in tree order
+
+		MutualGravity(float mass = 1.0f,float offset = 0.01f,float openingAngle = 0.5f);
+		MutualGravity(const MutualGravity& mutualGravity);
+
+		static size_t getOctant(const Vector3D& center,const Vector3D& pos);
+
+		void buildTree(const Group& group) const;
+		void buildNode(size_t nodeIndex,size_t depth) const;
+		Vector3D computeForce(const Vector3D& pos) const;
+
+		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+	};
+
+	inline Ref<MutualGravity> MutualGravity::create(float mass,float offset,float openingAngle)
+	{
+		return SPK_NEW(MutualGravity,mass,offset,openingAngle);
+	}
+
+	inline void MutualGravity::setMass(float mass)
+	{
+		this->mass = mass;
+	}
+
+	inline float MutualGravity::getMass() const
+	{
+		return mass;
+	}
+
+	inline float MutualGravity::getOffset() const
+	{
+		return offset;
+	}
+
+	inline float MutualGravity::getOpeningAngle() const
+	{
+		return openingAngle;
+	}
+}
+
+#endif
@@ -0,0 +1,218 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_OBSTACLESET
+#define H_SPK_OBSTACLESET
+
+#include <vector>
+
+namespace SPK
+{
+	/**
+	* @brief A modifier holding many obstacles at once
+	*
+	* The zones of the set act like as many Obstacle modifiers with the zone test ZONE_TEST_INTERSECT.
+	* Their bounding boxes are stored in a bounding volume hierarchy which is queried with the swept segment of each particle.
+	* Only the zones whose bounds overlap this segment are tested, so the cost is in O(n log m) instead of O(n m)
+	* for n particles and m zones.
+	*
+	* When a particle intersects several zones, it bounces on the first one in the order of the set,
+	* as it would do with a chain of Obstacle modifiers.
+	* Unbounded zones (planes) are not stored in the hierarchy and are tested for every particle.
+	*
+	* The hierarchy is rebuilt when zones are added or removed and its bounds are refitted at each update,
+	* so that zones can move or be transformed freely.
+	*/
+	class SPK_PREFIX ObstacleSet : public Modifier
+	{
+	public :
+
+		static Ref<ObstacleSet> create(float bouncingRatio = 1.0f,float friction = 1.0f);
+
+		virtual ~ObstacleSet();
+
+		///////////
+		// Zones //
+		///////////
+
+		void addZone(const Ref<Zone>& zone);
+		void removeZone(const Ref<Zone>& zone);
+		const Ref<Zone>& getZone(size_t index) const;
+		size_t getNbZones() const;
+		void clearZones();
+
+		////////////////////
+		// Bouncing ratio //
+		////////////////////
+
+		/**
+		* @brief Sets the bouncing ratio of the obstacles
+		*
+		* The bouncing ratio is the multiplier applied to the normal component of the rebound.
+		*
+		* @param bouncingRatio : the bouncing ratio of the obstacles
+		*/
+		void setBouncingRatio(float bouncingRatio);
+
+		/**
+		* @brief Gets the bouncing ratio of the obstacles
+		* @return the bouncing ratio of the obstacles
+		*/
+		float getBouncingRatio() const;
+
+		//////////////
+		// Friction //
+		//////////////
+
+		/**
+		* @brief Sets the friction of the obstacles
+		*
+		* The friction is the multiplier applied to the tangent component of the rebound.
+		*
+		* @param friction : the friction of the obstacles
+		*/
+		void setFriction(float friction);
+
+		/**
+		* @brief Gets the friction of the obstacles
+		* @return the friction of the obstacles
+		*/
+		float getFriction() const;
+
+		///////////////////////
+		// Virtual interface //
+		///////////////////////
+
+		virtual Ref<SPKObject> findByName(const std::string& name);
+
+	public :
+		spark_description(ObstacleSet, Modifier)
+		(
+			spk_attribute(float, bouncingRatio, setBouncingRatio, getBouncingRatio);
+			spk_attribute(float, friction, setFriction, getFriction);
+			spk_array(Ref<Zone>, zones, addZone, removeZone, clearZones, getZone, getNbZones);
+		);
+
+	private :
+
+		static const size_t MAX_ZONES_PER_LEAF = 2;
+		static const size_t MAX_STACK_SIZE = 64;
+
+		// A node of the hierarchy
+		// Leaves reference count zones from first in zoneIndices
+		// Internal nodes have count set to 0 and their children stored at first and first + 1
+		struct Node
+		{
+			Vector3D boundsMin;
+			Vector3D boundsMax;
+			size_t first;
+			size_t count;
+		};
+
+		// Functor used to sort zones by the center of their bounds along an axis
+		struct CompareZoneCenter
+		{
+			const std::vector<Vector3D>& boundsMin;
+			const std::vector<Vector3D>& boundsMax;
+			const size_t axis;
+
+			CompareZoneCenter(const std::vector<Vector3D>& boundsMin,const std::vector<Vector3D>& boundsMax,size_t axis) :
+				boundsMin(boundsMin),
+				boundsMax(boundsMax),
+				axis(axis)
+			{}
+
+			bool operator()(size_t zone0,size_t zone1) const
+			{
+				return boundsMin[zone0][axis] + boundsMax[zone0][axis] < boundsMin[zone1][axis] + boundsMax[zone1][axis];
+			}
+		};
+
+		std::vector<Ref<Zone> > zones;
+
+		float bouncingRatio;
+		float friction;
+
+		// The hierarchy is rebuilt at the next update when this flag is set
+		mutable bool hierarchyDirty;
+
+		mutable std::vector<Node> nodes;
+		mutable std::vector<size_t> zoneIndices;
+		mutable std::vector<size_t> unboundedZones;
+		mutable std::vector<Vector3D> zoneBoundsMin;
+		mutable std::vector<Vector3D> zoneBoundsMax;
+		mutable std::vector<size_t> candidates;
+
+		ObstacleSet(float bouncingRatio = 1.0f,float friction = 1.0f);
+		ObstacleSet(const ObstacleSet& obstacleSet);
+
+		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+		virtual void propagateUpdateTransform();
+
+		void computeZoneBounds() const;
+		void buildHierarchy() const;
+		void buildNode(size_t nodeIndex,size_t begin,size_t end) const;
+		void refitHierarchy() const;
+		void findCandidates(const Vector3D& segmentMin,const Vector3D& segmentMax) const;
+
+		static bool isUnbounded(const Vector3D& boundsMin,const Vector3D& boundsMax);
+		static bool overlaps(const Vector3D& min0,const Vector3D& max0,const Vector3D& min1,const Vector3D& max1);
+	};
+
+	inline Ref<ObstacleSet> ObstacleSet::create(float bouncingRatio,float friction)
+	{
+		return SPK_NEW(ObstacleSet,bouncingRatio,friction);
+	}
+
+	inline size_t ObstacleSet::getNbZones() const
+	{
+		return zones.size();
+	}
+
+	inline void ObstacleSet::setBouncingRatio(float bouncingRatio)
+	{
+		this->bouncingRatio = bouncingRatio;
+	}
+
+	inline float ObstacleSet::getBouncingRatio() const
+	{
+		return bouncingRatio;
+	}
+
+	inline void ObstacleSet::setFriction(float friction)
+	{
+		this->friction = friction;
+	}
+
+	inline float ObstacleSet::getFriction() const
+	{
+		return friction;
+	}
+
+	inline bool ObstacleSet::overlaps(const Vector3D& min0,const Vector3D& max0,const Vector3D& min1,const Vector3D& max1)
+	{
+		return min0.x <= max1.x && min1.x <= max0.x
+			&& min0.y <= max1.y && min1.y <= max0.y
+			&& min0.z <= max1.z && min1.z <= max0.z;
+	}
+}
+
+#endif
@@ -133,6 +133,9 @@ namespace SPK
 		PointMass(const PointMass& pointMass);
 
 		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+
+		virtual bool isFusable(const Group& group) const { return true; }
+		virtual void getFusedForce(FusedForce& force,const Group& group,float deltaTime) const;
 	};
 
 	inline Ref<PointMass> PointMass::create(const Vector3D& pos,float mass,float offset)
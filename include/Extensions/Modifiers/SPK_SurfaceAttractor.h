@@ -0,0 +1,226 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_SURFACEATTRACTOR
+#define H_SPK_SURFACEATTRACTOR
+
+namespace SPK
+{
+	class DistanceField;
+
+	/**
+	* @brief A Modifier attracting particles onto the surface of a DistanceField
+	*
+	* Particles are pulled along the gradient of the field towards its zero level set, with a force proportional to their distance to the surface.
+	* This allows particles to gather into any shape (a logo, a character...) without storing a target per particle.<br>
+	* <br>
+	* At each step, the velocity of a particle is modified as follow :<br>
+	* <i>velocity -= normal * (distance * strength + normalSpeed * damping) * deltaTime</i><br>
+	* <i>velocity += (flow - normal * dot(flow,normal)) * deltaTime</i><br>
+	* where normal is the normalized gradient of the field and normalSpeed is the component of the velocity along it.<br>
+	* The damping prevents particles from oscillating around the surface and the flow makes them slide along it.<br>
+	* <br>
+	* The field is sampled by batch, so the cost per particle is a trilinear interpolation whatever the shape.
+	*/
+	class SPK_PREFIX SurfaceAttractor : public Modifier
+	{
+	public :
+
+		/**
+		* @brief Creates a new surface attractor
+		* @param field : the distance field (must be a DistanceField)
+		* @param strength : the strength of the attraction
+		* @param damping : the damping of the velocity along the normal of the surface
+		* @param flow : the acceleration along the surface
+		* @return a new surface attractor
+		*/
+		static Ref<SurfaceAttractor> create(
+			const Ref<Zone>& field = SPK_NULL_REF,
+			float strength = 1.0f,
+			float damping = 0.0f,
+			const Vector3D& flow = Vector3D());
+
+		///////////
+		// Field //
+		///////////
+
+		/**
+		* @brief Sets the distance field attracting the particles
+		* The zone must be a DistanceField. If not, the field is unset and particles are not affected.
+		* @param field : the distance field
+		*/
+		void setField(const Ref<Zone>& field);
+
+		/**
+		* @brief Gets the distance field attracting the particles
+		* @return the distance field
+		*/
+		const Ref<Zone>& getField() const;
+
+		//////////////
+		// Strength //
+		//////////////
+
+		/**
+		* @brief Sets the strength of the attraction
+		* The attraction is the strength multiplied by the distance to the surface.
+		* @param strength : the strength of the attraction
+		*/
+		void setStrength(float strength);
+
+		/**
+		* @brief Gets the strength of the attraction
+		* @return the strength of the attraction
+		*/
+		float getStrength() const;
+
+		/////////////
+		// Damping //
+		/////////////
+
+		/**
+		* @brief Sets the damping of the velocity along the normal of the surface
+		* @param damping : the damping
+		*/
+		void setDamping(float damping);
+
+		/**
+		* @brief Gets the damping of the velocity along the normal of the surface
+		* @return the damping
+		*/
+		float getDamping() const;
+
+		//////////
+		// Flow //
+		//////////
+
+		/**
+		* @brief Sets the flow along the surface
+		* The flow is an acceleration projected onto the tangent plane of the surface at the position of each particle.
+		* @param flow : the flow
+		*/
+		void setFlow(const Vector3D& flow);
+
+		/**
+		* @brief Gets the flow along the surface
+		* @return the flow
+		*/
+		const Vector3D& getFlow() const;
+
+		/**
+		* @brief Gets the transformed flow along the surface
+		* @return the transformed flow
+		*/
+		const Vector3D& getTransformedFlow() const;
+
+		///////////////////////
+		// Virtual interface //
+		///////////////////////
+
+		virtual Ref<SPKObject> findByName(const std::string& name);
+
+	public :
+		spark_description(SurfaceAttractor, Modifier)
+		(
+			spk_attribute(Ref<Zone>, field, setField, getField);
+			spk_attribute(float, strength, setStrength, getStrength);
+			spk_attribute(float, damping, setDamping, getDamping);
+			spk_attribute(Vector3D, flow, setFlow, getFlow);
+		);
+
+	protected :
+
+		virtual void innerUpdateTransform();
+		virtual void propagateUpdateTransform();
+
+	private :
+
+		static const size_t BATCH_SIZE = 64;
+
+		Ref<Zone> field;
+		const DistanceField* distanceField; // The field as a distance field, owned by the reference above
+
+		float strength;
+		float damping;
+
+		Vector3D flow;
+		Vector3D tFlow;
+
+		SurfaceAttractor(const Ref<Zone>& field = SPK_NULL_REF,float strength = 1.0f,float damping = 0.0f,const Vector3D& flow = Vector3D());
+		SurfaceAttractor(const SurfaceAttractor& attractor);
+
+		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+	};
+
+	inline Ref<SurfaceAttractor> SurfaceAttractor::create(const Ref<Zone>& field,float strength,float damping,const Vector3D& flow)
+	{
+		return SPK_NEW(SurfaceAttractor,field,strength,damping,flow);
+	}
+
+	inline const Ref<Zone>& SurfaceAttractor::getField() const
+	{
+		return field;
+	}
+
+	inline void SurfaceAttractor::setStrength(float strength)
+	{
+		this->strength = strength;
+	}
+
+	inline float SurfaceAttractor::getStrength() const
+	{
+		return strength;
+	}
+
+	inline void SurfaceAttractor::setDamping(float damping)
+	{
+		this->damping = damping;
+	}
+
+	inline float SurfaceAttractor::getDamping() const
+	{
+		return damping;
+	}
+
+	inline void SurfaceAttractor::setFlow(const Vector3D& flow)
+	{
+		this->flow = flow;
+		transformDir(tFlow,flow);
+	}
+
+	inline const Vector3D& SurfaceAttractor::getFlow() const
+	{
+		return flow;
+	}
+
+	inline const Vector3D& SurfaceAttractor::getTransformedFlow() const
+	{
+		return tFlow;
+	}
+
+	inline void SurfaceAttractor::innerUpdateTransform()
+	{
+		Modifier::innerUpdateTransform();
+		transformDir(tFlow,flow);
+	}
+}
+
+#endif
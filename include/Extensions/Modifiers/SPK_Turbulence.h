@@ -0,0 +1,171 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_TURBULENCE
+#define H_SPK_TURBULENCE
+
+#include <vector>
+
+namespace SPK
+{
+	/**
+	* @brief A Modifier applying a smooth turbulent force based on curl noise
+	*
+	* The force is the curl of a noise field. Being divergence free, it makes particles swirl without gathering them in sinks or sources.<br>
+	* The noise is precomputed once in a small tileable lattice at construction.
+	* The force at the position of a particle is then a single trilinear lookup in the lattice.<br>
+	* <br>
+	* Unlike RandomForce, no data is stored per particle and the motion is continuous in space and time.<br>
+	* The frequency defines the number of noise periods per unit and the scroll makes the noise move over time.
+	* The scrolled offset of the noise is kept per group so that a turbulence can be shared between groups.
+	*/
+	class SPK_PREFIX Turbulence : public Modifier
+	{
+	public :
+
+		/**
+		* @brief Creates a new turbulence
+		* @param strength : the strength of the force
+		* @param frequency : the number of noise periods per unit
+		* @param scroll : the speed at which the noise moves
+		* @return a new turbulence
+		*/
+		static Ref<Turbulence> create(float strength = 1.0f,float frequency = 0.1f,const Vector3D& scroll = Vector3D());
+
+		/**
+		* @brief Sets the strength of the force
+		* @param strength : the strength
+		*/
+		void setStrength(float strength);
+
+		/**
+		* @brief Gets the strength of the force
+		* @return the strength
+		*/
+		float getStrength() const;
+
+		/**
+		* @brief Sets the frequency of the noise
+		* The frequency is the number of noise periods per unit. The higher, the smaller the swirls.
+		* @param frequency : the frequency
+		*/
+		void setFrequency(float frequency);
+
+		/**
+		* @brief Gets the frequency of the noise
+		* @return the frequency
+		*/
+		float getFrequency() const;
+
+		/**
+		* @brief Sets the scroll of the noise
+		* The scroll is the speed (in units per second) at which the noise moves.
+		* @param scroll : the scroll
+		*/
+		void setScroll(const Vector3D& scroll);
+
+		/**
+		* @brief Gets the scroll of the noise
+		* @return the scroll
+		*/
+		const Vector3D& getScroll() const;
+
+	public :
+		spark_description(Turbulence, Modifier)
+		(
+			spk_attribute(float, strength, setStrength, getStrength);
+			spk_attribute(float, frequency, setFrequency, getFrequency);
+			spk_attribute(Vector3D, scroll, setScroll, getScroll);
+		);
+
+	protected :
+
+		virtual void createData(DataSet& dataSet,const Group& group) const;
+
+	private :
+
+		static const float PI;
+		static const size_t LATTICE_SIZE = 16; // Must be a power of 2
+		static const size_t NB_WAVES = 8;
+
+		// Data indices
+		static const size_t NB_DATA = 1;
+		static const size_t SCROLL_INDEX = 0;
+
+		// Offset of the noise scrolled since the creation of the group
+		class ScrollData : public Data
+		{
+		public :
+
+			Vector3D offset;
+
+		private :
+
+			virtual void swap(size_t index0,size_t index1) {}
+		};
+
+		float strength;
+		float frequency;
+		Vector3D scroll;
+
+		// The curl of the noise at each node of the lattice as consecutive x,y,z floats
+		std::vector<float> lattice;
+
+		Turbulence(float strength = 1.0f,float frequency = 0.1f,const Vector3D& scroll = Vector3D());
+		Turbulence(const Turbulence& turbulence);
+
+		void buildLattice();
+
+		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+	};
+
+	inline Ref<Turbulence> Turbulence::create(float strength,float frequency,const Vector3D& scroll)
+	{
+		return SPK_NEW(Turbulence,strength,frequency,scroll);
+	}
+
+	inline void Turbulence::setStrength(float strength)
+	{
+		this->strength = strength;
+	}
+
+	inline float Turbulence::getStrength() const
+	{
+		return strength;
+	}
+
+	inline float Turbulence::getFrequency() const
+	{
+		return frequency;
+	}
+
+	inline void Turbulence::setScroll(const Vector3D& scroll)
+	{
+		this->scroll = scroll;
+	}
+
+	inline const Vector3D& Turbulence::getScroll() const
+	{
+		return scroll;
+	}
+}
+
+#endif
@@ -0,0 +1,359 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_VECTORFIELD
+#define H_SPK_VECTORFIELD
+
+namespace SPK
+{
+	/**
+	* @brief A Modifier applying vectors sampled from a 3D grid
+	*
+	* The grid holds one vector per node and is stretched over a box defined in the local space of the modifier.
+	* The vector at the position of a particle is computed by trilinear interpolation of the 8 surrounding nodes.<br>
+	* <br>
+	* Vectors can be used in 2 ways :
+	* <ul>
+	* <li>as a force : the vector multiplied by the strength is added to the velocity</li>
+	* <li>as a velocity (relative mode) : the velocity of the particle goes toward the vector at a rate defined by the strength</li>
+	* </ul>
+	* This allows to bake wind or fluid simulations offline and to replay them at the cost of a single lookup per particle.<br>
+	* <br>
+	* The grid can be loaded from a raw binary file (see loadFromFile(const std::string&)),
+	* copied from memory or referenced from an external buffer such as a memory mapped file.
+	*/
+	class SPK_PREFIX VectorField : public Modifier
+	{
+	public :
+
+		/**
+		* @brief Creates a new vector field
+		* @param boundsMin : the minimum corner of the box of the grid
+		* @param boundsMax : the maximum corner of the box of the grid
+		* @param strength : the strength
+		* @param relative : true to use vectors as velocities, false to use them as forces
+		* @return a new vector field
+		*/
+		static Ref<VectorField> create(
+			const Vector3D& boundsMin = Vector3D(-1.0f,-1.0f,-1.0f),
+			const Vector3D& boundsMax = Vector3D(1.0f,1.0f,1.0f),
+			float strength = 1.0f,
+			bool relative = false);
+
+		//////////
+		// Grid //
+		//////////
+
+		/**
+		* @brief Sets the grid by copying the given vectors
+		*
+		* Vectors are given as consecutive x,y,z floats.
+		* They are ordered by x first, then y then z : the vector of node (i,j,k) starts at (i + j * width + k * width * height) * 3.
+		*
+		* @param width : the number of nodes along the x axis
+		* @param height : the number of nodes along the y axis
+		* @param depth : the number of nodes along the z axis
+		* @param data : the vectors of the grid
+		*/
+		void setGrid(size_t width,size_t height,size_t depth,const float* data);
+
+		/**
+		* @brief Sets the grid from an external buffer without copying it
+		*
+		* This is useful to sample a memory mapped file or a buffer shared between several fields.<br>
+		* The buffer must remain valid as long as it is used by the vector field.
+		* See setGrid(size_t,size_t,size_t,const float*) for the layout of the data.
+		*
+		* @param width : the number of nodes along the x axis
+		* @param height : the number of nodes along the y axis
+		* @param depth : the number of nodes along the z axis
+		* @param data : the vectors of the grid
+		*/
+		void setExternalGrid(size_t width,size_t height,size_t depth,const float* data);
+
+		/**
+		* @brief Loads the grid from a raw binary file
+		*
+		* The file starts with the width, the height and the depth of the grid as 3 unsigned 32 bits integers.
+		* Then the vectors follow as 32 bits floats with the layout described in setGrid(size_t,size_t,size_t,const float*).<br>
+		* The data is expected to be in the native endianness.
+		*
+		* @param path : the path of the file
+		* @return true if the grid was loaded, false if not
+		*/
+		bool loadFromFile(const std::string& path);
+
+		/**
+		* @brief Sets the file of the grid
+		* This is the same as loadFromFile(const std::string&) but fits the attribute interface.
+		* @param path : the path of the file
+		*/
+		void setFile(const std::string& path);
+
+		/**
+		* @brief Gets the file of the grid
+		* @return the path of the file of the grid or an empty string if the grid was not loaded from a file
+		*/
+		const std::string& getFile() const;
+
+		/**
+		* @brief Gets the number of nodes along the x axis
+		* @return the width of the grid
+		*/
+		size_t getWidth() const;
+
+		/**
+		* @brief Gets the number of nodes along the y axis
+		* @return the height of the grid
+		*/
+		size_t getHeight() const;
+
+		/**
+		* @brief Gets the number of nodes along the z axis
+		* @return the depth of the grid
+		*/
+		size_t getDepth() const;
+
+		////////////
+		// Bounds //
+		////////////
+
+		/**
+		* @brief Sets the box over which the grid is stretched
+		* The first node of the grid is at the minimum corner and the last node is at the maximum corner.
+		* @param boundsMin : the minimum corner
+		* @param boundsMax : the maximum corner
+		*/
+		void setBounds(const Vector3D& boundsMin,const Vector3D& boundsMax);
+
+		/**
+		* @brief Sets the minimum corner of the box of the grid
+		* @param boundsMin : the minimum corner
+		*/
+		void setBoundsMin(const Vector3D& boundsMin);
+
+		/**
+		* @brief Sets the maximum corner of the box of the grid
+		* @param boundsMax : the maximum corner
+		*/
+		void setBoundsMax(const Vector3D& boundsMax);
+
+		/**
+		* @brief Gets the minimum corner of the box of the grid
+		* @return the minimum corner
+		*/
+		const Vector3D& getBoundsMin() const;
+
+		/**
+		* @brief Gets the maximum corner of the box of the grid
+		* @return the maximum corner
+		*/
+		const Vector3D& getBoundsMax() const;
+
+		/**
+		* @brief Sets whether particles outside the box are affected
+		* If true, particles outside the box use the vector of the closest border. If false, they are not affected.
+		* @param clamp : true to clamp particles to the borders, false to ignore particles outside
+		*/
+		void setBordersClamped(bool clamp);
+
+		/**
+		* @brief Tells whether particles outside the box are affected
+		* @return true if particles are clamped to the borders, false if not
+		*/
+		bool areBordersClamped() const;
+
+		//////////////
+		// Strength //
+		//////////////
+
+		/**
+		* @brief Sets the strength
+		*
+		* As a force, the strength is a factor applied to the vectors.<br>
+		* As a velocity, the strength is the rate at which the velocity of particles reaches the vectors.
+		*
+		* @param strength : the strength
+		*/
+		void setStrength(float strength);
+
+		/**
+		* @brief Gets the strength
+		* @return the strength
+		*/
+		float getStrength() const;
+
+		/**
+		* @brief Sets whether vectors are velocities or forces
+		* @param relative : true to use vectors as velocities, false to use them as forces
+		*/
+		void setRelative(bool relative);
+
+		/**
+		* @brief Tells whether vectors are velocities or forces
+		* @return true if vectors are velocities, false if they are forces
+		*/
+		bool isRelative() const;
+
+		//////////////
+		// Sampling //
+		//////////////
+
+		/**
+		* @brief Samples the field at several positions
+		*
+		* Positions are in world space and the resulting vectors too.<br>
+		* The result for a position outside the box is a null vector unless borders are clamped.
+		*
+		* @param positions : the positions where to sample the field
+		* @param results : the array where to store the sampled vectors
+		* @param nb : the number of positions
+		*/
+		void sample(const Vector3D* positions,Vector3D* results,size_t nb) const;
+
+	public :
+		spark_description(VectorField, Modifier)
+		(
+			spk_attribute(std::string, file, setFile, getFile);
+			spk_attribute(Vector3D, boundsMin, setBoundsMin, getBoundsMin);
+			spk_attribute(Vector3D, boundsMax, setBoundsMax, getBoundsMax);
+			spk_attribute(bool, clampBorders, setBordersClamped, areBordersClamped);
+			spk_attribute(float, strength, setStrength, getStrength);
+			spk_attribute(bool, relative, setRelative, isRelative);
+		);
+
+	protected :
+
+		virtual void innerUpdateTransform();
+
+	private :
+
+		FieldGrid grid;
+
+		Vector3D boundsMin;
+		Vector3D boundsMax;
+		bool clampBorders;
+
+		float strength;
+		bool relative;
+
+		// Transformed frame of the grid
+		Vector3D tOrigin;
+		Vector3D tGridRows[3];	// rows of the matrix transforming a world offset from the origin into grid coordinates
+		Vector3D tAxis[3];		// normalized world directions of the local axes
+
+		VectorField(const Vector3D& boundsMin = Vector3D(-1.0f,-1.0f,-1.0f),const Vector3D& boundsMax = Vector3D(1.0f,1.0f,1.0f),float strength = 1.0f,bool relative = false);
+		VectorField(const VectorField& vectorField);
+
+		bool sampleGrid(const Vector3D& pos,Vector3D& result) const;
+
+		virtual void modify(Group& group,DataSet* dataSet,float deltaTime) const;
+	};
+
+	inline Ref<VectorField> VectorField::create(const Vector3D& boundsMin,const Vector3D& boundsMax,float strength,bool relative)
+	{
+		return SPK_NEW(VectorField,boundsMin,boundsMax,strength,relative);
+	}
+
+	inline void VectorField::setFile(const std::string& path)
+	{
+		loadFromFile(path);
+	}
+
+	inline const std::string& VectorField::getFile() const
+	{
+		return grid.getFile();
+	}
+
+	inline size_t VectorField::getWidth() const
+	{
+		return grid.getDimension(0);
+	}
+
+	inline size_t VectorField::getHeight() const
+	{
+		return grid.getDimension(1);
+	}
+
+	inline size_t VectorField::getDepth() const
+	{
+		return grid.getDimension(2);
+	}
+
+	inline void VectorField::setBounds(const Vector3D& boundsMin,const Vector3D& boundsMax)
+	{
+		this->boundsMin = boundsMin;
+		this->boundsMax = boundsMax;
+		innerUpdateTransform();
+	}
+
+	inline void VectorField::setBoundsMin(const Vector3D& boundsMin)
+	{
+		setBounds(boundsMin,boundsMax);
+	}
+
+	inline void VectorField::setBoundsMax(const Vector3D& boundsMax)
+	{
+		setBounds(boundsMin,boundsMax);
+	}
+
+	inline const Vector3D& VectorField::getBoundsMin() const
+	{
+		return boundsMin;
+	}
+
+	inline const Vector3D& VectorField::getBoundsMax() const
+	{
+		return boundsMax;
+	}
+
+	inline void VectorField::setBordersClamped(bool clamp)
+	{
+		clampBorders = clamp;
+	}
+
+	inline bool VectorField::areBordersClamped() const
+	{
+		return clampBorders;
+	}
+
+	inline void VectorField::setStrength(float strength)
+	{
+		this->strength = strength;
+	}
+
+	inline float VectorField::getStrength() const
+	{
+		return strength;
+	}
+
+	inline void VectorField::setRelative(bool relative)
+	{
+		this->relative = relative;
+	}
+
+	inline bool VectorField::isRelative() const
+	{
+		return relative;
+	}
+}
+
+#endif
@@ -202,6 +202,28 @@ namespace SPK
 		*/
 		bool isParticleKillingEnabled() const;
 
+		//////////////////
+		// Computations //
+		//////////////////
+
+		/**
+		* @brief Tells whether to use fast approximations in computations
+		*
+		* When enabled, the inverse square root, the sine and the cosine are computed with approximations
+		* (relative error lower than 0.2%) instead of the standard functions.<br>
+		* This is faster and the difference is not noticeable in most cases.<br>
+		* By default, fast computation is disabled.
+		*
+		* @param fast : true to use fast approximations, false to use the standard functions
+		*/
+		void enableFastComputation(bool fast);
+
+		/**
+		* @brief Tells whether fast approximations are used in computations
+		* @return true if fast approximations are used, false if not
+		*/
+		bool isFastComputationEnabled() const;
+
 	public :
 		spark_description(Vortex, Modifier)
 		(
@@ -213,6 +235,7 @@ namespace SPK
 			spk_attribute(bool, linearAttractionSpeed, setAttractionSpeedLinear, isAttractionSpeedLinear);
 			spk_attribute(float, eyeRadius, setEyeRadius, getEyeRadius);
 			spk_attribute(bool, killParticles, enableParticleKilling, isParticleKillingEnabled);
+			spk_attribute(bool, fastComputation, enableFastComputation, isFastComputationEnabled);
 		);
 
 	protected :
@@ -236,6 +259,8 @@ namespace SPK
 		float eyeRadius;
 		bool killingParticleEnabled;
 
+		bool fastComputationEnabled;
+
 		Vortex(const Vector3D& position = Vector3D(),const Vector3D& direction = Vector3D(0.0f,1.0f,0.0f),float rotationSpeed = 1.0f,float attractionSpeed = 0.0f);
 		Vortex(const Vortex& vortex);
 
@@ -347,6 +372,16 @@ namespace SPK
 	{
 		return killingParticleEnabled;
 	}
+
+	inline void Vortex::enableFastComputation(bool fast)
+	{
+		fastComputationEnabled = fast;
+	}
+
+	inline bool Vortex::isFastComputationEnabled() const
+	{
+		return fastComputationEnabled;
+	}
 }
 
 #endif
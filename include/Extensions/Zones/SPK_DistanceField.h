@@ -0,0 +1,275 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_DISTANCEFIELD
+#define H_SPK_DISTANCEFIELD
+
+namespace SPK
+{
+	class TriangleMesh;
+
+	/**
+	* @brief A Zone defined by a signed distance field
+	*
+	* The field is a grid of distances to the surface of a shape, negative inside and positive outside.
+	* It is stretched over an axis aligned box (in the local space of the zone) centered on the position of the zone.<br>
+	* <br>
+	* Distances and gradients are computed by trilinear interpolation of the 8 surrounding nodes,
+	* so the cost of a query does not depend on the complexity of the shape nor on the size of the grid.
+	* This makes this zone well suited to collide particles against complex static geometry.
+	* Outside the grid, the distance is approximated by adding the distance to the grid.<br>
+	* <br>
+	* Distances are expressed in the local space of the zone. A transform with a non uniform scale distorts the field.<br>
+	* <br>
+	* The field can be loaded from a raw binary file (see loadFromFile(const std::string&)),
+	* copied from memory, referenced from an external buffer such as a memory mapped file
+	* or baked from a TriangleMesh (see bakeFromMesh(const TriangleMesh&,size_t,size_t,size_t)).
+	*/
+	class SPK_PREFIX DistanceField : public Zone
+	{
+	public :
+
+		/**
+		* @brief Creates a new distance field
+		* @param position : the position of the center of the grid
+		* @param dimensions : the dimensions of the box of the grid
+		* @return a new distance field
+		*/
+		static Ref<DistanceField> create(
+			const Vector3D& position = Vector3D(),
+			const Vector3D& dimensions = Vector3D(1.0f,1.0f,1.0f));
+
+		////////////////
+		// Dimensions //
+		////////////////
+
+		/**
+		* @brief Sets the dimensions of the box over which the grid is stretched
+		* The first node of the grid is at the minimum corner of the box and the last node is at its maximum corner.
+		* @param dimensions : the dimensions of the box
+		*/
+		void setDimensions(const Vector3D& dimensions);
+
+		/**
+		* @brief Gets the dimensions of the box over which the grid is stretched
+		* @return the dimensions of the box
+		*/
+		const Vector3D& getDimensions() const;
+
+		//////////
+		// Grid //
+		//////////
+
+		/**
+		* @brief Sets the grid by copying the given distances
+		*
+		* Distances are ordered by x first, then y, then z : the distance of node (i,j,k) is at i + (j + k * height) * width.
+		*
+		* @param width : the number of nodes along the x axis
+		* @param height : the number of nodes along the y axis
+		* @param depth : the number of nodes along the z axis
+		* @param distances : the distances of the grid
+		*/
+		void setGrid(size_t width,size_t height,size_t depth,const float* distances);
+
+		/**
+		* @brief Sets the grid from an external buffer without copying it
+		*
+		* This is useful to sample a memory mapped file or a buffer shared between several zones.<br>
+		* The buffer must remain valid as long as it is used by the zone.
+		* See setGrid(size_t,size_t,size_t,const float*) for the layout of the data.
+		*
+		* @param width : the number of nodes along the x axis
+		* @param height : the number of nodes along the y axis
+		* @param depth : the number of nodes along the z axis
+		* @param distances : the distances of the grid
+		*/
+		void setExternalGrid(size_t width,size_t height,size_t depth,const float* distances);
+
+		/**
+		* @brief Bakes the grid from a triangle mesh
+		*
+		* The distance of each node is computed in world space with the current transforms of the mesh and of this zone.
+		* The mesh is expected to be closed for the sign to be meaningful.<br>
+		* This is meant to be done offline : the result can then be saved with saveToFile(const std::string&).
+		*
+		* @param mesh : the mesh to bake
+		* @param width : the number of nodes along the x axis
+		* @param height : the number of nodes along the y axis
+		* @param depth : the number of nodes along the z axis
+		*/
+		void bakeFromMesh(const TriangleMesh& mesh,size_t width,size_t height,size_t depth);
+
+		/**
+		* @brief Loads the grid from a raw binary file
+		*
+		* The file starts with the width, the height and the depth of the grid as 3 unsigned 32 bits integers.
+		* Then the distances follow as 32 bits floats with the layout described in setGrid(size_t,size_t,size_t,const float*).<br>
+		* The data is expected to be in the native endianness.
+		*
+		* @param path : the path of the file
+		* @return true if the grid was loaded, false if not
+		*/
+		bool loadFromFile(const std::string& path);
+
+		/**
+		* @brief Saves the grid to a raw binary file
+		* See loadFromFile(const std::string&) for the format.
+		* @param path : the path of the file
+		* @return true if the grid was saved, false if not
+		*/
+		bool saveToFile(const std::string& path) const;
+
+		/**
+		* @brief Sets the file of the grid
+		* This is the same as loadFromFile(const std::string&) but fits the attribute interface.
+		* @param path : the path of the file
+		*/
+		void setFile(const std::string& path);
+
+		/**
+		* @brief Gets the file of the grid
+		* @return the path of the file of the grid or an empty string if the grid was not loaded from a file
+		*/
+		const std::string& getFile() const;
+
+		/**
+		* @brief Gets the number of nodes along the x axis
+		* @return the width of the grid
+		*/
+		size_t getWidth() const;
+
+		/**
+		* @brief Gets the number of nodes along the y axis
+		* @return the height of the grid
+		*/
+		size_t getHeight() const;
+
+		/**
+		* @brief Gets the number of nodes along the z axis
+		* @return the depth of the grid
+		*/
+		size_t getDepth() const;
+
+		/**
+		* @brief Computes the signed distance between a point and the surface
+		* @param v : the point in world space
+		* @param gradient : a pointer to a vector where to store the gradient of the distance or NULL
+		* @return the signed distance, negative inside the shape
+		*/
+		float computeDistance(const Vector3D& v,Vector3D* gradient = NULL) const;
+
+		/**
+		* @brief Computes the signed distances and the gradients of several points at once
+		*
+		* This is faster than calling computeDistance(const Vector3D&,Vector3D*) for each point.<br>
+		* Gradients are not normalized. If the grid is not set, distances are set to the maximum float value and gradients to null vectors.
+		*
+		* @param v : the points in world space
+		* @param nb : the number of points
+		* @param distances : the array where to store the signed distances
+		* @param gradients : the array where to store the gradients
+		*/
+		void computeDistanceBatch(const Vector3D* v,size_t nb,float* distances,Vector3D* gradients) const;
+
+		///////////////
+		// Interface //
+		///////////////
+
+		virtual void generatePosition(Vector3D& v,bool full,float radius = 0.0f) const;
+		virtual bool contains(const Vector3D& v,float radius = 0.0f) const;
+		virtual bool intersects(const Vector3D& v0,const Vector3D& v1,float radius = 0.0f,Vector3D* normal = NULL) const;
+		virtual Vector3D computeNormal(const Vector3D& v) const;
+		virtual void containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const;
+		virtual void intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const;
+		virtual void computeBounds(Vector3D& boundsMin,Vector3D& boundsMax) const;
+
+	public :
+		spark_description(DistanceField, Zone)
+		(
+			spk_attribute(Vector3D, dimensions, setDimensions, getDimensions);
+			spk_attribute(std::string, file, setFile, getFile);
+		);
+
+	protected :
+
+		virtual void innerUpdateTransform();
+
+	private :
+
+		static const size_t MAX_MARCHING_STEPS = 32;
+		static const size_t NB_BISECTION_STEPS = 8;
+		static const size_t MAX_GENERATION_TRIES = 32;
+		static const size_t NB_PROJECTION_STEPS = 3;
+
+		Vector3D dimensions;
+
+		FieldGrid grid;
+
+		// Transformed frame of the grid, relative to the transformed position
+		Vector3D tOrigin;		// minimum corner of the grid
+		Vector3D tEdges[3];		// edges of the box of the grid
+		Vector3D tGridRows[3];	// rows of the matrix transforming an offset from the origin into coordinates in [0,1]
+		float tScale;			// world length of a local unit
+
+		DistanceField(const Vector3D& position = Vector3D(),const Vector3D& dimensions = Vector3D(1.0f,1.0f,1.0f));
+		DistanceField(const DistanceField& field);
+
+		float sampleField(const Vector3D& d,Vector3D* gradient) const;
+	};
+
+	inline Ref<DistanceField> DistanceField::create(const Vector3D& position,const Vector3D& dimensions)
+	{
+		return SPK_NEW(DistanceField,position,dimensions);
+	}
+
+	inline const Vector3D& DistanceField::getDimensions() const
+	{
+		return dimensions;
+	}
+
+	inline void DistanceField::setFile(const std::string& path)
+	{
+		loadFromFile(path);
+	}
+
+	inline const std::string& DistanceField::getFile() const
+	{
+		return grid.getFile();
+	}
+
+	inline size_t DistanceField::getWidth() const
+	{
+		return grid.getDimension(0);
+	}
+
+	inline size_t DistanceField::getHeight() const
+	{
+		return grid.getDimension(1);
+	}
+
+	inline size_t DistanceField::getDepth() const
+	{
+		return grid.getDimension(2);
+	}
+}
+
+#endif
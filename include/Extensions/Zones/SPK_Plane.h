@@ -87,6 +87,8 @@ namespace SPK
 		virtual bool contains(const Vector3D& v,float radius = 0.0f) const;
 		virtual bool intersects(const Vector3D& v0,const Vector3D& v1,float radius = 0.0f,Vector3D* normal = NULL) const;
 		virtual Vector3D computeNormal(const Vector3D& v) const;
+		virtual void containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const;
+		virtual void intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const;
 
 	public :
 		spark_description(Plane, Zone)
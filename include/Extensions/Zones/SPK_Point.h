@@ -22,6 +22,8 @@
 #ifndef H_SPK_POINT
 #define H_SPK_POINT
 
+#include <cstring> // for std::memset
+
 namespace SPK
 {
 	class Point : public Zone
@@ -34,6 +36,9 @@ namespace SPK
 		virtual bool contains(const Vector3D& v,float radius = 0.0f) const;
 		virtual bool intersects(const Vector3D& v0,const Vector3D& v1,float radius = 0.0f,Vector3D* normal = NULL) const;
 		virtual Vector3D computeNormal(const Vector3D& v) const;
+		virtual void containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const;
+		virtual void intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const;
+		virtual void computeBounds(Vector3D& boundsMin,Vector3D& boundsMax) const;
 
 	public :
 		spark_description(Point, Zone)
@@ -74,6 +79,21 @@ namespace SPK
 		return false;
 	}
 
+	inline void Point::containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		std::memset(mask,0,nb);
+	}
+
+	inline void Point::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		std::memset(mask,0,nb);
+	}
+
+	inline void Point::computeBounds(Vector3D& boundsMin,Vector3D& boundsMax) const
+	{
+		boundsMin = boundsMax = getTransformedPosition();
+	}
+
 	inline Vector3D Point::computeNormal(const Vector3D& v) const
 	{
 		Vector3D normal(v - getTransformedPosition());
@@ -0,0 +1,259 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef H_SPK_TRIANGLEMESH
+#define H_SPK_TRIANGLEMESH
+
+#include <vector>
+
+namespace SPK
+{
+	/**
+	* @brief A Zone defined by a triangle mesh
+	*
+	* The mesh is given as an array of vertices, relative to the position of the zone, and an array of indices (3 per triangle).
+	* The triangles are stored in a bounding volume hierarchy built once when the mesh is set,
+	* so that tests only look at the triangles close to the tested points.<br>
+	* <br>
+	* The mesh is expected to be closed for the inside tests : a point is inside if a ray cast from it crosses the mesh an odd number of times.
+	* Intersections are tested between the moving segment of a particle and the triangles moved towards it by its radius.<br>
+	* <br>
+	* The mesh can be saved to and loaded from a raw binary file holding the hierarchy as well,
+	* so that loading a mesh does not need to build the hierarchy again (see saveToFile(const std::string&)).<br>
+	* <br>
+	* All tests are const, use no shared buffer and do not allocate memory, so they can be called from several threads at once.
+	*/
+	class SPK_PREFIX TriangleMesh : public Zone
+	{
+	public :
+
+		/**
+		* @brief Creates a new triangle mesh zone
+		* @param position : the position of the zone
+		* @return a new triangle mesh zone, without triangles
+		*/
+		static Ref<TriangleMesh> create(const Vector3D& position = Vector3D());
+
+		//////////
+		// Mesh //
+		//////////
+
+		/**
+		* @brief Sets the mesh of the zone
+		*
+		* The data is copied and the hierarchy is built.
+		* Note that the triangles are reordered to follow the hierarchy.
+		*
+		* @param vertices : the vertices of the mesh, relative to the position of the zone
+		* @param nbVertices : the number of vertices
+		* @param indices : the indices of the vertices of the triangles (3 per triangle)
+		* @param nbTriangles : the number of triangles
+		*/
+		void setMesh(const Vector3D* vertices,size_t nbVertices,const unsigned int* indices,size_t nbTriangles);
+
+		/**
+		* @brief Gets the number of vertices of the mesh
+		* @return the number of vertices
+		*/
+		size_t getNbVertices() const;
+
+		/**
+		* @brief Gets the number of triangles of the mesh
+		* @return the number of triangles
+		*/
+		size_t getNbTriangles() const;
+
+		/**
+		* @brief Gets a vertex of the mesh
+		* @param index : the index of the vertex
+		* @return the vertex, relative to the position of the zone
+		*/
+		const Vector3D& getVertex(size_t index) const;
+
+		/**
+		* @brief Gets the indices of the vertices of the triangles
+		* @return the indices (3 per triangle, in the order of the hierarchy)
+		*/
+		const unsigned int* getIndices() const;
+
+		/**
+		* @brief Loads the mesh and its hierarchy from a raw binary file
+		*
+		* The file starts with the number of vertices, the number of triangles and the number of nodes of the hierarchy
+		* as 3 unsigned 32 bits integers.
+		* Then follow the vertices (3 floats each), the indices (3 unsigned 32 bits integers per triangle)
+		* and the nodes (the index of the first child or triangle and the number of triangles, as 2 unsigned 32 bits integers).<br>
+		* The data is expected to be in the native endianness. Such a file is written by saveToFile(const std::string&).
+		*
+		* @param path : the path of the file
+		* @return true if the mesh was loaded, false if not
+		*/
+		bool loadFromFile(const std::string& path);
+
+		/**
+		* @brief Saves the mesh and its hierarchy to a raw binary file
+		* See loadFromFile(const std::string&) for the format.
+		* @param path : the path of the file
+		* @return true if the mesh was saved, false if not
+		*/
+		bool saveToFile(const std::string& path) const;
+
+		/**
+		* @brief Sets the file of the mesh
+		* This is the same as loadFromFile(const std::string&) but fits the attribute interface.
+		* @param path : the path of the file
+		*/
+		void setFile(const std::string& path);
+
+		/**
+		* @brief Gets the file of the mesh
+		* @return the path of the file of the mesh or an empty string if the mesh was not loaded from a file
+		*/
+		const std::string& getFile() const;
+
+		/**
+		* @brief Computes the distance between a point and the surface of the mesh
+		* @param v : the point in world space
+		* @return the distance to the closest triangle or the maximum float value if the mesh is empty
+		*/
+		float computeDistance(const Vector3D& v) const;
+
+		///////////////
+		// Interface //
+		///////////////
+
+		virtual void generatePosition(Vector3D& v,bool full,float radius = 0.0f) const;
+		virtual bool contains(const Vector3D& v,float radius = 0.0f) const;
+		virtual bool intersects(const Vector3D& v0,const Vector3D& v1,float radius = 0.0f,Vector3D* normal = NULL) const;
+		virtual Vector3D computeNormal(const Vector3D& v) const;
+		virtual void containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const;
+		virtual void intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const;
+		virtual void computeBounds(Vector3D& boundsMin,Vector3D& boundsMax) const;
+
+	public :
+		spark_description(TriangleMesh, Zone)
+		(
+			spk_attribute(std::string, file, setFile, getFile);
+		);
+
+	protected :
+
+		virtual void innerUpdateTransform();
+
+	private :
+
+		static const size_t MAX_TRIANGLES_PER_LEAF = 4;
+		static const size_t MAX_STACK_SIZE = 64;
+		static const size_t MAX_GENERATION_TRIES = 32;
+
+		// A node of the hierarchy
+		// Leaves reference count triangles from first
+		// Internal nodes have count set to 0 and their children stored at first and first + 1
+		// Bounds are relative to the transformed position of the zone
+		struct Node
+		{
+			Vector3D boundsMin;
+			Vector3D boundsMax;
+			size_t first;
+			size_t count;
+		};
+
+		// Functor used to sort triangles by their center along an axis
+		struct CompareTriangleCenter
+		{
+			const std::vector<Vector3D>& centers;
+			const size_t axis;
+
+			CompareTriangleCenter(const std::vector<Vector3D>& centers,size_t axis) :
+				centers(centers),
+				axis(axis)
+			{}
+
+			bool operator()(size_t triangle0,size_t triangle1) const
+			{
+				return centers[triangle0][axis] < centers[triangle1][axis];
+			}
+		};
+
+		std::string file;
+
+		std::vector<Vector3D> vertices;
+		std::vector<unsigned int> indices;
+		std::vector<Node> nodes;
+
+		// Vertices transformed relatively to the transformed position and cumulated areas of the triangles
+		std::vector<Vector3D> tVertices;
+		std::vector<float> cumulatedAreas;
+
+		TriangleMesh(const Vector3D& position = Vector3D());
+		TriangleMesh(const TriangleMesh& mesh);
+
+		void buildHierarchy();
+		void buildNode(size_t nodeIndex,size_t begin,size_t end,const std::vector<Vector3D>& centers,std::vector<size_t>& order);
+		void refitHierarchy();
+
+		bool intersectsSegment(const Vector3D& d0,const Vector3D& d1,float radius,Vector3D* normal) const;
+		bool isInside(const Vector3D& d) const;
+		bool findClosestPoint(const Vector3D& d,float maxSqrDist,Vector3D& closestPoint,size_t& triangle) const;
+		Vector3D getTriangleNormal(size_t triangle) const;
+
+		static bool intersectsTriangle(const Vector3D& origin,const Vector3D& direction,const Vector3D& a,const Vector3D& b,const Vector3D& c,float& ratio);
+		static Vector3D computeClosestPoint(const Vector3D& p,const Vector3D& a,const Vector3D& b,const Vector3D& c);
+		static float getSqrDistToBox(const Vector3D& p,const Vector3D& boxMin,const Vector3D& boxMax);
+	};
+
+	inline Ref<TriangleMesh> TriangleMesh::create(const Vector3D& position)
+	{
+		return SPK_NEW(TriangleMesh,position);
+	}
+
+	inline size_t TriangleMesh::getNbVertices() const
+	{
+		return vertices.size();
+	}
+
+	inline size_t TriangleMesh::getNbTriangles() const
+	{
+		return indices.size() / 3;
+	}
+
+	inline const Vector3D& TriangleMesh::getVertex(size_t index) const
+	{
+		return vertices[index];
+	}
+
+	inline const unsigned int* TriangleMesh::getIndices() const
+	{
+		return indices.empty() ? NULL : &indices[0];
+	}
+
+	inline void TriangleMesh::setFile(const std::string& path)
+	{
+		loadFromFile(path);
+	}
+
+	inline const std::string& TriangleMesh::getFile() const
+	{
+		return file;
+	}
+}
+
+#endif
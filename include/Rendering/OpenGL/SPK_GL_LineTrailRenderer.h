@@ -22,6 +22,8 @@
 #ifndef H_SPK_GL_LINETRAILRENDERER
 #define H_SPK_GL_LINETRAILRENDERER
 
+#include <vector>
+
 #include "Rendering/OpenGL/SPK_GL_Renderer.h"
 
 namespace SPK
@@ -44,6 +46,9 @@ namespace GL
 	* The user has the possibility to set the RGBA values of degenerated lines to keep them invisible function of the blending mode and environment.<br>
 	* By default it is set to (0.0f,0.0f,0.0f,0.0f).
 	* <br>
+	* The samples of each trail are stored in a ring buffer so that adding a sample does not move the others.
+	* The lines sent to OpenGL are built from the rings at render time (see fillBuffers(const Group&,const DataSet*,Vector3D*,Color*)).<br>
+	* <br>
 	* Below are the parameters of Particle that are used in this Renderer (others have no effects) :
 	* <ul>
 	* <li>SPK::PARAM_RED</li>
@@ -133,6 +138,20 @@ namespace GL
 
 		virtual void enableBlending(bool blendingEnabled);
 
+		/**
+		* @brief Fills vertex and color arrays with the trails of a group
+		*
+		* This builds the line strip sent to OpenGL at render time. It does not need any OpenGL context.<br>
+		* Each particle is given nbSamples + 2 vertices : a degenerated vertex, the samples from the newest to the oldest and another degenerated vertex.
+		* The alpha of each sample decreases with its age.
+		*
+		* @param group : the group whose trails are built
+		* @param dataSet : the data set of this renderer for the group
+		* @param vertices : the array where to store the vertices, holding at least nbSamples + 2 vertices per particle
+		* @param colors : the array where to store the colors, holding at least nbSamples + 2 colors per particle
+		*/
+		void fillBuffers(const Group& group,const DataSet* dataSet,Vector3D* vertices,Color* colors) const;
+
 	public :
 		spark_description(GLLineTrailRenderer, GLRenderer)
 		(
@@ -147,10 +166,10 @@ namespace GL
 
 		// Data indices
 		static const size_t NB_DATA = 4;
-		static const size_t VERTEX_BUFFER_INDEX = 0;
-		static const size_t COLOR_BUFFER_INDEX = 1;
+		static const size_t POSITION_DATA_INDEX = 0;
+		static const size_t COLOR_DATA_INDEX = 1;
 		static const size_t AGE_DATA_INDEX = 2;
-		static const size_t START_ALPHA_DATA_INDEX = 3;
+		static const size_t HEAD_DATA_INDEX = 3; // Index of the newest sample in the ring of each particle
 
 		size_t nbSamples;
 
@@ -159,6 +178,10 @@ namespace GL
 
 		Color degeneratedColor;
 
+		// Buffers sent to OpenGL, filled at render time
+		mutable std::vector<Vector3D> vertexBuffer;
+		mutable std::vector<Color> colorBuffer;
+
 		/////////////////
 		// Constructor //
 		/////////////////
@@ -39,6 +39,8 @@
 #include "Extensions/Zones/SPK_Ring.h"
 #include "Extensions/Zones/SPK_Box.h"
 #include "Extensions/Zones/SPK_Cylinder.h"
+#include "Extensions/Zones/SPK_TriangleMesh.h"
+#include "Extensions/Zones/SPK_DistanceField.h"
 
 // Emitters
 #include "Extensions/Emitters/SPK_StaticEmitter.h"
@@ -58,6 +60,16 @@
 #include "Extensions/Modifiers/SPK_PointMass.h"
 #include "Extensions/Modifiers/SPK_RandomForce.h"
 #include "Extensions/Modifiers/SPK_LinearForce.h"
+#include "Extensions/Modifiers/SPK_MutualGravity.h"
+#include "Extensions/Modifiers/SPK_ForceField.h"
+#include "Extensions/Modifiers/SPK_VectorField.h"
+#include "Extensions/Modifiers/SPK_Turbulence.h"
+#include "Extensions/Modifiers/SPK_ObstacleSet.h"
+#include "Extensions/Modifiers/SPK_GroupCollider.h"
+#include "Extensions/Modifiers/SPK_Fluid.h"
+#include "Extensions/Modifiers/SPK_Flock.h"
+#include "Extensions/Modifiers/SPK_Heightfield.h"
+#include "Extensions/Modifiers/SPK_SurfaceAttractor.h"
 
 // Actions
 #include "Extensions/Actions/SPK_ActionSet.h"
@@ -62,6 +62,8 @@
 #include "Core/SPK_Particle.h"
 #include "Core/SPK_Iterator.h"
 #include "Core/SPK_Octree.h"
+#include "Core/SPK_UniformGrid.h"
+#include "Core/SPK_FieldGrid.h"
 #include "Core/SPK_Factory.h"
 #include "Core/IO/SPK_IO_Loader.h"
 #include "Core/IO/SPK_IO_Saver.h"
@@ -63,6 +63,8 @@ namespace SPK
 		registerType<Ring>();
 		registerType<Box>();
 		registerType<Cylinder>();
+		registerType<TriangleMesh>();
+		registerType<DistanceField>();
 
 		// Emitters
 		registerType<StaticEmitter>();
@@ -83,6 +85,16 @@ namespace SPK
 		registerType<PointMass>();
 		registerType<RandomForce>();
 		registerType<LinearForce>();
+		registerType<MutualGravity>();
+		registerType<ForceField>();
+		registerType<VectorField>();
+		registerType<Turbulence>();
+		registerType<ObstacleSet>();
+		registerType<GroupCollider>();
+		registerType<Fluid>();
+		registerType<Flock>();
+		registerType<Heightfield>();
+		registerType<SurfaceAttractor>();
 
 		// Actions
 		registerType<ActionSet>();
@@ -0,0 +1,206 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+
+#include <SPARK_Core.h>
+
+namespace SPK
+{
+	FieldGrid::FieldGrid(size_t nbAxes,size_t nbComponents,size_t minNodes) :
+		nbAxes(nbAxes),
+		nbComponents(nbComponents),
+		minNodes(minNodes),
+		data(NULL)
+	{
+		SPK_ASSERT(nbAxes == 2 || nbAxes == 3,"FieldGrid::FieldGrid(size_t,size_t,size_t) - The number of axes must be 2 or 3");
+		for (size_t i = 0; i < 3; ++i)
+			dimensions[i] = 0;
+	}
+
+	FieldGrid::FieldGrid(const FieldGrid& grid) :
+		nbAxes(grid.nbAxes),
+		nbComponents(grid.nbComponents),
+		minNodes(grid.minNodes),
+		ownData(grid.ownData),
+		data(grid.data),
+		file(grid.file)
+	{
+		for (size_t i = 0; i < 3; ++i)
+			dimensions[i] = grid.dimensions[i];
+		if (!ownData.empty()) // An external grid is shared but an owned grid is copied
+			data = &ownData[0];
+	}
+
+	FieldGrid& FieldGrid::operator=(const FieldGrid& grid)
+	{
+		if (&grid != this)
+		{
+			nbAxes = grid.nbAxes;
+			nbComponents = grid.nbComponents;
+			minNodes = grid.minNodes;
+			for (size_t i = 0; i < 3; ++i)
+				dimensions[i] = grid.dimensions[i];
+			ownData = grid.ownData;
+			data = ownData.empty() ? grid.data : &ownData[0];
+			file = grid.file;
+		}
+
+		return *this;
+	}
+
+	bool FieldGrid::isValid(const size_t* dimensions,const float* data) const
+	{
+		if (data == NULL)
+			return false;
+
+		for (size_t i = 0; i < nbAxes; ++i)
+			if (dimensions[i] < minNodes || dimensions[i] == 0)
+				return false;
+
+		return true;
+	}
+
+	bool FieldGrid::setData(const size_t* dimensions,const float* data)
+	{
+		if (!isValid(dimensions,data))
+			return false;
+
+		ownData.assign(data,data + getNbFloats(dimensions));
+		return setExternalData(dimensions,&ownData[0]);
+	}
+
+	bool FieldGrid::swapData(const size_t* dimensions,std::vector<float>& data)
+	{
+		if (data.empty() || data.size() < getNbFloats(dimensions) || !isValid(dimensions,&data[0]))
+			return false;
+
+		ownData.swap(data);
+		return setExternalData(dimensions,&ownData[0]);
+	}
+
+	bool FieldGrid::setExternalData(const size_t* dimensions,const float* data)
+	{
+		if (!isValid(dimensions,data))
+			return false;
+
+		if (ownData.empty() || data != &ownData[0])
+			ownData.clear();
+
+		for (size_t i = 0; i < nbAxes; ++i)
+			this->dimensions[i] = dimensions[i];
+		this->data = data;
+		file.clear();
+		return true;
+	}
+
+	bool FieldGrid::loadFromFile(const std::string& path)
+	{
+		std::ifstream stream(path.c_str(),std::ios::in | std::ios::binary);
+		if (!stream)
+		{
+			SPK_LOG_ERROR("FieldGrid::loadFromFile(const std::string&) - Unable to open the file " << path);
+			return false;
+		}
+
+		unsigned int fileDimensions[3];
+		stream.read(reinterpret_cast<char*>(fileDimensions),nbAxes * sizeof(unsigned int));
+
+		size_t gridDimensions[3] = {0,0,0};
+		for (size_t i = 0; i < nbAxes; ++i)
+			gridDimensions[i] = fileDimensions[i];
+
+		std::vector<float> fileData;
+		if (stream)
+			fileData.resize(getNbFloats(gridDimensions));
+		if (!stream || fileData.empty() || !isValid(gridDimensions,&fileData[0]))
+		{
+			SPK_LOG_ERROR("FieldGrid::loadFromFile(const std::string&) - Invalid header in the file " << path);
+			return false;
+		}
+
+		stream.read(reinterpret_cast<char*>(&fileData[0]),fileData.size() * sizeof(float));
+		if (!stream)
+		{
+			SPK_LOG_ERROR("FieldGrid::loadFromFile(const std::string&) - The file " << path << " is too short for a grid of " << fileData.size() / nbComponents << " nodes");
+			return false;
+		}
+
+		swapData(gridDimensions,fileData);
+		file = path;
+		return true;
+	}
+
+	bool FieldGrid::saveToFile(const std::string& path) const
+	{
+		if (data == NULL)
+		{
+			SPK_LOG_ERROR("FieldGrid::saveToFile(const std::string&) - The grid is empty and cannot be saved");
+			return false;
+		}
+
+		std::ofstream stream(path.c_str(),std::ios::out | std::ios::binary);
+		if (!stream)
+		{
+			SPK_LOG_ERROR("FieldGrid::saveToFile(const std::string&) - Unable to open the file " << path);
+			return false;
+		}
+
+		unsigned int fileDimensions[3];
+		for (size_t i = 0; i < nbAxes; ++i)
+			fileDimensions[i] = static_cast<unsigned int>(dimensions[i]);
+		stream.write(reinterpret_cast<const char*>(fileDimensions),nbAxes * sizeof(unsigned int));
+		stream.write(reinterpret_cast<const char*>(data),getNbFloats(dimensions) * sizeof(float));
+
+		if (!stream)
+		{
+			SPK_LOG_ERROR("FieldGrid::saveToFile(const std::string&) - Unable to write the file " << path);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool FieldGrid::computeBoxRows(const Vector3D* edges,Vector3D* rows)
+	{
+		// Inverts the matrix whose columns are the edges
+		float det = dotProduct(edges[0],crossProduct(edges[1],edges[2]));
+		if (det == 0.0f)
+		{
+			for (size_t i = 0; i < 3; ++i)
+				rows[i].set(0.0f,0.0f,0.0f);
+			return false;
+		}
+
+		rows[0] = crossProduct(edges[1],edges[2]) / det;
+		rows[1] = crossProduct(edges[2],edges[0]) / det;
+		rows[2] = crossProduct(edges[0],edges[1]) / det;
+		return true;
+	}
+
+	size_t FieldGrid::getNbFloats(const size_t* dimensions) const
+	{
+		size_t nb = nbComponents;
+		for (size_t i = 0; i < nbAxes; ++i)
+			nb *= dimensions[i];
+		return nb;
+	}
+}
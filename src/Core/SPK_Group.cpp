@@ -19,7 +19,8 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
-#include <algorithm> // for std::swap and std::sort
+#include <algorithm> // for std::swap, std::sort, std::unique, std::partial_sort and std::max
+#include <cmath> // for std::abs
 #include <limits> // for max float value
 
 #include <SPARK_Core.h>
@@ -52,7 +53,16 @@ namespace SPK
 		nbBufferedParticles(0),
 		birthAction(),
 		deathAction(),
-		octree(NULL)
+		octree(NULL),
+		octreeMaxLevel(Octree::DEFAULT_MAX_LEVEL_INDEX),
+		octreeMaxParticlesPerCell(Octree::DEFAULT_MAX_PARTICLES_NB_PER_CELL),
+		octreeRefitEnabled(false),
+		octreeLinearBuildEnabled(false),
+		modifiersNeedOctree(false),
+		spatialIndexUsed(false),
+		octreeUpToDate(false),
+		spatialReorderingPeriod(0),
+		nbUpdatesSinceReordering(0)
 	{
 		reallocate(capacity);
 	}
@@ -72,7 +82,16 @@ namespace SPK
 		graphicalRadius(group.graphicalRadius),
 		physicalRadius(group.physicalRadius),
 		nbBufferedParticles(0),
-		octree(NULL)
+		octree(NULL),
+		octreeMaxLevel(group.octreeMaxLevel),
+		octreeMaxParticlesPerCell(group.octreeMaxParticlesPerCell),
+		octreeRefitEnabled(group.octreeRefitEnabled),
+		octreeLinearBuildEnabled(group.octreeLinearBuildEnabled),
+		modifiersNeedOctree(false),
+		spatialIndexUsed(false),
+		octreeUpToDate(false),
+		spatialReorderingPeriod(group.spatialReorderingPeriod),
+		nbUpdatesSinceReordering(0)
 	{
 		reallocate(group.getCapacity());
 
@@ -200,44 +219,79 @@ namespace SPK
 			interpolator.obj->interpolate(particleData.parameters[enabledParamIndices[i]],*this,interpolator.dataSet);
 		}
 
-		// Updates the octree if one
-		if (octree != NULL)
+		// Reorders the particles in memory along a space filling curve
+		if (spatialReorderingPeriod != 0 && !sortingEnabled && ++nbUpdatesSinceReordering >= spatialReorderingPeriod)
+		{
+			reorderParticles();
+			nbUpdatesSinceReordering = 0;
+		}
+
+		// Updates the octree if a modifier needs it
+		// If it is only used by spatial queries, it is updated at the next query
+		octreeUpToDate = false;
+		if (octree != NULL && modifiersNeedOctree)
+		{
 			octree->update();
+			octreeUpToDate = true;
+		}
 
 		// Modifies the particles with specific active modifiers behavior
-		for (std::vector<WeakModifierDef>::const_iterator it = activeModifiers.begin(); it != activeModifiers.end(); ++it)
-			it->obj->modify(*this,it->dataSet,deltaTime);
+		for (size_t i = 0; i < activeModifiers.size(); i = fusedModifierEnds[i])
+		{
+			if (fusedModifierEnds[i] - i > 1)
+				applyFusedForces(i,fusedModifierEnds[i],deltaTime); // Several modifiers are fused in a single pass
+			else
+				activeModifiers[i].obj->modify(*this,activeModifiers[i].dataSet,deltaTime);
+		}
+
+		// From now on, particles are moved, killed or born
+		octreeUpToDate = false;
 
 		// Updates the renderer data
 		if (renderer.obj)
 			renderer.obj->update(*this,renderer.dataSet);
 
-		// Checks dead particles and reinits or swaps
+		// Gathers the dead particles in the death list
+		deadIndices.clear();
 		for (size_t i = 0; i < particleData.nbParticles; ++i)
 			if (particleData.energies[i] <= 0.0f)
-			{
-				// Death action
-				if (deathAction && deathAction->isActive())
+				deadIndices.push_back(i);
+
+		if (!deadIndices.empty())
+		{
+			// Death actions are applied to all dead particles in a single batch
+			if (deathAction && deathAction->isActive())
+				for (std::vector<size_t>::const_iterator it = deadIndices.begin(); it != deadIndices.end(); ++it)
 				{
-				    Particle particle = getParticle(i); // fix for gcc
+					Particle particle = getParticle(*it); // fix for gcc
 					deathAction->apply(particle);
 				}
 
-				bool replaceDeadParticle = false;
-				while (!replaceDeadParticle && nbBorn > 0)
-				{
-					if (initParticle(i,emitterIndex,nbManualBorn))
-						replaceDeadParticle = true;
-					--nbBorn;
-				}
+			// Dead particles are first replaced by the particles to be born
+			size_t nbReplaced = 0;
+			while (nbReplaced < deadIndices.size() && nbBorn > 0)
+			{
+				if (initParticle(deadIndices[nbReplaced],emitterIndex,nbManualBorn))
+					++nbReplaced;
+				--nbBorn;
+			}
 
-				if (!replaceDeadParticle)
-				{
-					swapParticles(i,particleData.nbParticles - 1);
-					--particleData.nbParticles;
-					--i; // As we need to test the swapped particle
-				}
+			// Then the group is compacted by moving the last alive particles into the remaining holes
+			// Each hole costs at most one swap and dead particles at the end cost none
+			size_t nbParticles = particleData.nbParticles;
+			for (size_t i = nbReplaced; i < deadIndices.size(); ++i)
+			{
+				while (nbParticles > 0 && particleData.energies[nbParticles - 1] <= 0.0f)
+					--nbParticles;
+
+				if (deadIndices[i] >= nbParticles) // The remaining holes are all at the end
+					break;
+
+				swapParticles(deadIndices[i],nbParticles - 1);
+				--nbParticles;
 			}
+			particleData.nbParticles = nbParticles;
+		}
 
 		// Emits new particles if some left
 		while (nbBorn > 0 && particleData.maxParticles - particleData.nbParticles > 0)
@@ -247,6 +301,9 @@ namespace SPK
 			--nbBorn;
 		}
 
+		// Spawns the particles requested since the last update
+		executeSpawnRequests();
+
 		// Computes the distance of particles from the camera
 		if (distanceComputationEnabled)
 		{
@@ -463,21 +520,7 @@ namespace SPK
 	bool Group::initParticle(size_t index,size_t& emitterIndex,size_t& nbManualBorn)
 	{
 		Particle particle(getParticle(index));
-
-		particleData.ages[index] = 0.0f;
-		particleData.energies[index] = 1.0f;
-		particleData.lifeTimes[index] = SPK_RANDOM(minLifeTime,maxLifeTime);
-
-		if (colorInterpolator.obj)
-			colorInterpolator.obj->init(particleData.colors[index],particle,colorInterpolator.dataSet);
-		else
-			particleData.colors[index] = 0xFFFFFFFF;
-
-		for (size_t i = 0; i < nbEnabledParameters; ++i)
-		{
-			FloatInterpolatorDef& interpolator = paramInterpolators[enabledParamIndices[i]];
-			interpolator.obj->init(particleData.parameters[enabledParamIndices[i]][index],particle,interpolator.dataSet);
-		}
+		initParticleParameters(index);
 
 		if (nbManualBorn == 0)
 		{
@@ -509,6 +552,33 @@ namespace SPK
 				creationBuffer.pop_front();
 		}
 
+		return finalizeParticle(index);
+	}
+
+	void Group::initParticleParameters(size_t index)
+	{
+		Particle particle(getParticle(index));
+
+		particleData.ages[index] = 0.0f;
+		particleData.energies[index] = 1.0f;
+		particleData.lifeTimes[index] = SPK_RANDOM(minLifeTime,maxLifeTime);
+
+		if (colorInterpolator.obj)
+			colorInterpolator.obj->init(particleData.colors[index],particle,colorInterpolator.dataSet);
+		else
+			particleData.colors[index] = 0xFFFFFFFF;
+
+		for (size_t i = 0; i < nbEnabledParameters; ++i)
+		{
+			FloatInterpolatorDef& interpolator = paramInterpolators[enabledParamIndices[i]];
+			interpolator.obj->init(particleData.parameters[enabledParamIndices[i]][index],particle,interpolator.dataSet);
+		}
+	}
+
+	bool Group::finalizeParticle(size_t index)
+	{
+		Particle particle(getParticle(index));
+
 		particleData.oldPositions[index] = particleData.positions[index];
 
 		for (std::vector<WeakModifierDef>::iterator it = initModifiers.begin(); it != initModifiers.end(); ++it)
@@ -595,7 +665,10 @@ namespace SPK
 	void Group::manageOctreeInstance(bool needsOctree)
 	{
 		if (needsOctree && octree == NULL) // creates an octree if needed
+		{
 			octree = SPK_NEW(Octree,this);
+			octreeUpToDate = false;
+		}
 		else if (!needsOctree && octree != NULL) // deletes the octree if no more needed
 		{
 			SPK_DELETE(octree);
@@ -607,12 +680,173 @@ namespace SPK
 	{
 		bool needsOctree = false;
 		for (std::vector<WeakModifierDef>::const_iterator it = sortedModifiers.begin(); it != sortedModifiers.end(); ++it)
-			needsOctree |= it->obj->NEEDS_OCTREE;
-		manageOctreeInstance(needsOctree);
+			needsOctree |= it->obj->needsOctree();
+		manageOctreeInstance(needsOctree || spatialIndexUsed);
 
 		return octree;
 	}
 
+	const Octree& Group::getSpatialIndex()
+	{
+		spatialIndexUsed = true;
+		manageOctreeInstance(true);
+
+		if (!octreeUpToDate)
+		{
+			octree->update();
+			octreeUpToDate = true;
+		}
+
+		return *octree;
+	}
+
+	void Group::gatherParticlesInCells(std::vector<size_t>& indices) const
+	{
+		indices.clear();
+		for (std::vector<size_t>::const_iterator it = queryCells.begin(); it != queryCells.end(); ++it)
+		{
+			const Octree::Cell& cell = octree->getCell(*it);
+			for (size_t i = 0; i < cell.particles.size(); ++i)
+				indices.push_back(cell.particles[i]);
+		}
+
+		// A particle can lie in several cells
+		std::sort(indices.begin(),indices.end());
+		indices.erase(std::unique(indices.begin(),indices.end()),indices.end());
+	}
+
+	size_t Group::findParticlesInSphere(const Vector3D& center,float radius,std::vector<size_t>& indices)
+	{
+		indices.clear();
+		if (particleData.nbParticles == 0)
+			return 0;
+
+		getSpatialIndex().findCells(center - radius,center + radius,queryCells);
+		gatherParticlesInCells(indices);
+
+		const float sqrRadius = radius * radius;
+		size_t nbFound = 0;
+		for (size_t i = 0; i < indices.size(); ++i)
+			if (getSqrDist(particleData.positions[indices[i]],center) <= sqrRadius)
+				indices[nbFound++] = indices[i];
+		indices.resize(nbFound);
+
+		return nbFound;
+	}
+
+	size_t Group::findParticlesInAABB(const Vector3D& boxMin,const Vector3D& boxMax,std::vector<size_t>& indices)
+	{
+		indices.clear();
+		if (particleData.nbParticles == 0)
+			return 0;
+
+		getSpatialIndex().findCells(boxMin,boxMax,queryCells);
+		gatherParticlesInCells(indices);
+
+		size_t nbFound = 0;
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			const Vector3D& position = particleData.positions[indices[i]];
+			if (position.x >= boxMin.x && position.y >= boxMin.y && position.z >= boxMin.z
+				&& position.x <= boxMax.x && position.y <= boxMax.y && position.z <= boxMax.z)
+				indices[nbFound++] = indices[i];
+		}
+		indices.resize(nbFound);
+
+		return nbFound;
+	}
+
+	size_t Group::findNearestParticles(const Vector3D& point,size_t k,std::vector<size_t>& indices)
+	{
+		indices.clear();
+		if (particleData.nbParticles == 0 || k == 0)
+			return 0;
+
+		if (k > particleData.nbParticles)
+			k = particleData.nbParticles;
+
+		const Octree& spatialIndex = getSpatialIndex();
+
+		// The search radius at which all particles are found is the distance to the farthest corner of the octree
+		Vector3D farthest;
+		for (size_t i = 0; i < 3; ++i)
+			farthest[i] = std::max(std::abs(point[i] - spatialIndex.getAABBMin()[i]),std::abs(point[i] - spatialIndex.getAABBMax()[i]));
+		const float maxRadius = farthest.getNorm();
+
+		// The radius grows until enough particles are found
+		// As all particles within the radius are found, the k nearest of them are the k nearest of the group
+		float radius = (spatialIndex.getAABBMax() - spatialIndex.getAABBMin()).getMax() / static_cast<float>(1 << octreeMaxLevel);
+		if (radius <= 0.0f)
+			radius = maxRadius;
+		while (findParticlesInSphere(point,radius,indices) < k && radius < maxRadius)
+			radius *= 2.0f;
+
+		queryDistances.clear();
+		for (size_t i = 0; i < indices.size(); ++i)
+			queryDistances.push_back(std::make_pair(getSqrDist(particleData.positions[indices[i]],point),indices[i]));
+		std::partial_sort(queryDistances.begin(),queryDistances.begin() + k,queryDistances.end());
+
+		indices.resize(k);
+		for (size_t i = 0; i < k; ++i)
+			indices[i] = queryDistances[i].second;
+
+		return k;
+	}
+
+	size_t Group::findParticlesOnRay(const Vector3D& origin,const Vector3D& direction,float length,std::vector<size_t>& indices)
+	{
+		indices.clear();
+		Vector3D normalizedDirection(direction);
+		if (particleData.nbParticles == 0 || length < 0.0f || !normalizedDirection.normalize())
+			return 0;
+
+		getSpatialIndex().findCellsOnRay(origin,normalizedDirection,length,queryCells);
+		gatherParticlesInCells(indices);
+
+		// Keeps the particles whose sphere is crossed by the ray and sorts them along the ray
+		queryDistances.clear();
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			const Vector3D& position = particleData.positions[indices[i]];
+			float t = dotProduct(position - origin,normalizedDirection);
+			if (t < 0.0f) t = 0.0f;
+			if (t > length) t = length;
+
+			const float radius = getParticle(indices[i]).getRadius();
+			if (getSqrDist(origin + normalizedDirection * t,position) <= radius * radius)
+				queryDistances.push_back(std::make_pair(t,indices[i]));
+		}
+		std::sort(queryDistances.begin(),queryDistances.end());
+
+		indices.resize(queryDistances.size());
+		for (size_t i = 0; i < queryDistances.size(); ++i)
+			indices[i] = queryDistances[i].second;
+
+		return indices.size();
+	}
+
+	void Group::setOctreeMaxLevel(unsigned int maxLevel)
+	{
+		if (maxLevel > Octree::MAX_LEVEL_LIMIT)
+		{
+			SPK_LOG_WARNING("Group::setOctreeMaxLevel(unsigned int) - The maximum level cannot exceed " << Octree::MAX_LEVEL_LIMIT << ", it is clamped");
+			maxLevel = Octree::MAX_LEVEL_LIMIT;
+		}
+
+		octreeMaxLevel = maxLevel;
+	}
+
+	void Group::setOctreeMaxParticlesPerCell(unsigned int maxParticlesPerCell)
+	{
+		if (maxParticlesPerCell == 0)
+		{
+			SPK_LOG_WARNING("Group::setOctreeMaxParticlesPerCell(unsigned int) - The maximum number of particles per cell must be at least 1, 1 is set");
+			maxParticlesPerCell = 1;
+		}
+
+		octreeMaxParticlesPerCell = maxParticlesPerCell;
+	}
+
 	void Group::sortParticles()
 	{
 		if (sortingEnabled)
@@ -662,6 +896,79 @@ namespace SPK
 		}
 	}
 
+	void Group::reorderParticles()
+	{
+		const size_t nbParticles = particleData.nbParticles;
+		if (nbParticles < 2)
+			return;
+
+		const float MAX_FLOAT = std::numeric_limits<float>::max();
+		Vector3D particlesMin(MAX_FLOAT,MAX_FLOAT,MAX_FLOAT);
+		Vector3D particlesMax(-MAX_FLOAT,-MAX_FLOAT,-MAX_FLOAT);
+		for (size_t i = 0; i < nbParticles; ++i)
+		{
+			particlesMin.setMin(particleData.positions[i]);
+			particlesMax.setMax(particleData.positions[i]);
+		}
+
+		const unsigned int maxCoord = (1 << REORDERING_BITS) - 1;
+		Vector3D ratio;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			const float extent = particlesMax[i] - particlesMin[i];
+			ratio[i] = extent > 0.0f ? maxCoord / extent : 0.0f;
+		}
+
+		// Computes the Morton code of each particle
+		reorderingKeys.resize(nbParticles);
+		for (size_t i = 0; i < nbParticles; ++i)
+		{
+			const Vector3D position = (particleData.positions[i] - particlesMin) * ratio;
+			unsigned int code = 0;
+			for (size_t j = 0; j < 3; ++j)
+			{
+				unsigned int bits = static_cast<unsigned int>(position[j]);
+				if (bits > maxCoord) bits = maxCoord;
+
+				bits = (bits | (bits << 16)) & 0x030000FF;
+				bits = (bits | (bits << 8)) & 0x0300F00F;
+				bits = (bits | (bits << 4)) & 0x030C30C3;
+				bits = (bits | (bits << 2)) & 0x09249249;
+				code |= bits << (2 - j);
+			}
+
+			reorderingKeys[i].first = code;
+			reorderingKeys[i].second = i;
+		}
+
+		std::sort(reorderingKeys.begin(),reorderingKeys.end());
+
+		// reorderingIndices[i] is the index of the particle that must move to index i
+		reorderingIndices.resize(nbParticles);
+		for (size_t i = 0; i < nbParticles; ++i)
+			reorderingIndices[i] = reorderingKeys[i].second;
+
+		// Applies the permutation cycle by cycle so that every particle is moved once
+		// Swapping the particles moves the core data as well as the data of the datasets
+		for (size_t i = 0; i < nbParticles; ++i)
+		{
+			size_t current = i;
+			while (true)
+			{
+				const size_t next = reorderingIndices[current];
+				reorderingIndices[current] = current;
+				if (next == i)
+					break;
+				swapParticles(current,next);
+				current = next;
+			}
+		}
+
+		// The octree tracks particles by index so it cannot be refitted
+		if (octree != NULL)
+			octree->invalidate();
+	}
+
 	void Group::propagateUpdateTransform()
 	{
 		for (std::vector<Ref<Emitter> >::const_iterator it = emitters.begin(); it != emitters.end(); ++it)
@@ -771,7 +1078,7 @@ namespace SPK
 
 	void Group::flushBufferedParticles()
 	{
-		if (nbBufferedParticles == 0)
+		if (nbBufferedParticles == 0 && spawnRequests.empty())
 			return;
 
 		prepareAdditionnalData();
@@ -783,13 +1090,106 @@ namespace SPK
 			if (!initParticle(particleData.nbParticles++,dummy,nbManualBorn))
 				--particleData.nbParticles;
 
+		executeSpawnRequests();
+
 		emptyBufferedParticles();
+		octreeUpToDate = false;
+	}
+
+	size_t Group::emitParticles(const Ref<Emitter>& emitter,size_t nb,const Vector3D* positions)
+	{
+		if (!emitter)
+		{
+			SPK_LOG_ERROR("Group::emitParticles(const Ref<Emitter>&,size_t,const Vector3D*) - The emitter is NULL. No particle is emitted");
+			return 0;
+		}
+
+		if (nb == 0)
+			return 0;
+
+		prepareAdditionnalData();
+
+		size_t nbEmitted = 0;
+		for (size_t i = 0; i < nb; ++i)
+			nbEmitted += emitParticlesAt(*emitter,positions[i],1);
+
+		octreeUpToDate = false;
+		return nbEmitted;
+	}
+
+	void Group::spawnParticles(unsigned int nb,const Vector3D& position,const Ref<Emitter>& emitter)
+	{
+		if (nb == 0)
+			return;
+
+		if (!emitter)
+		{
+			SPK_LOG_ERROR("Group::spawnParticles(unsigned int,const Vector3D&,const Ref<Emitter>&) - The emitter is NULL. No particle is spawned");
+			return;
+		}
+
+		SpawnRequest request = {nb,position,emitter};
+		spawnRequests.push_back(request);
+	}
+
+	size_t Group::emitParticlesAt(Emitter& emitter,const Vector3D& position,size_t nb)
+	{
+		nb = emitter.updateTankFromNb(nb);
+
+		// The zone of the emitter is used relatively to the position, the transform of the emitter is not changed
+		const Vector3D offset(position - emitter.getZone()->getTransformedPosition());
+
+		size_t nbEmitted = 0;
+		for (size_t i = 0; i < nb && particleData.nbParticles < particleData.maxParticles; ++i)
+		{
+			const size_t index = particleData.nbParticles++;
+			Particle particle(getParticle(index));
+			initParticleParameters(index);
+
+			emitter.emit(particle);
+			particle.position() += offset;
+
+			if (finalizeParticle(index))
+				++nbEmitted;
+			else
+				--particleData.nbParticles;
+		}
+
+		return nbEmitted;
+	}
+
+	void Group::executeSpawnRequests()
+	{
+		// Requests are read by index and copied as birth actions may queue new requests
+		for (size_t i = 0; i < spawnRequests.size(); ++i)
+		{
+			const SpawnRequest request = spawnRequests[i];
+			emitParticlesAt(*request.emitter,request.position,request.nb);
+		}
+
+		spawnRequests.clear();
+	}
+
+	void Group::killParticles(size_t begin,size_t nb,const unsigned char* mask)
+	{
+		SPK_ASSERT(begin + nb <= particleData.nbParticles,"Group::killParticles(size_t,size_t,const unsigned char*) - Particle indices are out of bounds : " << begin + nb);
+
+		float* energies = particleData.energies + begin;
+		float* ages = particleData.ages + begin;
+		const float* lifeTimes = particleData.lifeTimes + begin;
+		for (size_t i = 0; i < nb; ++i)
+			if (mask[i] != 0)
+			{
+				energies[i] = 0.0f;
+				ages[i] = lifeTimes[i];
+			}
 	}
 
 	void Group::emptyBufferedParticles()
 	{
 		creationBuffer.clear();
 		nbBufferedParticles = 0;
+		spawnRequests.clear();
 	}
 
 	inline void Group::prepareAdditionnalData()
@@ -808,10 +1208,12 @@ namespace SPK
 				initModifiers.push_back(*it); // if its init method needs to be called it is added to the init vector
 			if (it->obj->isActive())
 				activeModifiers.push_back(*it); // if the modifier is active, it is added to the active vector
-			needsOctree |= it->obj->NEEDS_OCTREE;
+			needsOctree |= it->obj->needsOctree();
 		}
 
-		manageOctreeInstance(needsOctree);
+		modifiersNeedOctree = needsOctree;
+		manageOctreeInstance(needsOctree || spatialIndexUsed);
+		computeFusedModifiers();
 
 		if (colorInterpolator.obj)
 			colorInterpolator.obj->prepareData(*this,colorInterpolator.dataSet);
@@ -823,6 +1225,94 @@ namespace SPK
 		}
 	}
 
+	void Group::computeFusedModifiers()
+	{
+		// As the modifiers are checked at each update, any addition, removal or change of a modifier is taken into account
+		fusedModifierEnds.resize(activeModifiers.size());
+
+		size_t i = 0;
+		while (i < activeModifiers.size())
+		{
+			size_t end = i + 1;
+			const Modifier* modifier = activeModifiers[i].obj;
+			if (modifier->isFusable(*this))
+				while (end < activeModifiers.size()
+					&& activeModifiers[end].obj->getPriority() == modifier->getPriority()
+					&& activeModifiers[end].obj->isFusable(*this))
+					++end;
+
+			for (; i < end; ++i)
+				fusedModifierEnds[i] = end;
+		}
+	}
+
+	void Group::applyFusedForces(size_t begin,size_t end,float deltaTime)
+	{
+		// Gets the forces and merges the consecutive affine ones
+		fusedForces.clear();
+		for (size_t i = begin; i < end; ++i)
+		{
+			FusedForce force;
+			activeModifiers[i].obj->getFusedForce(force,*this,deltaTime);
+
+			if (force.type == FusedForce::FUSED_FORCE_AFFINE && !fusedForces.empty() && fusedForces.back().type == FusedForce::FUSED_FORCE_AFFINE)
+			{
+				FusedForce& previous = fusedForces.back();
+				previous.vector = previous.vector * force.scale + force.vector;
+				previous.scale *= force.scale;
+			}
+			else
+				fusedForces.push_back(force);
+		}
+
+		Vector3D* velocities = particleData.velocities;
+		const Vector3D* positions = particleData.positions;
+		const float* masses = particleData.parameters[PARAM_MASS];
+		const size_t nbParticles = particleData.nbParticles;
+		const size_t nbForces = fusedForces.size();
+
+		// Optimization when all the forces collapse in a single affine one
+		if (nbForces == 1 && fusedForces[0].type == FusedForce::FUSED_FORCE_AFFINE)
+		{
+			const Vector3D vector = fusedForces[0].vector;
+			const float scale = fusedForces[0].scale;
+			for (size_t i = 0; i < nbParticles; ++i)
+			{
+				velocities[i].x = velocities[i].x * scale + vector.x;
+				velocities[i].y = velocities[i].y * scale + vector.y;
+				velocities[i].z = velocities[i].z * scale + vector.z;
+			}
+			return;
+		}
+
+		for (size_t i = 0; i < nbParticles; ++i)
+		{
+			Vector3D velocity = velocities[i];
+			for (size_t j = 0; j < nbForces; ++j)
+			{
+				const FusedForce& force = fusedForces[j];
+				switch (force.type)
+				{
+				case FusedForce::FUSED_FORCE_AFFINE :
+					velocity = velocity * force.scale + force.vector;
+					break;
+
+				case FusedForce::FUSED_FORCE_DAMPING :
+					velocity *= 1.0f - std::min(1.0f,force.scale / masses[i]);
+					break;
+
+				case FusedForce::FUSED_FORCE_POINT_MASS :
+					{
+						Vector3D attraction = force.vector - positions[i];
+						velocity += attraction * (force.scale / (attraction.getSqrNorm() + force.offset));
+					}
+					break;
+				}
+			}
+			velocities[i] = velocity;
+		}
+	}
+
 	void Group::initData()
 	{
 		if (isInitialized() && !particleData.initialized)
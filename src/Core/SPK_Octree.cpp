@@ -21,16 +21,19 @@
 
 #include <vector>
 #include <limits> // for max float value
+#include <algorithm> // for std::sort and std::swap
+#include <cstring> // for std::memset
 
 #include <SPARK_Core.h>
 
 namespace SPK
 {
-	// TODO Allows to tweak this
-	const size_t Octree::MAX_LEVEL_INDEX = 4; // A too high number will be highly memory comsuming
-	const size_t Octree::MAX_PARTICLES_NB_PER_CELL = 32;
 	const float Octree::OPTIMAL_CELL_SIZE_FACTOR = 4.0f; // optimal cell size is defined as : factor * mean radius
 	const float Octree::MIN_CELL_SIZE = 0.001f;
+	const float Octree::REFIT_MARGIN = 0.25f; // the bounds are enlarged by this ratio of the extent on each side when the refit is enabled
+	const float Octree::REFIT_MIN_EXTENT_RATIO = 0.5f; // the octree is rebuilt when the extent of the particles falls below this ratio of the extent at build
+	const float Octree::REFIT_MAX_CELLS_GROWTH = 2.0f; // the octree is rebuilt when the refits split cells up to this ratio of the number of cells at build
+	const float Octree::REFIT_MIN_OCCUPANCY_RATIO = 0.5f; // the octree is rebuilt when the mean number of particles per active cell falls below this ratio of the mean at build
 
 	Octree::Octree(const Ref<Group>& group) :
 		group(*group),
@@ -38,8 +41,19 @@ namespace SPK
 		nbCells(0),
 		nbParticles(0),
 		particleCells(NULL),
+		nbCellEntries(0),
 		minPos(NULL),
-		maxPos(NULL)
+		maxPos(NULL),
+		built(false),
+		maxLevelIndex(0),
+		maxParticlesPerCell(DEFAULT_MAX_PARTICLES_NB_PER_CELL),
+		maxLevel(0),
+		builtExtent(0.0f),
+		nbBuiltParticles(0),
+		nbBuiltCells(0),
+		builtOccupancy(0.0f),
+		trackModifiedCells(false),
+		splitCells(true)
 	{}
 
 	Octree::~Octree()
@@ -49,8 +63,20 @@ namespace SPK
 		SPK_DELETE_ARRAY(maxPos);
 	}
 
+	void Octree::invalidate()
+	{
+		// Particles were moved in memory so the structure cannot be refitted
+		built = false;
+	}
+
 	void Octree::update()
 	{
+		// A change of settings requires a full build
+		bool needsBuild = !built
+			|| !group.isOctreeRefitEnabled()
+			|| group.getOctreeMaxLevel() != maxLevelIndex
+			|| group.getOctreeMaxParticlesPerCell() != maxParticlesPerCell;
+
 		// Reallocates if necessary
 		if (group.getCapacity() != nbParticles)
 		{
@@ -62,41 +88,85 @@ namespace SPK
 			particleCells = SPK_NEW_ARRAY(Array<size_t>,nbParticles);
 			minPos = SPK_NEW_ARRAY(Triplet,nbParticles);
 			maxPos = SPK_NEW_ARRAY(Triplet,nbParticles);
+
+			needsBuild = true;
+		}
+
+		if (group.getNbParticles() == 0)
+		{
+			nbCells = 0;
+			initNextCell(0,0,0,0);
+			activeCells.clear();
+			built = false;
+			return;
 		}
 
 		const float MAX_FLOAT = std::numeric_limits<float>::max();
-		AABBMin.set(MAX_FLOAT,MAX_FLOAT,MAX_FLOAT);
-		AABBMax.set(-MAX_FLOAT,-MAX_FLOAT,-MAX_FLOAT);
+		Vector3D particlesMin(MAX_FLOAT,MAX_FLOAT,MAX_FLOAT);
+		Vector3D particlesMax(-MAX_FLOAT,-MAX_FLOAT,-MAX_FLOAT);
 
 		// First traversal in O(n) needed to init the octree
 		float meanRadius = 0.0f;
 		for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
 		{
 			const Particle& particle = *particleIt;
-			float radius = particle.getRadius();
-			AABBMin.setMin(particle.position());
-			AABBMax.setMax(particle.position());
-			meanRadius += radius;
-			particleCells[particle.getIndex()].clear();
+			particlesMin.setMin(particle.position());
+			particlesMax.setMax(particle.position());
+			meanRadius += particle.getRadius();
+		}
+
+		// The structure is kept while the particles remain within its bounds and do not gather in a much smaller volume
+		// As cells split by the refits are never merged, it is also rebuilt once they are too many or hold too few particles
+		if (!needsBuild)
+		{
+			const float extent = (particlesMax - particlesMin).getMax();
+			needsBuild = particlesMin.x < AABBMin.x || particlesMin.y < AABBMin.y || particlesMin.z < AABBMin.z
+				|| particlesMax.x > AABBMax.x || particlesMax.y > AABBMax.y || particlesMax.z > AABBMax.z
+				|| extent < builtExtent * REFIT_MIN_EXTENT_RATIO
+				|| nbCells > nbBuiltCells * REFIT_MAX_CELLS_GROWTH
+				|| (!activeCells.empty() && static_cast<float>(nbCellEntries) / activeCells.size() < builtOccupancy * REFIT_MIN_OCCUPANCY_RATIO);
 		}
 
+		if (needsBuild)
+			build(particlesMin,particlesMax,meanRadius / group.getNbParticles());
+		else
+			refit();
+	}
+
+	void Octree::build(const Vector3D& particlesMin,const Vector3D& particlesMax,float meanRadius)
+	{
+		maxLevelIndex = group.getOctreeMaxLevel();
+		maxParticlesPerCell = group.getOctreeMaxParticlesPerCell();
+		builtExtent = (particlesMax - particlesMin).getMax();
+
+		for (size_t i = 0; i < group.getNbParticles(); ++i)
+			particleCells[i].clear();
+		activeCells.clear();
+		nbCellEntries = 0;
+
 		// Tries to minimize the number of particles that belongs to several cell by setting minimum cell size function of the mean radius
-		meanRadius /= group.getNbParticles();
 		float minCellSize = meanRadius * OPTIMAL_CELL_SIZE_FACTOR;
 		if (minCellSize < MIN_CELL_SIZE)
 			minCellSize = MIN_CELL_SIZE;
 
 		// Initial dimensions
-		Vector3D dimensions = AABBMax - AABBMin;
-		Vector3D offset = AABBMin;
+		Vector3D dimensions = particlesMax - particlesMin;
+		offset = particlesMin;
+
+		// Leaves some room around the particles so that the structure can be kept while they move
+		if (group.isOctreeRefitEnabled())
+		{
+			offset -= dimensions * REFIT_MARGIN;
+			dimensions *= 1.0f + 2.0f * REFIT_MARGIN;
+		}
 
 		// Maximizes the possibilities of seperation
-		Vector3D cellSizes = dimensions / Vector3D(static_cast<float>(1 << MAX_LEVEL_INDEX));
+		Vector3D cellSizes = dimensions / Vector3D(static_cast<float>(1 << maxLevelIndex));
 		cellSizes.setMin(Vector3D(minCellSize));
 		Vector3D ratios = Vector3D(minCellSize) / cellSizes;
 
 		// Optimizes if possible by scaling down the octree in order to use less levels
-		size_t maxLevel = MAX_LEVEL_INDEX;
+		maxLevel = maxLevelIndex;
 		while (ratios.getMin() >= 2.0f && maxLevel > 0)
 		{
 			ratios /= 2.0f;
@@ -114,7 +184,45 @@ namespace SPK
 		initNextCell(0,0,0,0);
 
 		// Adds particles to correct cells
-		Vector3D ratio = Vector3D(static_cast<float>(1 << maxLevel)) / dimensions;
+		ratio = Vector3D(static_cast<float>(1 << maxLevel)) / dimensions;
+		if (group.isOctreeLinearBuildEnabled())
+			buildLinear();
+		else
+		{
+			for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+			{
+				const Particle& particle = *particleIt;
+				const Vector3D position = particle.position() - offset;
+				const float radius = particle.getRadius();
+
+				size_t particleIndex = particle.getIndex();
+
+				Vector3D minPosf = (position - radius) * ratio;
+				Vector3D maxPosf = (position + radius) * ratio;
+
+				minPos[particleIndex].set(minPosf);
+				maxPos[particleIndex].set(maxPosf);
+
+				addToCell(0,particleIndex,maxLevel);
+			}
+		}
+
+		nbBuiltParticles = group.getNbParticles();
+		nbBuiltCells = nbCells;
+		builtOccupancy = activeCells.empty() ? 0.0f : static_cast<float>(nbCellEntries) / activeCells.size();
+		built = true;
+	}
+
+	void Octree::buildLinear()
+	{
+		const size_t nbAliveParticles = group.getNbParticles();
+		const int maxCoord = (1 << maxLevel) - 1;
+
+		mortonCodes.resize(nbAliveParticles);
+		tmpMortonCodes.resize(nbAliveParticles);
+
+		// Computes the Morton code of the center of each particle
+		// Bits are interleaved so that each group of 3 bits is the index of a child in a cell
 		for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
 		{
 			const Particle& particle = *particleIt;
@@ -123,25 +231,209 @@ namespace SPK
 
 			size_t particleIndex = particle.getIndex();
 
-			Vector3D minPosf = (position - radius) * ratio;
-			Vector3D maxPosf = (position + radius) * ratio;
+			minPos[particleIndex].set((position - radius) * ratio);
+			maxPos[particleIndex].set((position + radius) * ratio);
 
-			minPos[particleIndex].set(minPosf);
-			maxPos[particleIndex].set(maxPosf);
+			Triplet center;
+			center.set(position * ratio);
+			unsigned int code = 0;
+			for (size_t i = 0; i < 3; ++i)
+			{
+				int coord = center.value[i];
+				if (coord < 0) coord = 0;
+				if (coord > maxCoord) coord = maxCoord;
+
+				unsigned int bits = static_cast<unsigned int>(coord);
+				bits = (bits | (bits << 16)) & 0x030000FF;
+				bits = (bits | (bits << 8)) & 0x0300F00F;
+				bits = (bits | (bits << 4)) & 0x030C30C3;
+				bits = (bits | (bits << 2)) & 0x09249249;
+				code |= bits << (2 - i);
+			}
 
-			addToCell(0,particleIndex,maxLevel);
+			mortonCodes[particleIndex] = code;
 		}
 
-		// Fills results (particle/cell relationship)
-		activeCells.clear();
-		for (size_t i = 0; i < nbCells; ++i)
-			if (!cells[i].particles.empty())
+		sortMortonCodes(3 * maxLevel);
+
+		// Derives the cells from the sorted codes
+		buildLinearCell(0,0,nbAliveParticles);
+
+		// Adds particles to the leaves their bounds overlap
+		// Particles are added by index so they are ordered within the cells
+		splitCells = false;
+		for (size_t i = 0; i < nbAliveParticles; ++i)
+			addToCell(0,i,maxLevel);
+		splitCells = true;
+	}
+
+	void Octree::buildLinearCell(size_t cellIndex,size_t begin,size_t end)
+	{
+		const size_t level = cells[cellIndex].level;
+		if (end - begin <= maxParticlesPerCell || level == maxLevel)
+			return;
+
+		const size_t offsetX = cells[cellIndex].offsetX << 1;
+		const size_t offsetY = cells[cellIndex].offsetY << 1;
+		const size_t offsetZ = cells[cellIndex].offsetZ << 1;
+		const size_t shift = 3 * (maxLevel - level - 1);
+
+		// Codes are sorted so the particles of each child are contiguous
+		size_t childBegin = begin;
+		for (size_t i = 0; i < 8; ++i)
+		{
+			size_t childEnd = childBegin;
+			while (childEnd < end && ((mortonCodes[childEnd] >> shift) & 7) == i)
+				++childEnd;
+
+			size_t childIndex = initNextCell(level + 1,offsetX + ((i >> 2) & 1),offsetY + ((i >> 1) & 1),offsetZ + (i & 1));
+			cells[cellIndex].children[i] = childIndex;
+			buildLinearCell(childIndex,childBegin,childEnd);
+
+			childBegin = childEnd;
+		}
+
+		cells[cellIndex].hasChildren = true;
+	}
+
+	void Octree::sortMortonCodes(size_t nbBits)
+	{
+		// Least significant digit radix sort
+		const size_t nbAliveParticles = mortonCodes.size();
+		const unsigned int mask = (1 << RADIX_BITS) - 1;
+		size_t counts[1 << RADIX_BITS];
+
+		for (size_t shift = 0; shift < nbBits; shift += RADIX_BITS)
+		{
+			std::memset(counts,0,sizeof(counts));
+			for (size_t i = 0; i < nbAliveParticles; ++i)
+				++counts[(mortonCodes[i] >> shift) & mask];
+
+			size_t start = 0;
+			for (size_t i = 0; i <= mask; ++i)
+			{
+				const size_t count = counts[i];
+				counts[i] = start;
+				start += count;
+			}
+
+			for (size_t i = 0; i < nbAliveParticles; ++i)
+			{
+				const size_t destination = counts[(mortonCodes[i] >> shift) & mask]++;
+				tmpMortonCodes[destination] = mortonCodes[i];
+			}
+
+			mortonCodes.swap(tmpMortonCodes);
+		}
+	}
+
+	void Octree::refit()
+	{
+		const size_t nbAliveParticles = group.getNbParticles();
+
+		// Finds the particles whose range of cells changed and removes them from their cells
+		// Particles are tracked by index so a particle replacing a dead one at the same index is handled the same way
+		movedParticles.clear();
+		for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		{
+			const Particle& particle = *particleIt;
+			const Vector3D position = particle.position() - offset;
+			const float radius = particle.getRadius();
+
+			size_t particleIndex = particle.getIndex();
+
+			Triplet newMinPos;
+			Triplet newMaxPos;
+			newMinPos.set((position - radius) * ratio);
+			newMaxPos.set((position + radius) * ratio);
+
+			if (particleIndex < nbBuiltParticles)
 			{
-				activeCells.push(i);
-				size_t nbParticlesInCells = cells[i].particles.size();
-				for (size_t j = 0; j < nbParticlesInCells; ++j)
-					particleCells[cells[i].particles[j]].push(i);
+				if (newMinPos.equals(minPos[particleIndex]) && newMaxPos.equals(maxPos[particleIndex]))
+					continue;
+				removeFromCells(particleIndex);
 			}
+			else
+				particleCells[particleIndex].clear(); // May hold the cells of a particle from before the build
+
+			minPos[particleIndex] = newMinPos;
+			maxPos[particleIndex] = newMaxPos;
+			movedParticles.push(particleIndex);
+		}
+
+		// Removes the particles that are no more alive
+		for (size_t i = nbAliveParticles; i < nbBuiltParticles; ++i)
+			removeFromCells(i);
+
+		const bool changed = !movedParticles.empty() || nbAliveParticles != nbBuiltParticles;
+		nbBuiltParticles = nbAliveParticles;
+		if (!changed)
+			return;
+
+		// Adds the moved particles back
+		// The cells of the particles and the active cells are updated as particles are added and cells are split
+		trackModifiedCells = true;
+		for (size_t i = 0; i < movedParticles.size(); ++i)
+			addToCell(0,movedParticles[i],maxLevel);
+		trackModifiedCells = false;
+
+		// Restores the order of particles by index within the cells where particles were added
+		for (size_t i = 0; i < modifiedCells.size(); ++i)
+		{
+			Cell& cell = cells[modifiedCells[i]];
+			std::sort(cell.particles.values,cell.particles.values + cell.particles.size());
+			cell.modified = false;
+		}
+		modifiedCells.clear();
+	}
+
+	void Octree::removeFromCells(size_t particleIndex)
+	{
+		Array<size_t>& neighborCells = particleCells[particleIndex];
+		for (size_t i = 0; i < neighborCells.size(); ++i)
+		{
+			// Removes the particle while keeping the order in the cell
+			Array<size_t>& particles = cells[neighborCells[i]].particles;
+			size_t j = 0;
+			while (j < particles.size() && particles[j] != particleIndex)
+				++j;
+			if (j == particles.size())
+				continue;
+			for (++j; j < particles.size(); ++j)
+				particles[j - 1] = particles[j];
+			--particles.currentNb;
+			--nbCellEntries;
+
+			if (particles.empty())
+				deactivateCell(neighborCells[i]);
+		}
+
+		neighborCells.clear();
+	}
+
+	void Octree::activateCell(size_t cellIndex)
+	{
+		Cell& cell = cells[cellIndex];
+		if (cell.activeIndex != Cell::NO_ACTIVE_INDEX)
+			return;
+
+		cell.activeIndex = activeCells.size();
+		activeCells.push(cellIndex);
+	}
+
+	void Octree::deactivateCell(size_t cellIndex)
+	{
+		Cell& cell = cells[cellIndex];
+		if (cell.activeIndex == Cell::NO_ACTIVE_INDEX)
+			return;
+
+		// Replaces the cell by the last active one
+		const size_t lastIndex = activeCells[activeCells.size() - 1];
+		activeCells[cell.activeIndex] = lastIndex;
+		cells[lastIndex].activeIndex = cell.activeIndex;
+		--activeCells.currentNb;
+
+		cell.activeIndex = Cell::NO_ACTIVE_INDEX;
 	}
 
 	size_t Octree::initNextCell(size_t level,size_t offsetX,size_t offsetY,size_t offsetZ)
@@ -156,8 +448,19 @@ namespace SPK
 	void Octree::addToCell(size_t cellIndex,size_t particleIndex,size_t maxLevel)
 	{
 		Cell& cell = cells[cellIndex];
-		if (!cell.hasChildren && (cell.particles.size() < MAX_PARTICLES_NB_PER_CELL || cell.level == maxLevel))
+		if (!cell.hasChildren && (!splitCells || cell.particles.size() < maxParticlesPerCell || cell.level == maxLevel))
+		{
 			cell.particles.push(particleIndex);
+			particleCells[particleIndex].push(cellIndex);
+			++nbCellEntries;
+			activateCell(cellIndex);
+
+			if (trackModifiedCells && !cell.modified)
+			{
+				cell.modified = true;
+				modifiedCells.push(cellIndex);
+			}
+		}
 		else
 		{
 			// Creates children if necessary
@@ -179,8 +482,22 @@ namespace SPK
 				// Redistributes particles in this cell to its newly created children
 				size_t nbParticlesInCell = cells[cellIndex].particles.size();
 				for (size_t i = 0; i < nbParticlesInCell; ++i)
-					addToChildrenCells(cellIndex,cells[cellIndex].particles[i],maxLevel);
+				{
+					const size_t index = cells[cellIndex].particles[i];
+
+					// The cell is replaced by its children in the cells of the particle
+					Array<size_t>& neighborCells = particleCells[index];
+					size_t j = 0;
+					while (neighborCells[j] != cellIndex)
+						++j;
+					neighborCells[j] = neighborCells[neighborCells.size() - 1];
+					--neighborCells.currentNb;
+					--nbCellEntries;
+
+					addToChildrenCells(cellIndex,index,maxLevel);
+				}
 				cells[cellIndex].particles.clear();
+				deactivateCell(cellIndex);
 			}
 
 			addToChildrenCells(cellIndex,particleIndex,maxLevel);
@@ -213,4 +530,100 @@ namespace SPK
 				for (int z = minIndexZ; z <= maxIndexZ; ++z)
 					addToCell(parent.children[(x << 2) | (y << 1) | z],particleIndex,maxLevel);
 	}
+
+	void Octree::getCellBounds(size_t index,Vector3D& cellMin,Vector3D& cellMax) const
+	{
+		const Cell& cell = cells[index];
+		const Vector3D cellSize = (AABBMax - AABBMin) / static_cast<float>(1 << cell.level);
+		cellMin = AABBMin + cellSize * Vector3D(static_cast<float>(cell.offsetX),static_cast<float>(cell.offsetY),static_cast<float>(cell.offsetZ));
+		cellMax = cellMin + cellSize;
+	}
+
+	void Octree::findCells(const Vector3D& boxMin,const Vector3D& boxMax,std::vector<size_t>& cellIndices) const
+	{
+		cellIndices.clear();
+		if (nbCells == 0)
+			return;
+
+		size_t stack[QUERY_STACK_SIZE];
+		size_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		Vector3D cellMin;
+		Vector3D cellMax;
+		while (stackSize > 0)
+		{
+			const size_t cellIndex = stack[--stackSize];
+			getCellBounds(cellIndex,cellMin,cellMax);
+
+			if (cellMin.x > boxMax.x || cellMin.y > boxMax.y || cellMin.z > boxMax.z
+				|| cellMax.x < boxMin.x || cellMax.y < boxMin.y || cellMax.z < boxMin.z)
+				continue;
+
+			const Cell& cell = cells[cellIndex];
+			if (cell.hasChildren)
+				for (size_t i = 0; i < 8; ++i)
+					stack[stackSize++] = cell.children[i];
+			else if (!cell.particles.empty())
+				cellIndices.push_back(cellIndex);
+		}
+	}
+
+	void Octree::findCellsOnRay(const Vector3D& origin,const Vector3D& direction,float length,std::vector<size_t>& cellIndices) const
+	{
+		cellIndices.clear();
+		if (nbCells == 0)
+			return;
+
+		size_t stack[QUERY_STACK_SIZE];
+		size_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		Vector3D cellMin;
+		Vector3D cellMax;
+		while (stackSize > 0)
+		{
+			const size_t cellIndex = stack[--stackSize];
+			getCellBounds(cellIndex,cellMin,cellMax);
+
+			if (!segmentIntersectsBox(origin,direction,length,cellMin,cellMax))
+				continue;
+
+			const Cell& cell = cells[cellIndex];
+			if (cell.hasChildren)
+				for (size_t i = 0; i < 8; ++i)
+					stack[stackSize++] = cell.children[i];
+			else if (!cell.particles.empty())
+				cellIndices.push_back(cellIndex);
+		}
+	}
+
+	bool Octree::segmentIntersectsBox(const Vector3D& origin,const Vector3D& direction,float length,const Vector3D& boxMin,const Vector3D& boxMax)
+	{
+		// Slab test
+		float tMin = 0.0f;
+		float tMax = length;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			if (direction[i] == 0.0f)
+			{
+				if (origin[i] < boxMin[i] || origin[i] > boxMax[i])
+					return false;
+				continue;
+			}
+
+			const float invDirection = 1.0f / direction[i];
+			float t0 = (boxMin[i] - origin[i]) * invDirection;
+			float t1 = (boxMax[i] - origin[i]) * invDirection;
+			if (t0 > t1)
+				std::swap(t0,t1);
+
+			if (t0 > tMin) tMin = t0;
+			if (t1 < tMax) tMax = t1;
+			if (tMin > tMax)
+				return false;
+		}
+
+		return true;
+	}
 }
@@ -0,0 +1,123 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <SPARK_Core.h>
+
+namespace SPK
+{
+	UniformGrid::UniformGrid() :
+		cellStarts(1,0)
+	{
+		for (size_t i = 0; i < 3; ++i)
+			dimensions[i] = 1;
+	}
+
+	void UniformGrid::build(const Vector3D* positions,size_t nbPositions,float cellSize,size_t maxCellsPerPosition,size_t maxCellsPerAxis)
+	{
+		positionCells.resize(nbPositions);
+		sortedIndices.resize(nbPositions);
+
+		if (nbPositions == 0)
+		{
+			for (size_t i = 0; i < 3; ++i)
+				dimensions[i] = 1;
+			cellStarts.assign(2,0);
+			return;
+		}
+
+		// Computes the bounds of the positions
+		Vector3D boundsMin(positions[0]);
+		Vector3D boundsMax(positions[0]);
+		for (size_t i = 1; i < nbPositions; ++i)
+		{
+			boundsMin.setMin(positions[i]);
+			boundsMax.setMax(positions[i]);
+		}
+
+		const Vector3D extent(boundsMax - boundsMin);
+		if (maxCellsPerAxis > 0 && cellSize * maxCellsPerAxis < extent.getMax())
+			cellSize = extent.getMax() / maxCellsPerAxis;
+		if (cellSize <= 0.0f)
+			cellSize = 1.0f;
+
+		const size_t maxCells = maxCellsPerPosition * nbPositions;
+		size_t nbCells = 0;
+		while (true)
+		{
+			nbCells = 1;
+			for (size_t i = 0; i < 3; ++i)
+			{
+				dimensions[i] = static_cast<size_t>(extent[i] / cellSize) + 1;
+				nbCells *= dimensions[i];
+			}
+
+			if (nbCells <= maxCells)
+				break;
+			cellSize *= 2.0f;
+		}
+
+		const float invCellSize = 1.0f / cellSize;
+
+		// Counts the positions per cell
+		cellStarts.assign(nbCells + 1,0);
+		for (size_t i = 0; i < nbPositions; ++i)
+		{
+			const Vector3D relativePos((positions[i] - boundsMin) * invCellSize);
+			size_t coords[3];
+			for (size_t j = 0; j < 3; ++j)
+			{
+				coords[j] = static_cast<size_t>(relativePos[j]);
+				if (coords[j] >= dimensions[j]) // Because of float precision
+					coords[j] = dimensions[j] - 1;
+			}
+
+			const size_t cell = getCellIndex(coords[0],coords[1],coords[2]);
+			positionCells[i] = cell;
+			++cellStarts[cell + 1];
+		}
+
+		// Computes the start of each cell
+		for (size_t i = 0; i < nbCells; ++i)
+			cellStarts[i + 1] += cellStarts[i];
+
+		// Sorts the positions by cell
+		// cellStarts is used as insertion cursors and is shifted back afterwards
+		for (size_t i = 0; i < nbPositions; ++i)
+			sortedIndices[cellStarts[positionCells[i]]++] = i;
+		for (size_t i = nbCells; i > 0; --i)
+			cellStarts[i] = cellStarts[i - 1];
+		cellStarts[0] = 0;
+	}
+
+	void UniformGrid::getNeighborCells(size_t cell,size_t& minX,size_t& minY,size_t& minZ,size_t& maxX,size_t& maxY,size_t& maxZ) const
+	{
+		const size_t cellX = cell % dimensions[0];
+		const size_t cellY = (cell / dimensions[0]) % dimensions[1];
+		const size_t cellZ = cell / (dimensions[0] * dimensions[1]);
+
+		minX = cellX > 0 ? cellX - 1 : 0;
+		minY = cellY > 0 ? cellY - 1 : 0;
+		minZ = cellZ > 0 ? cellZ - 1 : 0;
+		maxX = cellX + 1 < dimensions[0] ? cellX + 1 : cellX;
+		maxY = cellY + 1 < dimensions[1] ? cellY + 1 : cellY;
+		maxZ = cellZ + 1 < dimensions[2] ? cellZ + 1 : cellZ;
+	}
+}
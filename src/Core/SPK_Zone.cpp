@@ -19,6 +19,7 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
+#include <limits> // for max float value
 #include <SPARK_Core.h>
 
 namespace SPK
@@ -68,4 +69,95 @@ namespace SPK
 	{
 		return true;
 	}
+
+	void Zone::containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = contains(v[i],radii != NULL ? radii[i] : 0.0f) ? 1 : 0;
+	}
+
+	void Zone::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = intersects(v0[i],v1[i],radii != NULL ? radii[i] : 0.0f) ? 1 : 0;
+	}
+
+	void Zone::computeBounds(Vector3D& boundsMin,Vector3D& boundsMax) const
+	{
+		const float maxValue = std::numeric_limits<float>::max();
+		boundsMin.set(-maxValue,-maxValue,-maxValue);
+		boundsMax.set(maxValue,maxValue,maxValue);
+	}
+
+	void Zone::checkBatch(const Group& group,size_t begin,size_t nb,ZoneTest zoneTest,unsigned char* mask) const
+	{
+		if (zoneTest == ZONE_TEST_ALWAYS)
+		{
+			for (size_t i = 0; i < nb; ++i)
+				mask[i] = 1;
+			return;
+		}
+
+		const Vector3D* positions = static_cast<const Vector3D*>(group.getPositionAddress()) + begin;
+		const Vector3D* oldPositions = static_cast<const Vector3D*>(group.getOldPositionAddress()) + begin;
+		const float* scales = static_cast<const float*>(group.getParamAddress(PARAM_SCALE));
+
+		float radii[BATCH_SIZE];
+		unsigned char oldMask[BATCH_SIZE];
+
+		for (size_t offset = 0; offset < nb; offset += BATCH_SIZE)
+		{
+			const size_t batchSize = nb - offset < BATCH_SIZE ? nb - offset : BATCH_SIZE;
+			const Vector3D* batchPositions = positions + offset;
+			const Vector3D* batchOldPositions = oldPositions + offset;
+			unsigned char* batchMask = mask + offset;
+
+			// Computes the radii of the particles
+			if (scales != NULL)
+			{
+				const float* batchScales = scales + begin + offset;
+				for (size_t i = 0; i < batchSize; ++i)
+					radii[i] = group.getPhysicalRadius() * batchScales[i];
+			}
+			else
+			{
+				const float radius = group.getParticle(begin + offset).getRadius();
+				for (size_t i = 0; i < batchSize; ++i)
+					radii[i] = radius;
+			}
+
+			switch (zoneTest)
+			{
+			case ZONE_TEST_INSIDE :
+				containsBatch(batchPositions,radii,batchSize,batchMask);
+				break;
+
+			case ZONE_TEST_OUTSIDE :
+				for (size_t i = 0; i < batchSize; ++i)
+					radii[i] = -radii[i];
+				containsBatch(batchPositions,radii,batchSize,batchMask);
+				for (size_t i = 0; i < batchSize; ++i)
+					batchMask[i] ^= 1;
+				break;
+
+			case ZONE_TEST_INTERSECT :
+				intersectsBatch(batchOldPositions,batchPositions,radii,batchSize,batchMask);
+				break;
+
+			case ZONE_TEST_ENTER :
+			case ZONE_TEST_LEAVE :
+				{
+					const unsigned char expectedOld = zoneTest == ZONE_TEST_LEAVE ? 1 : 0;
+					containsBatch(batchOldPositions,NULL,batchSize,oldMask);
+					intersectsBatch(batchOldPositions,batchPositions,radii,batchSize,batchMask);
+					for (size_t i = 0; i < batchSize; ++i)
+						batchMask[i] &= (oldMask[i] == expectedOld ? 1 : 0);
+				}
+				break;
+
+			default :
+				break;
+			}
+		}
+	}
 }
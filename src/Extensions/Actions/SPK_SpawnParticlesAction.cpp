@@ -31,18 +31,15 @@ namespace SPK
 		const Ref<Emitter>& emitter) :
 		minNb(minNb),
 		maxNb(maxNb),
-		baseEmitter(),
+		baseEmitter(emitter),
 		targetGroup(group)
-	{
-		setEmitter(emitter);
-	}
+	{}
 
 	SpawnParticlesAction::SpawnParticlesAction(const SpawnParticlesAction& action) :
         Action(action),
 		minNb(action.minNb),
 		maxNb(action.maxNb),
-		targetGroup(action.targetGroup),
-		emitterPool()
+		targetGroup(action.targetGroup)
 	{
 		targetGroup = action.copyChild(action.targetGroup);
 		baseEmitter = action.copyChild(action.baseEmitter);
@@ -63,25 +60,12 @@ namespace SPK
 		}
 	}
 
-	void SpawnParticlesAction::setEmitter(const Ref<Emitter>& emitter)
-	{
-		resetPool();
-		baseEmitter = emitter;
-	}
-
 	void SpawnParticlesAction::apply(Particle& particle) const
 	{
 		if (!checkValidity())
 			return;
 
-		const Ref<Emitter>& emitter = getNextAvailableEmitter();
-		emitter->setTank(baseEmitter->getMinTank(),baseEmitter->getMaxTank());
-
-		const Ref<Zone>& zone = emitter->getZone();
-		zone->getTransform().setPosition(particle.position());
-		zone->updateTransform();
-
-		targetGroup->addParticles(SPK_RANDOM(minNb,maxNb + 1),emitter);
+		targetGroup->spawnParticles(SPK_RANDOM(minNb,maxNb + 1),particle.position(),baseEmitter);
 	}
 
 	bool SpawnParticlesAction::checkValidity() const
@@ -102,36 +86,10 @@ namespace SPK
 			SPK_LOG_ERROR("SpawnParticlesAction::checkValidity() - The base emitter is NULL and cannot be used");
 			return false;
 		}
-		else if (baseEmitter->getZone()->isShared())
-		{
-			SPK_LOG_ERROR("SpawnParticlesAction::checkValidity() - The base emitter is invalid (its zone is shared) and cannot be used");
-			return false;
-		}
 
 		return true;
 	}
 
-	const Ref<Emitter>& SpawnParticlesAction::getNextAvailableEmitter() const
-	{
-		for (size_t i = 0; i < emitterPool.size(); ++i)
-		{
-			emitterPool.push_back(emitterPool.front());
-			emitterPool.pop_front();
-			if (emitterPool.back()->getNbReferences() == 1) // the emitter is available
-				return emitterPool.back();
-		}
-
-		// No emitter is available in the pool, a new one must be created
-		emitterPool.push_back(copy(baseEmitter));
-		emitterPool.back()->getTransform().reset();
-		return emitterPool.back();
-	}
-
-	void SpawnParticlesAction::resetPool()
-	{
-		emitterPool.clear();
-	}
-
 	Ref<SPKObject> SpawnParticlesAction::findByName(const std::string& name)
 	{
 		Ref<SPKObject> object = Action::findByName(name);
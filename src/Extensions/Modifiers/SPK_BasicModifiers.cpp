@@ -33,6 +33,13 @@ namespace SPK
 			particleIt->velocity() += discreteGravity;
 	}
 
+	void Gravity::getFusedForce(FusedForce& force,const Group& group,float deltaTime) const
+	{
+		force.type = FusedForce::FUSED_FORCE_AFFINE;
+		force.vector = tValue * deltaTime;
+		force.scale = 1.0f;
+	}
+
 	void Friction::modify(Group& group,DataSet* dataSet,float deltaTime) const
 	{
 		const float discreteFriction = value * deltaTime;
@@ -49,4 +56,21 @@ namespace SPK
 				particleIt->velocity() *= ratio;
 		}
 	}
+
+	void Friction::getFusedForce(FusedForce& force,const Group& group,float deltaTime) const
+	{
+		const float discreteFriction = value * deltaTime;
+
+		if (group.isEnabled(PARAM_MASS))
+		{
+			force.type = FusedForce::FUSED_FORCE_DAMPING;
+			force.scale = discreteFriction;
+		}
+		else
+		{
+			force.type = FusedForce::FUSED_FORCE_AFFINE;
+			force.vector.set(0.0f,0.0f,0.0f);
+			force.scale = 1.0f - std::min(1.0f,discreteFriction);
+		}
+	}
 }
@@ -21,9 +21,12 @@
 
 #include <SPARK_Core.h>
 #include "Extensions/Modifiers/SPK_Collider.h"
+#include "Extensions/Modifiers/SPK_CollisionResponse.h"
 
 namespace SPK
 {
+	SPK_DEFINE_ENUM(ColliderBroadphase, SPK_ENUM_COLLIDER_BROADPHASE)
+
 	void Collider::setElasticity(float elasticity)
 	{
 		if (elasticity < 0.0f)
@@ -36,9 +39,19 @@ namespace SPK
 	}
 
 	void Collider::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		if (deterministic)
+			modifyDeterministic(group);
+		else if (broadphase == COLLIDER_BROADPHASE_GRID)
+			modifyWithGrid(group);
+		else
+			modifyWithOctree(group);
+	}
+
+	void Collider::modifyWithOctree(Group& group) const
 	{
 		float groupSqrRadius = group.getPhysicalRadius() * group.getPhysicalRadius();
-		SPK_ASSERT(group.getOctree() != NULL,"GLQuadRenderer::render(const Group&,const DataSet*,RenderBuffer*) - renderBuffer must not be NULL");
+		SPK_ASSERT(group.getOctree() != NULL,"Collider::modifyWithOctree(Group&) - The group has no octree");
 		const Octree& octree = *group.getOctree();
 
 		for (GroupIterator particleIt0(group); !particleIt0.end(); ++particleIt0)
@@ -64,80 +77,209 @@ namespace SPK
 						break; // as particle are ordered
 
 					Particle particle1 = group.getParticle(index1);
-					float radius1 = particle1.getParam(PARAM_SCALE);
+					collide(particle0,particle1,radius0,m0,groupSqrRadius);
+				}
+			}
+		}
+	}
+
+	void Collider::modifyWithGrid(Group& group) const
+	{
+		if (group.getNbParticles() < 2)
+			return;
+
+		float groupSqrRadius = group.getPhysicalRadius() * group.getPhysicalRadius();
+		buildGrid(group);
+
+		for (GroupIterator particleIt0(group); !particleIt0.end(); ++particleIt0)
+		{
+			Particle& particle0 = *particleIt0;
+			float radius0 = particle0.getParam(PARAM_SCALE);
+			float m0 = particle0.getParam(PARAM_MASS);
+
+			size_t index0 = particle0.getIndex();
 
-					float sqrRadius = radius0 + radius1;
-					sqrRadius *= sqrRadius * groupSqrRadius;
+			// Gets the range of the cells around the particle
+			size_t minX,minY,minZ,maxX,maxY,maxZ;
+			grid.getNeighborCells(grid.getCell(index0),minX,minY,minZ,maxX,maxY,maxZ);
 
-					// Gets the normal of the collision plane
-					Vector3D normal = particle0.position() - particle1.position();
-					float sqrDist = normal.getSqrNorm();
+			for (size_t z = minZ; z <= maxZ; ++z) // For each neighboring cell in the grid
+				for (size_t y = minY; y <= maxY; ++y)
+					for (size_t x = minX; x <= maxX; ++x)
+					{
+						const size_t neighborCell = grid.getCellIndex(x,y,z);
+						const size_t end = grid.getCellEnd(neighborCell);
+
+						for (size_t j = grid.getCellStart(neighborCell); j < end; ++j) // for each particles in the cell
+						{
+							size_t index1 = grid.getSortedIndex(j);
+							if (index1 >= index0)
+								break; // as particle are ordered
+
+							Particle particle1 = group.getParticle(index1);
+							collide(particle0,particle1,radius0,m0,groupSqrRadius);
+						}
+					}
+		}
+	}
+
+	void Collider::modifyDeterministic(Group& group) const
+	{
+		const size_t nbParticles = group.getNbParticles();
+		if (nbParticles < 2)
+			return;
 
-					if (sqrDist < sqrRadius) // particles are intersecting each other
+		float groupSqrRadius = group.getPhysicalRadius() * group.getPhysicalRadius();
+		buildGrid(group);
+
+		velocityDeltas.assign(nbParticles,Vector3D());
+		positionResets.assign(nbParticles,0);
+
+		const Group& constGroup = group;
+
+		// First pass : each particle gathers the changes due to all its neighbors
+		// Only the data of the particle index0 is written so that the result does not depend on the order of the particles
+		for (size_t index0 = 0; index0 < nbParticles; ++index0)
+		{
+			const Particle particle0 = constGroup.getParticle(index0);
+			Vector3D& deltaVelocity = velocityDeltas[index0];
+			bool resetPosition = false;
+
+			size_t minX,minY,minZ,maxX,maxY,maxZ;
+			grid.getNeighborCells(grid.getCell(index0),minX,minY,minZ,maxX,maxY,maxZ);
+
+			for (size_t z = minZ; z <= maxZ; ++z) // For each neighboring cell in the grid
+				for (size_t y = minY; y <= maxY; ++y)
+					for (size_t x = minX; x <= maxX; ++x)
 					{
-						Vector3D delta = particle0.velocity() - particle1.velocity();
+						const size_t neighborCell = grid.getCellIndex(x,y,z);
+						const size_t end = grid.getCellEnd(neighborCell);
 
-						if (dotProduct(normal,delta) < 0.0f) // particles are moving towards each other
+						for (size_t j = grid.getCellStart(neighborCell); j < end; ++j) // for each particles in the cell
 						{
-							float oldSqrDist = getSqrDist(particle0.oldPosition(),particle1.oldPosition());
-							if (oldSqrDist > sqrDist)
-							{
-								// Disables the move from this frame
-								particle0.position() = particle0.oldPosition();
-								particle1.position() = particle1.oldPosition();
-
-								normal = particle0.position() - particle1.position();
-
-								if (dotProduct(normal,delta) >= 0.0f)
-									continue;
-							}
-
-							normal.normalize();
-
-							// Gets the normal components of the velocities
-							Vector3D normal0 = normal * dotProduct(normal,particle0.velocity());
-							Vector3D normal1 = normal * dotProduct(normal,particle1.velocity());
-
-							// Resolves collision
-							float m1 = particle1.getParam(PARAM_MASS);
-
-							if (oldSqrDist < sqrRadius && sqrDist < sqrRadius)
-							{
-								// Tweak to separate particles that intersects at both t - deltaTime and t
-								// In that case the collision is no more considered as punctual
-								if (dotProduct(normal,normal0) < 0.0f)
-								{
-									particle0.velocity() -= normal0;
-									particle1.velocity() += normal0;
-								}
-
-								if (dotProduct(normal,normal1) > 0.0f)
-								{
-									particle1.velocity() -= normal1;
-									particle0.velocity() += normal1;
-								}
-							}
-							else
-							{
-								// Else classic collision equations are applied
-								// Tangent components of the velocities are left untouched
-								float elasticityM0 = elasticity * m0;
-								float elasticityM1 = elasticity * m1;
-								float invM01 = 1 / (m0 + m1);
-
-								particle0.velocity() -= (1.0f + (elasticityM1 - m0) * invM01) * normal0;
-								particle1.velocity() -= (1.0f + (elasticityM0 - m1) * invM01) * normal1;
-
-								normal0 *= (elasticityM0 + m0) * invM01;
-								normal1 *= (elasticityM1 + m0) * invM01;
-
-								particle0.velocity() += normal1;
-								particle1.velocity() += normal0;
-							}
+							size_t index1 = grid.getSortedIndex(j);
+							if (index1 != index0)
+								accumulateCollision(particle0,constGroup.getParticle(index1),groupSqrRadius,deltaVelocity,resetPosition);
 						}
 					}
+
+			positionResets[index0] = resetPosition ? 1 : 0;
+		}
+
+		// Second pass : applies the changes
+		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		{
+			Particle& particle = *particleIt;
+			size_t index = particle.getIndex();
+
+			if (positionResets[index] != 0)
+				particle.position() = particle.oldPosition();
+			particle.velocity() += velocityDeltas[index];
+		}
+	}
+
+	void Collider::buildGrid(const Group& group) const
+	{
+		const size_t nbParticles = group.getNbParticles();
+		const Vector3D* positions = static_cast<const Vector3D*>(group.getPositionAddress());
+		const float* scales = static_cast<const float*>(group.getParamAddress(PARAM_SCALE));
+
+		// Computes the biggest scale
+		float maxScale = scales != NULL ? scales[0] : group.getParticle(0).getParam(PARAM_SCALE);
+		if (scales != NULL)
+			for (size_t i = 1; i < nbParticles; ++i)
+				if (scales[i] > maxScale)
+					maxScale = scales[i];
+
+		// Cells are as large as the diameter of the biggest particle so that colliding particles are in neighboring cells
+		grid.build(positions,nbParticles,2.0f * maxScale * group.getPhysicalRadius(),MAX_CELLS_PER_PARTICLE,MAX_CELLS_PER_AXIS);
+	}
+
+	void Collider::collide(Particle& particle0,Particle& particle1,float radius0,float m0,float groupSqrRadius) const
+	{
+		float radius1 = particle1.getParam(PARAM_SCALE);
+
+		float sqrRadius = radius0 + radius1;
+		sqrRadius *= sqrRadius * groupSqrRadius;
+
+		// Gets the normal of the collision plane
+		Vector3D normal = particle0.position() - particle1.position();
+		float sqrDist = normal.getSqrNorm();
+
+		if (sqrDist < sqrRadius) // particles are intersecting each other
+		{
+			Vector3D delta = particle0.velocity() - particle1.velocity();
+
+			if (dotProduct(normal,delta) < 0.0f) // particles are moving towards each other
+			{
+				float oldSqrDist = getSqrDist(particle0.oldPosition(),particle1.oldPosition());
+				if (oldSqrDist > sqrDist)
+				{
+					// Disables the move from this frame
+					particle0.position() = particle0.oldPosition();
+					particle1.position() = particle1.oldPosition();
+
+					normal = particle0.position() - particle1.position();
+
+					if (dotProduct(normal,delta) >= 0.0f)
+						return;
 				}
+
+				normal.normalize();
+
+				// Gets the normal components of the velocities
+				Vector3D normal0 = normal * dotProduct(normal,particle0.velocity());
+				Vector3D normal1 = normal * dotProduct(normal,particle1.velocity());
+
+				// Resolves collision
+				// Both changes are computed before being applied, the same way as in deterministic mode
+				float m1 = particle1.getParam(PARAM_MASS);
+				bool overlapping = oldSqrDist < sqrRadius;
+
+				Vector3D deltaVelocity0 = computeCollisionDeltaVelocity(normal,normal0,normal1,m0,m1,elasticity,overlapping);
+				Vector3D deltaVelocity1 = computeCollisionDeltaVelocity(-normal,normal1,normal0,m1,m0,elasticity,overlapping);
+
+				particle0.velocity() += deltaVelocity0;
+				particle1.velocity() += deltaVelocity1;
 			}
 		}
 	}
+
+	void Collider::accumulateCollision(const Particle& particle0,const Particle& particle1,float groupSqrRadius,Vector3D& deltaVelocity,bool& resetPosition) const
+	{
+		float sqrRadius = particle0.getParam(PARAM_SCALE) + particle1.getParam(PARAM_SCALE);
+		sqrRadius *= sqrRadius * groupSqrRadius;
+
+		// Gets the normal of the collision plane
+		Vector3D normal = particle0.position() - particle1.position();
+		float sqrDist = normal.getSqrNorm();
+
+		if (sqrDist >= sqrRadius) // particles are not intersecting each other
+			return;
+
+		Vector3D delta = particle0.velocity() - particle1.velocity();
+		if (dotProduct(normal,delta) >= 0.0f) // particles are not moving towards each other
+			return;
+
+		float oldSqrDist = getSqrDist(particle0.oldPosition(),particle1.oldPosition());
+		if (oldSqrDist > sqrDist)
+		{
+			// Disables the move from this frame
+			resetPosition = true;
+
+			normal = particle0.oldPosition() - particle1.oldPosition();
+
+			if (dotProduct(normal,delta) >= 0.0f)
+				return;
+		}
+
+		normal.normalize();
+
+		// Gets the normal components of the velocities
+		Vector3D normal0 = normal * dotProduct(normal,particle0.velocity());
+		Vector3D normal1 = normal * dotProduct(normal,particle1.velocity());
+
+		// Only the side of particle0 is computed, particle1 gets its own change when it is processed
+		deltaVelocity += computeCollisionDeltaVelocity(normal,normal0,normal1,particle0.getParam(PARAM_MASS),particle1.getParam(PARAM_MASS),elasticity,oldSqrDist < sqrRadius);
+	}
 }
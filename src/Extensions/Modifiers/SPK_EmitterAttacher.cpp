@@ -29,13 +29,15 @@ namespace SPK
 		baseEmitter(emitter),
 		targetGroup(group),
 		orientationEnabled(orientate),
-		rotationEnabled(rotate)
+		rotationEnabled(rotate),
+		batchedModeEnabled(false)
 	{}
 
 	EmitterAttacher::EmitterAttacher(const EmitterAttacher& emitterAttacher) :
 		Modifier(emitterAttacher),
 		orientationEnabled(emitterAttacher.orientationEnabled),
-		rotationEnabled(emitterAttacher.rotationEnabled)
+		rotationEnabled(emitterAttacher.rotationEnabled),
+		batchedModeEnabled(emitterAttacher.batchedModeEnabled)
 	{
 		baseEmitter = emitterAttacher.copyChild(emitterAttacher.baseEmitter);
 		targetGroup = emitterAttacher.copyChild(emitterAttacher.targetGroup);
@@ -46,7 +48,8 @@ namespace SPK
 	EmitterAttacher::EmitterData::EmitterData(size_t nbParticles,Group* emittingGroup) :
 		data(SPK_NEW_ARRAY(Ref<Emitter>,nbParticles)),
 		dataSize(nbParticles),
-		group(emittingGroup)
+		group(emittingGroup),
+		batched(false)
 	{}
 
 	EmitterAttacher::EmitterData::~EmitterData()
@@ -58,18 +61,22 @@ namespace SPK
 	{
 		dataSet.init(NB_DATA);
 		EmitterData* data = SPK_NEW(EmitterData,group.getCapacity(),targetGroup.get());
+		data->setBatched(batchedModeEnabled);
 		dataSet.setData(EMITTER_INDEX,data);
-		initData(*data,group);
+		dataSet.setData(FRACTION_INDEX,SPK_NEW(FloatArrayData,group.getCapacity(),1));
+		dataSet.setData(TANK_INDEX,SPK_NEW(ArrayData<int>,group.getCapacity(),1));
+		initData(dataSet,group);
 	}
 
 	void EmitterAttacher::checkData(DataSet& dataSet,const Group& group) const
 	{
 		EmitterData& data = SPK_GET_DATA(EmitterData,&dataSet,EMITTER_INDEX);
 		Group* currentDataGroup = data.getGroup();
-		if (currentDataGroup != targetGroup)
+		if (currentDataGroup != targetGroup || data.isBatched() != batchedModeEnabled)
 		{
 			data.setGroup(targetGroup.get());
-			initData(data,group);
+			data.setBatched(batchedModeEnabled);
+			initData(dataSet,group);
 		}
 	}
 
@@ -91,7 +98,7 @@ namespace SPK
 			SPK_LOG_ERROR("EmitterAttacher::checkValidity() - The base emitter is NULL and cannot be used");
 			return false;
 		}
-		else if (baseEmitter->getZone()->isShared())
+		else if (!batchedModeEnabled && baseEmitter->getZone()->isShared()) // The zone is not transformed in batched mode
 		{
 			SPK_LOG_ERROR("EmitterAttacher::checkValidity() - The base emitter is invalid (its zone is shared) and cannot be used");
 			return false;
@@ -100,15 +107,78 @@ namespace SPK
 		return true;
 	}
 
-	void EmitterAttacher::initData(EmitterData& data,const Group& group) const
+	void EmitterAttacher::initData(DataSet& dataSet,const Group& group) const
 	{
+		EmitterData& data = SPK_GET_DATA(EmitterData,&dataSet,EMITTER_INDEX);
+		float* fractions = SPK_GET_DATA(FloatArrayData,&dataSet,FRACTION_INDEX).getData();
+		int* tanks = SPK_GET_DATA(ArrayData<int>,&dataSet,TANK_INDEX).getData();
+
 		for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
-			data.setEmitter(particleIt->getIndex(),baseEmitter);
+		{
+			const size_t index = particleIt->getIndex();
+			if (batchedModeEnabled)
+			{
+				data.getEmitters()[index].reset(); // Releases the emitters copied in the other mode
+				fractions[index] = SPK_RANDOM(0.0f,1.0f); // So that particles do not all emit at the same time
+				tanks[index] = baseEmitter ? SPK_RANDOM(baseEmitter->getMinTank(),baseEmitter->getMaxTank()) : -1;
+			}
+			else
+				data.setEmitter(index,baseEmitter);
+		}
 	}
 
 	void EmitterAttacher::init(Particle& particle,DataSet* dataSet) const
 	{
-		SPK_GET_DATA(EmitterData,dataSet,EMITTER_INDEX).setEmitter(particle.getIndex(),baseEmitter);
+		if (batchedModeEnabled)
+		{
+			SPK_GET_DATA(FloatArrayData,dataSet,FRACTION_INDEX).getData()[particle.getIndex()] = SPK_RANDOM(0.0f,1.0f);
+			SPK_GET_DATA(ArrayData<int>,dataSet,TANK_INDEX).getData()[particle.getIndex()] = baseEmitter ? SPK_RANDOM(baseEmitter->getMinTank(),baseEmitter->getMaxTank()) : -1;
+		}
+		else
+			SPK_GET_DATA(EmitterData,dataSet,EMITTER_INDEX).setEmitter(particle.getIndex(),baseEmitter);
+	}
+
+	void EmitterAttacher::modifyBatched(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		const float nbPerParticle = baseEmitter->getFlow() * deltaTime;
+		if (nbPerParticle <= 0.0f) // Infinite flows have no meaning here
+			return;
+
+		const Vector3D* positions = static_cast<const Vector3D*>(group.getPositionAddress());
+		float* fractions = SPK_GET_DATA(FloatArrayData,dataSet,FRACTION_INDEX).getData();
+		int* tanks = SPK_GET_DATA(ArrayData<int>,dataSet,TANK_INDEX).getData();
+
+		// Particles cannot be created in the group being updated, they are spawned once the group is updated
+		const bool selfTarget = targetGroup == &group;
+
+		spawnPositions.clear();
+		for (size_t i = 0; i < group.getNbParticles(); ++i)
+		{
+			if (tanks[i] == 0)
+				continue;
+
+			fractions[i] += nbPerParticle;
+			int nb = static_cast<int>(fractions[i]);
+			fractions[i] -= nb;
+
+			if (tanks[i] > 0)
+			{
+				if (nb > tanks[i])
+					nb = tanks[i];
+				tanks[i] -= nb;
+			}
+
+			if (nb == 0)
+				continue;
+
+			if (selfTarget)
+				group.spawnParticles(nb,positions[i],baseEmitter);
+			else
+				spawnPositions.insert(spawnPositions.end(),nb,positions[i]);
+		}
+
+		if (!spawnPositions.empty())
+			targetGroup->emitParticles(baseEmitter,spawnPositions.size(),&spawnPositions[0]);
 	}
 
 	void EmitterAttacher::modify(Group& group,DataSet* dataSet,float deltaTime) const
@@ -116,6 +186,12 @@ namespace SPK
 		if (!checkValidity())
 			return;
 
+		if (batchedModeEnabled)
+		{
+			modifyBatched(group,dataSet,deltaTime);
+			return;
+		}
+
 		EmitterData& data = SPK_GET_DATA(EmitterData,dataSet,EMITTER_INDEX);
 		Ref<Emitter>* emitterIt = data.getEmitters();
 
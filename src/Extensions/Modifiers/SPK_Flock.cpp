@@ -0,0 +1,205 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath> // for std::sqrt
+
+#include <SPARK_Core.h>
+#include "Extensions/Modifiers/SPK_Flock.h"
+
+namespace SPK
+{
+	Flock::Flock(float viewRadius,float maxSpeed) :
+		Modifier(MODIFIER_PRIORITY_FORCE,true,true,false),
+		viewRadius(1.0f),
+		maxSpeed(0.0f),
+		separationWeight(1.0f),
+		alignmentWeight(1.0f),
+		cohesionWeight(1.0f),
+		maxNeighbors(0),
+		updateStride(1)
+	{
+		setViewRadius(viewRadius);
+		setMaxSpeed(maxSpeed);
+	}
+
+	void Flock::setViewRadius(float viewRadius)
+	{
+		if (viewRadius <= 0.0f)
+		{
+			SPK_LOG_WARNING("Flock::setViewRadius(float) - The view radius must be strictly positive, nothing is set");
+			return;
+		}
+
+		this->viewRadius = viewRadius;
+	}
+
+	void Flock::setMaxSpeed(float maxSpeed)
+	{
+		if (maxSpeed < 0.0f)
+		{
+			SPK_LOG_WARNING("Flock::setMaxSpeed(float) - The maximum speed cannot be negative, 0.0f is set");
+			maxSpeed = 0.0f;
+		}
+
+		this->maxSpeed = maxSpeed;
+	}
+
+	void Flock::setUpdateStride(unsigned int updateStride)
+	{
+		if (updateStride == 0)
+		{
+			SPK_LOG_WARNING("Flock::setUpdateStride(unsigned int) - The update stride cannot be 0, 1 is set");
+			updateStride = 1;
+		}
+
+		this->updateStride = updateStride;
+	}
+
+	void Flock::createData(DataSet& dataSet,const Group& group) const
+	{
+		dataSet.init(NB_DATA);
+		dataSet.setData(STEERING_INDEX,SPK_NEW(Vector3DArrayData,group.getCapacity(),1));
+		dataSet.setData(STRIDE_INDEX,SPK_NEW(StrideData));
+
+		// Steering is computed at the first update
+		Vector3D* steerings = SPK_GET_DATA(Vector3DArrayData,&dataSet,STEERING_INDEX).getData();
+		for (size_t i = 0; i < group.getCapacity(); ++i)
+			steerings[i].set(0.0f,0.0f,0.0f);
+	}
+
+	void Flock::init(Particle& particle,DataSet* dataSet) const
+	{
+		SPK_GET_DATA(Vector3DArrayData,dataSet,STEERING_INDEX)[particle.getIndex()].set(0.0f,0.0f,0.0f);
+	}
+
+	void Flock::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		const size_t nbParticles = group.getNbParticles();
+		if (nbParticles == 0)
+			return;
+
+		unsigned int& strideOffset = SPK_GET_DATA(StrideData,dataSet,STRIDE_INDEX).offset;
+		if (strideOffset >= updateStride)
+			strideOffset = 0;
+
+		buildGrid(group);
+
+		// Only the particles at the current offset of the stride compute their steering
+		Vector3D* steerings = SPK_GET_DATA(Vector3DArrayData,dataSet,STEERING_INDEX).getData();
+		for (size_t i = strideOffset; i < nbParticles; i += updateStride)
+			steerings[i] = computeSteering(group,i);
+
+		++strideOffset;
+
+		const float sqrMaxSpeed = maxSpeed * maxSpeed;
+		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		{
+			Particle& particle = *particleIt;
+			particle.velocity() += steerings[particle.getIndex()] * deltaTime;
+
+			if (maxSpeed > 0.0f)
+			{
+				const float sqrSpeed = particle.velocity().getSqrNorm();
+				if (sqrSpeed > sqrMaxSpeed)
+					particle.velocity() *= maxSpeed / std::sqrt(sqrSpeed);
+			}
+		}
+	}
+
+	void Flock::buildGrid(const Group& group) const
+	{
+		const size_t nbParticles = group.getNbParticles();
+		const Vector3D* positions = static_cast<const Vector3D*>(group.getPositionAddress());
+
+		// Cells are as large as the view radius so that visible neighbors are in neighboring cells
+		grid.build(positions,nbParticles,viewRadius,MAX_CELLS_PER_PARTICLE);
+	}
+
+	bool Flock::examineCell(const Group& group,size_t cell,size_t index,Vector3D& separation,Vector3D& meanVelocity,Vector3D& center,size_t& nbNeighbors) const
+	{
+		const Vector3D* positions = static_cast<const Vector3D*>(group.getPositionAddress());
+		const Vector3D* velocities = static_cast<const Vector3D*>(group.getVelocityAddress());
+		const Vector3D& position = positions[index];
+		const float sqrViewRadius = viewRadius * viewRadius;
+
+		const size_t end = grid.getCellEnd(cell);
+		for (size_t j = grid.getCellStart(cell); j < end; ++j) // for each particles in the cell
+		{
+			const size_t neighbor = grid.getSortedIndex(j);
+			if (neighbor == index)
+				continue;
+
+			const Vector3D delta = position - positions[neighbor];
+			const float sqrDist = delta.getSqrNorm();
+			if (sqrDist >= sqrViewRadius)
+				continue;
+
+			// The separation is inversely proportional to the distance
+			if (sqrDist > 0.0f)
+				separation += delta / sqrDist;
+			meanVelocity += velocities[neighbor];
+			center += positions[neighbor];
+
+			if (++nbNeighbors == maxNeighbors)
+				return true;
+		}
+
+		return false;
+	}
+
+	Vector3D Flock::computeSteering(const Group& group,size_t index) const
+	{
+		const Vector3D* positions = static_cast<const Vector3D*>(group.getPositionAddress());
+		const Vector3D* velocities = static_cast<const Vector3D*>(group.getVelocityAddress());
+		const Vector3D& position = positions[index];
+
+		const size_t cell = grid.getCell(index);
+		size_t minX,minY,minZ,maxX,maxY,maxZ;
+		grid.getNeighborCells(cell,minX,minY,minZ,maxX,maxY,maxZ);
+
+		Vector3D separation;
+		Vector3D meanVelocity;
+		Vector3D center;
+		size_t nbNeighbors = 0;
+
+		// The own cell of the particle is examined first so that the closest neighbors are kept when the cap is reached
+		bool capReached = examineCell(group,cell,index,separation,meanVelocity,center,nbNeighbors);
+		for (size_t z = minZ; z <= maxZ && !capReached; ++z) // For each neighboring cell in the grid
+			for (size_t y = minY; y <= maxY && !capReached; ++y)
+				for (size_t x = minX; x <= maxX && !capReached; ++x)
+				{
+					const size_t neighborCell = grid.getCellIndex(x,y,z);
+					if (neighborCell != cell)
+						capReached = examineCell(group,neighborCell,index,separation,meanVelocity,center,nbNeighbors);
+				}
+
+		if (nbNeighbors == 0)
+			return Vector3D();
+
+		const float invNbNeighbors = 1.0f / nbNeighbors;
+		meanVelocity *= invNbNeighbors;
+		center *= invNbNeighbors;
+
+		return separation * separationWeight
+			+ (meanVelocity - velocities[index]) * alignmentWeight
+			+ (center - position) * cohesionWeight;
+	}
+}
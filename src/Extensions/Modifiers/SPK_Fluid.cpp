@@ -0,0 +1,239 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath> // for std::sqrt
+
+#include <SPARK_Core.h>
+#include "Extensions/Modifiers/SPK_Fluid.h"
+
+namespace SPK
+{
+	const float Fluid::PI = 3.1415926535897932384626433832795f;
+
+	Fluid::Fluid(float smoothingLength,float restDensity,float stiffness,float viscosity) :
+		Modifier(MODIFIER_PRIORITY_FORCE,true,false,false),
+		smoothingLength(1.0f),
+		restDensity(1.0f),
+		stiffness(stiffness),
+		viscosity(0.0f)
+	{
+		setSmoothingLength(smoothingLength);
+		setRestDensity(restDensity);
+		setViscosity(viscosity);
+	}
+
+	void Fluid::setSmoothingLength(float smoothingLength)
+	{
+		if (smoothingLength <= 0.0f)
+		{
+			SPK_LOG_WARNING("Fluid::setSmoothingLength(float) - The smoothing length must be strictly positive, nothing is set");
+			return;
+		}
+
+		this->smoothingLength = smoothingLength;
+	}
+
+	void Fluid::setRestDensity(float restDensity)
+	{
+		if (restDensity < 0.0f)
+		{
+			SPK_LOG_WARNING("Fluid::setRestDensity(float) - The rest density cannot be negative, 0.0f is set");
+			restDensity = 0.0f;
+		}
+
+		this->restDensity = restDensity;
+	}
+
+	void Fluid::setViscosity(float viscosity)
+	{
+		if (viscosity < 0.0f)
+		{
+			SPK_LOG_WARNING("Fluid::setViscosity(float) - The viscosity cannot be negative, 0.0f is set");
+			viscosity = 0.0f;
+		}
+
+		this->viscosity = viscosity;
+	}
+
+	void Fluid::createData(DataSet& dataSet,const Group& group) const
+	{
+		dataSet.init(NB_DATA);
+		dataSet.setData(DENSITY_INDEX,SPK_NEW(FloatArrayData,group.getCapacity(),1));
+		dataSet.setData(PRESSURE_INDEX,SPK_NEW(FloatArrayData,group.getCapacity(),1));
+
+		// Inits the data
+		float* densities = SPK_GET_DATA(FloatArrayData,&dataSet,DENSITY_INDEX).getData();
+		float* pressures = SPK_GET_DATA(FloatArrayData,&dataSet,PRESSURE_INDEX).getData();
+		for (size_t i = 0; i < group.getCapacity(); ++i)
+		{
+			densities[i] = restDensity;
+			pressures[i] = 0.0f;
+		}
+	}
+
+	void Fluid::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		const size_t nbParticles = group.getNbParticles();
+		if (nbParticles == 0)
+			return;
+
+		buildGrid(group);
+		computeDensities();
+		computeAccelerations(group,deltaTime);
+
+		// Stores the densities and pressures of the particles
+		float* densities = SPK_GET_DATA(FloatArrayData,dataSet,DENSITY_INDEX).getData();
+		float* pressures = SPK_GET_DATA(FloatArrayData,dataSet,PRESSURE_INDEX).getData();
+		for (size_t i = 0; i < nbParticles; ++i)
+		{
+			densities[grid.getSortedIndex(i)] = sortedDensities[i];
+			pressures[grid.getSortedIndex(i)] = sortedPressures[i];
+		}
+	}
+
+	void Fluid::buildGrid(const Group& group) const
+	{
+		const size_t nbParticles = group.getNbParticles();
+		const Vector3D* positions = static_cast<const Vector3D*>(group.getPositionAddress());
+
+		// Cells are as large as the smoothing length so that interacting particles are in neighboring cells
+		grid.build(positions,nbParticles,smoothingLength,MAX_CELLS_PER_PARTICLE);
+
+		// Gathers the data of the particles in the order of the cells
+		sortedPositions.resize(nbParticles);
+		sortedVelocities.resize(nbParticles);
+		sortedMasses.resize(nbParticles);
+		sortedDensities.resize(nbParticles);
+		sortedPressures.resize(nbParticles);
+		for (size_t i = 0; i < nbParticles; ++i)
+		{
+			const Particle particle = group.getParticle(grid.getSortedIndex(i));
+			sortedPositions[i] = particle.position();
+			sortedVelocities[i] = particle.velocity();
+			sortedMasses[i] = particle.getParam(PARAM_MASS);
+		}
+	}
+
+	void Fluid::computeDensities() const
+	{
+		const float sqrLength = smoothingLength * smoothingLength;
+		const float poly6Factor = 315.0f / (64.0f * PI * sqrLength * sqrLength * sqrLength * sqrLength * smoothingLength);
+		const size_t nbCells = grid.getNbCells();
+
+		// Particles are processed cell by cell so that the neighboring cells remain in cache
+		for (size_t cell = 0; cell < nbCells; ++cell)
+		{
+			const size_t cellBegin = grid.getCellStart(cell);
+			const size_t cellEnd = grid.getCellEnd(cell);
+			if (cellBegin == cellEnd)
+				continue;
+
+			size_t minX,minY,minZ,maxX,maxY,maxZ;
+			grid.getNeighborCells(cell,minX,minY,minZ,maxX,maxY,maxZ);
+
+			for (size_t i = cellBegin; i < cellEnd; ++i)
+			{
+				const Vector3D& position = sortedPositions[i];
+				float density = 0.0f;
+
+				for (size_t z = minZ; z <= maxZ; ++z) // For each neighboring cell in the grid
+					for (size_t y = minY; y <= maxY; ++y)
+					{
+						// Cells along x are contiguous in the sorted arrays
+						const size_t begin = grid.getCellStart(grid.getCellIndex(minX,y,z));
+						const size_t end = grid.getCellEnd(grid.getCellIndex(maxX,y,z));
+
+						for (size_t j = begin; j < end; ++j)
+						{
+							const float sqrDist = getSqrDist(position,sortedPositions[j]);
+							const float diff = sqrLength - sqrDist;
+							if (diff > 0.0f)
+								density += sortedMasses[j] * diff * diff * diff;
+						}
+					}
+
+				density *= poly6Factor;
+				sortedDensities[i] = density;
+
+				// Negative pressures are clamped so that the free surface does not attract particles
+				const float pressure = stiffness * (density - restDensity);
+				sortedPressures[i] = pressure > 0.0f ? pressure : 0.0f;
+			}
+		}
+	}
+
+	void Fluid::computeAccelerations(Group& group,float deltaTime) const
+	{
+		const float sqrLength = smoothingLength * smoothingLength;
+		const float kernelFactor = 45.0f / (PI * sqrLength * sqrLength * sqrLength); // Factor of the spiky gradient and of the viscosity laplacian
+		const size_t nbCells = grid.getNbCells();
+
+		for (size_t cell = 0; cell < nbCells; ++cell)
+		{
+			const size_t cellBegin = grid.getCellStart(cell);
+			const size_t cellEnd = grid.getCellEnd(cell);
+			if (cellBegin == cellEnd)
+				continue;
+
+			size_t minX,minY,minZ,maxX,maxY,maxZ;
+			grid.getNeighborCells(cell,minX,minY,minZ,maxX,maxY,maxZ);
+
+			for (size_t i = cellBegin; i < cellEnd; ++i)
+			{
+				const Vector3D& position = sortedPositions[i];
+				const Vector3D& velocity = sortedVelocities[i];
+				const float pressure = sortedPressures[i];
+
+				Vector3D pressureForce;
+				Vector3D viscosityForce;
+
+				for (size_t z = minZ; z <= maxZ; ++z) // For each neighboring cell in the grid
+					for (size_t y = minY; y <= maxY; ++y)
+					{
+						const size_t begin = grid.getCellStart(grid.getCellIndex(minX,y,z));
+						const size_t end = grid.getCellEnd(grid.getCellIndex(maxX,y,z));
+
+						for (size_t j = begin; j < end; ++j)
+						{
+							Vector3D delta = position - sortedPositions[j];
+							const float sqrDist = delta.getSqrNorm();
+							if (sqrDist >= sqrLength || j == i)
+								continue;
+
+							const float dist = std::sqrt(sqrDist);
+							const float diff = smoothingLength - dist;
+							const float massOverDensity = sortedMasses[j] / sortedDensities[j];
+
+							// Particles at the same position are not pushed apart as the direction is undefined
+							if (dist > 0.0f)
+								pressureForce += delta * (massOverDensity * 0.5f * (pressure + sortedPressures[j]) * diff * diff / dist);
+							viscosityForce += (sortedVelocities[j] - velocity) * (massOverDensity * diff);
+						}
+					}
+
+				// The density of a particle is never 0 as it includes its own mass
+				const float invDensity = 1.0f / sortedDensities[i];
+				Particle particle = group.getParticle(grid.getSortedIndex(i));
+				particle.velocity() += (pressureForce + viscosityForce * viscosity) * (kernelFactor * invDensity * deltaTime);
+			}
+		}
+	}
+}
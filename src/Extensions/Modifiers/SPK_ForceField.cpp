@@ -0,0 +1,606 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath> // for std::ceil
+#include <limits> // for max float value
+
+#include <SPARK_Core.h>
+#include "Extensions/Modifiers/SPK_ForceField.h"
+
+namespace SPK
+{
+	ForceField::ForceField(float cullingCellSize) :
+		Modifier(MODIFIER_PRIORITY_FORCE,false,false,false),
+		sourcesDirty(true)
+	{
+		setCullingCellSize(cullingCellSize);
+	}
+
+	ForceField::ForceField(const ForceField& forceField) :
+		Modifier(forceField),
+		pointMasses(forceField.pointMasses),
+		vortices(forceField.vortices),
+		directionalForces(forceField.directionalForces),
+		cullingCellSize(forceField.cullingCellSize),
+		sourcesDirty(true)
+	{}
+
+	unsigned int ForceField::addPointMass(const Vector3D& position,float mass,float offset,float range)
+	{
+		pointMasses.push_back(PointMassDef());
+		setPointMass(getNbPointMasses() - 1,position,mass,offset,range);
+		return getNbPointMasses() - 1;
+	}
+
+	void ForceField::setPointMass(unsigned int index,const Vector3D& position,float mass,float offset,float range)
+	{
+		setPointMassPosition(index,position);
+		setPointMassMass(index,mass);
+		setPointMassOffset(index,offset);
+		setPointMassRange(index,range);
+	}
+
+	void ForceField::createPointMass()
+	{
+		addPointMass(Vector3D(),1.0f);
+	}
+
+	void ForceField::removePointMass(unsigned int index)
+	{
+		SPK_ASSERT(index < getNbPointMasses(),"ForceField::removePointMass(unsigned int) - Index of point mass is out of bounds : " << index);
+
+		description::pointMasses::elementRemoved(this,index);
+		pointMasses.erase(pointMasses.begin() + index);
+		sourcesDirty = true;
+	}
+
+	void ForceField::removeAllPointMasses()
+	{
+		description::pointMasses::elementsCleared(this);
+		pointMasses.clear();
+		sourcesDirty = true;
+	}
+
+	void ForceField::setPointMassPosition(unsigned int index,const Vector3D& position)
+	{
+		SPK_ASSERT(index < getNbPointMasses(),"ForceField::setPointMassPosition(unsigned int,const Vector3D&) - Index of point mass is out of bounds : " << index);
+
+		pointMasses[index].position = position;
+		transformPos(pointMasses[index].tPosition,position);
+		sourcesDirty = true;
+	}
+
+	void ForceField::setPointMassMass(unsigned int index,float mass)
+	{
+		SPK_ASSERT(index < getNbPointMasses(),"ForceField::setPointMassMass(unsigned int,float) - Index of point mass is out of bounds : " << index);
+
+		pointMasses[index].mass = mass;
+		sourcesDirty = true;
+	}
+
+	void ForceField::setPointMassOffset(unsigned int index,float offset)
+	{
+		SPK_ASSERT(index < getNbPointMasses(),"ForceField::setPointMassOffset(unsigned int,float) - Index of point mass is out of bounds : " << index);
+
+		if (offset <= 0.0f)
+		{
+			SPK_LOG_WARNING("ForceField::setPointMassOffset(unsigned int,float) - Offset must be superior to 0. Offset is set to 0.01f");
+			offset = 0.01f;
+		}
+
+		pointMasses[index].offset = offset;
+		sourcesDirty = true;
+	}
+
+	void ForceField::setPointMassRange(unsigned int index,float range)
+	{
+		SPK_ASSERT(index < getNbPointMasses(),"ForceField::setPointMassRange(unsigned int,float) - Index of point mass is out of bounds : " << index);
+
+		pointMasses[index].range = range < 0.0f ? 0.0f : range;
+		sourcesDirty = true;
+	}
+
+	unsigned int ForceField::addVortex(const Vector3D& position,const Vector3D& axis,float rotationStrength,float attractionStrength,float offset,float range)
+	{
+		vortices.push_back(VortexDef());
+		setVortex(getNbVortices() - 1,position,axis,rotationStrength,attractionStrength,offset,range);
+		return getNbVortices() - 1;
+	}
+
+	void ForceField::setVortex(unsigned int index,const Vector3D& position,const Vector3D& axis,float rotationStrength,float attractionStrength,float offset,float range)
+	{
+		setVortexPosition(index,position);
+		setVortexAxis(index,axis);
+		setVortexRotationStrength(index,rotationStrength);
+		setVortexAttractionStrength(index,attractionStrength);
+		setVortexOffset(index,offset);
+		setVortexRange(index,range);
+	}
+
+	void ForceField::createVortex()
+	{
+		addVortex(Vector3D(),Vector3D(0.0f,1.0f,0.0f),1.0f);
+	}
+
+	void ForceField::removeVortex(unsigned int index)
+	{
+		SPK_ASSERT(index < getNbVortices(),"ForceField::removeVortex(unsigned int) - Index of vortex is out of bounds : " << index);
+
+		description::vortices::elementRemoved(this,index);
+		vortices.erase(vortices.begin() + index);
+		sourcesDirty = true;
+	}
+
+	void ForceField::removeAllVortices()
+	{
+		description::vortices::elementsCleared(this);
+		vortices.clear();
+		sourcesDirty = true;
+	}
+
+	void ForceField::setVortexPosition(unsigned int index,const Vector3D& position)
+	{
+		SPK_ASSERT(index < getNbVortices(),"ForceField::setVortexPosition(unsigned int,const Vector3D&) - Index of vortex is out of bounds : " << index);
+
+		vortices[index].position = position;
+		transformPos(vortices[index].tPosition,position);
+		sourcesDirty = true;
+	}
+
+	void ForceField::setVortexAxis(unsigned int index,const Vector3D& axis)
+	{
+		SPK_ASSERT(index < getNbVortices(),"ForceField::setVortexAxis(unsigned int,const Vector3D&) - Index of vortex is out of bounds : " << index);
+
+		VortexDef& def = vortices[index];
+		def.axis = axis;
+		transformDir(def.tAxis,axis);
+		def.tAxis.normalize();
+		sourcesDirty = true;
+	}
+
+	void ForceField::setVortexRotationStrength(unsigned int index,float rotationStrength)
+	{
+		SPK_ASSERT(index < getNbVortices(),"ForceField::setVortexRotationStrength(unsigned int,float) - Index of vortex is out of bounds : " << index);
+
+		vortices[index].rotationStrength = rotationStrength;
+		sourcesDirty = true;
+	}
+
+	void ForceField::setVortexAttractionStrength(unsigned int index,float attractionStrength)
+	{
+		SPK_ASSERT(index < getNbVortices(),"ForceField::setVortexAttractionStrength(unsigned int,float) - Index of vortex is out of bounds : " << index);
+
+		vortices[index].attractionStrength = attractionStrength;
+		sourcesDirty = true;
+	}
+
+	void ForceField::setVortexOffset(unsigned int index,float offset)
+	{
+		SPK_ASSERT(index < getNbVortices(),"ForceField::setVortexOffset(unsigned int,float) - Index of vortex is out of bounds : " << index);
+
+		if (offset <= 0.0f)
+		{
+			SPK_LOG_WARNING("ForceField::setVortexOffset(unsigned int,float) - Offset must be superior to 0. Offset is set to 0.01f");
+			offset = 0.01f;
+		}
+
+		vortices[index].offset = offset;
+		sourcesDirty = true;
+	}
+
+	void ForceField::setVortexRange(unsigned int index,float range)
+	{
+		SPK_ASSERT(index < getNbVortices(),"ForceField::setVortexRange(unsigned int,float) - Index of vortex is out of bounds : " << index);
+
+		vortices[index].range = range < 0.0f ? 0.0f : range;
+		sourcesDirty = true;
+	}
+
+	unsigned int ForceField::addDirectionalForce(const Vector3D& force,const Vector3D& position,float range)
+	{
+		directionalForces.push_back(DirectionalForceDef());
+		setDirectionalForce(getNbDirectionalForces() - 1,force,position,range);
+		return getNbDirectionalForces() - 1;
+	}
+
+	void ForceField::setDirectionalForce(unsigned int index,const Vector3D& force,const Vector3D& position,float range)
+	{
+		setDirectionalForceVector(index,force);
+		setDirectionalForcePosition(index,position);
+		setDirectionalForceRange(index,range);
+	}
+
+	void ForceField::createDirectionalForce()
+	{
+		addDirectionalForce(Vector3D());
+	}
+
+	void ForceField::removeDirectionalForce(unsigned int index)
+	{
+		SPK_ASSERT(index < getNbDirectionalForces(),"ForceField::removeDirectionalForce(unsigned int) - Index of directional force is out of bounds : " << index);
+
+		description::directionalForces::elementRemoved(this,index);
+		directionalForces.erase(directionalForces.begin() + index);
+		sourcesDirty = true;
+	}
+
+	void ForceField::removeAllDirectionalForces()
+	{
+		description::directionalForces::elementsCleared(this);
+		directionalForces.clear();
+		sourcesDirty = true;
+	}
+
+	void ForceField::setDirectionalForceVector(unsigned int index,const Vector3D& force)
+	{
+		SPK_ASSERT(index < getNbDirectionalForces(),"ForceField::setDirectionalForceVector(unsigned int,const Vector3D&) - Index of directional force is out of bounds : " << index);
+
+		directionalForces[index].force = force;
+		transformDir(directionalForces[index].tForce,force);
+		sourcesDirty = true;
+	}
+
+	void ForceField::setDirectionalForcePosition(unsigned int index,const Vector3D& position)
+	{
+		SPK_ASSERT(index < getNbDirectionalForces(),"ForceField::setDirectionalForcePosition(unsigned int,const Vector3D&) - Index of directional force is out of bounds : " << index);
+
+		directionalForces[index].position = position;
+		transformPos(directionalForces[index].tPosition,position);
+		sourcesDirty = true;
+	}
+
+	void ForceField::setDirectionalForceRange(unsigned int index,float range)
+	{
+		SPK_ASSERT(index < getNbDirectionalForces(),"ForceField::setDirectionalForceRange(unsigned int,float) - Index of directional force is out of bounds : " << index);
+
+		directionalForces[index].range = range < 0.0f ? 0.0f : range;
+		sourcesDirty = true;
+	}
+
+	void ForceField::removeAllSources()
+	{
+		removeAllPointMasses();
+		removeAllVortices();
+		removeAllDirectionalForces();
+	}
+
+	void ForceField::setCullingCellSize(float cullingCellSize)
+	{
+		if (cullingCellSize < 0.0f)
+		{
+			SPK_LOG_WARNING("ForceField::setCullingCellSize(float) - The culling cell size cannot be negative. Culling is disabled");
+			cullingCellSize = 0.0f;
+		}
+
+		this->cullingCellSize = cullingCellSize;
+		sourcesDirty = true;
+	}
+
+	// Gets the squared range used in computation (an infinite range is set to the max float value)
+	static inline float getSqrRange(float range)
+	{
+		return range > 0.0f ? range * range : std::numeric_limits<float>::max();
+	}
+
+	void ForceField::updateSources() const
+	{
+		PointMassArrays& pm = pointMassArrays;
+		const size_t nbPointMasses = pointMasses.size();
+		pm.x.resize(nbPointMasses); pm.y.resize(nbPointMasses); pm.z.resize(nbPointMasses);
+		pm.mass.resize(nbPointMasses);
+		pm.sqrOffset.resize(nbPointMasses);
+		pm.sqrRange.resize(nbPointMasses);
+		for (size_t i = 0; i < nbPointMasses; ++i)
+		{
+			const PointMassDef& def = pointMasses[i];
+			pm.x[i] = def.tPosition.x; pm.y[i] = def.tPosition.y; pm.z[i] = def.tPosition.z;
+			pm.mass[i] = def.mass;
+			pm.sqrOffset[i] = def.offset * def.offset;
+			pm.sqrRange[i] = getSqrRange(def.range);
+		}
+
+		VortexArrays& vx = vortexArrays;
+		const size_t nbVortices = vortices.size();
+		vx.x.resize(nbVortices); vx.y.resize(nbVortices); vx.z.resize(nbVortices);
+		vx.axisX.resize(nbVortices); vx.axisY.resize(nbVortices); vx.axisZ.resize(nbVortices);
+		vx.rotationStrength.resize(nbVortices);
+		vx.attractionStrength.resize(nbVortices);
+		vx.sqrOffset.resize(nbVortices);
+		vx.sqrRange.resize(nbVortices);
+		for (size_t i = 0; i < nbVortices; ++i)
+		{
+			const VortexDef& def = vortices[i];
+			vx.x[i] = def.tPosition.x; vx.y[i] = def.tPosition.y; vx.z[i] = def.tPosition.z;
+			vx.axisX[i] = def.tAxis.x; vx.axisY[i] = def.tAxis.y; vx.axisZ[i] = def.tAxis.z;
+			vx.rotationStrength[i] = def.rotationStrength;
+			vx.attractionStrength[i] = def.attractionStrength;
+			vx.sqrOffset[i] = def.offset * def.offset;
+			vx.sqrRange[i] = getSqrRange(def.range);
+		}
+
+		DirectionalForceArrays& df = directionalForceArrays;
+		const size_t nbDirectionalForces = directionalForces.size();
+		df.x.resize(nbDirectionalForces); df.y.resize(nbDirectionalForces); df.z.resize(nbDirectionalForces);
+		df.forceX.resize(nbDirectionalForces); df.forceY.resize(nbDirectionalForces); df.forceZ.resize(nbDirectionalForces);
+		df.sqrRange.resize(nbDirectionalForces);
+		for (size_t i = 0; i < nbDirectionalForces; ++i)
+		{
+			const DirectionalForceDef& def = directionalForces[i];
+			df.x[i] = def.tPosition.x; df.y[i] = def.tPosition.y; df.z[i] = def.tPosition.z;
+			df.forceX[i] = def.tForce.x; df.forceY[i] = def.tForce.y; df.forceZ[i] = def.tForce.z;
+			df.sqrRange[i] = getSqrRange(def.range);
+		}
+
+		updateGrid();
+		sourcesDirty = false;
+	}
+
+	void ForceField::updateGrid() const
+	{
+		// Gets the bounding sphere of every source
+		const size_t nbSources = pointMasses.size() + vortices.size() + directionalForces.size();
+		sourceCenters.resize(nbSources);
+		sourceRanges.resize(nbSources);
+		sourceTypes.resize(nbSources);
+		sourceIndices.resize(nbSources);
+
+		size_t source = 0;
+		for (size_t i = 0; i < pointMasses.size(); ++i, ++source)
+		{
+			sourceCenters[source] = pointMasses[i].tPosition;
+			sourceRanges[source] = pointMasses[i].range;
+			sourceTypes[source] = SOURCE_POINT_MASS;
+			sourceIndices[source] = i;
+		}
+		for (size_t i = 0; i < vortices.size(); ++i, ++source)
+		{
+			sourceCenters[source] = vortices[i].tPosition;
+			sourceRanges[source] = vortices[i].range;
+			sourceTypes[source] = SOURCE_VORTEX;
+			sourceIndices[source] = i;
+		}
+		for (size_t i = 0; i < directionalForces.size(); ++i, ++source)
+		{
+			sourceCenters[source] = directionalForces[i].tPosition;
+			sourceRanges[source] = directionalForces[i].range;
+			sourceTypes[source] = SOURCE_DIRECTIONAL_FORCE;
+			sourceIndices[source] = i;
+		}
+
+		// Computes the bounds of the grid from the sources with a finite range
+		bool hasFiniteSources = false;
+		Vector3D gridMax;
+		for (size_t i = 0; i < nbSources; ++i)
+			if (sourceRanges[i] > 0.0f)
+			{
+				Vector3D sourceMin = sourceCenters[i] - sourceRanges[i];
+				Vector3D sourceMax = sourceCenters[i] + sourceRanges[i];
+				if (!hasFiniteSources)
+				{
+					gridMin = sourceMin;
+					gridMax = sourceMax;
+					hasFiniteSources = true;
+				}
+				else
+				{
+					gridMin.setMin(sourceMin);
+					gridMax.setMax(sourceMax);
+				}
+			}
+
+		size_t nbGridCells = 0;
+		if (cullingCellSize > 0.0f && hasFiniteSources)
+		{
+			nbGridCells = 1;
+			for (size_t i = 0; i < 3; ++i)
+			{
+				float extent = gridMax[i] - gridMin[i];
+				size_t dimension = static_cast<size_t>(std::ceil(extent / cullingCellSize));
+				if (dimension < 1) dimension = 1;
+				if (dimension > MAX_CELLS_PER_AXIS) dimension = MAX_CELLS_PER_AXIS;
+				gridDimensions[i] = dimension;
+				gridInvCellSize[i] = extent > 0.0f ? dimension / extent : 0.0f;
+				nbGridCells *= dimension;
+			}
+		}
+		else
+			gridDimensions[0] = gridDimensions[1] = gridDimensions[2] = 0;
+
+		// Fills the cells with a counting sort (the last cell is the one outside the grid)
+		// The first pass counts the sources of each list and the second one scatters them
+		// cellOffsets is used as insertion cursors during the second pass and is shifted back afterwards
+		const size_t nbCells = nbGridCells + 1;
+		const size_t nbLists = nbCells * NB_SOURCE_TYPES;
+		cellOffsets.assign(nbLists + 1,0);
+
+		for (size_t pass = 0; pass < 2; ++pass)
+		{
+			if (pass == 1)
+			{
+				for (size_t i = 0; i < nbLists; ++i)
+					cellOffsets[i + 1] += cellOffsets[i];
+				cellSources.resize(cellOffsets[nbLists]);
+			}
+
+			for (size_t i = 0; i < nbSources; ++i)
+			{
+				if (nbGridCells == 0 || sourceRanges[i] <= 0.0f)
+				{
+					// Sources with an infinite range or all sources when culling is disabled are in all cells
+					for (size_t j = 0; j < nbCells; ++j)
+					{
+						const size_t list = j * NB_SOURCE_TYPES + sourceTypes[i];
+						if (pass == 0)
+							++cellOffsets[list + 1];
+						else
+							cellSources[cellOffsets[list]++] = sourceIndices[i];
+					}
+				}
+				else
+				{
+					size_t cellMin[3];
+					size_t cellMax[3];
+					for (size_t j = 0; j < 3; ++j)
+					{
+						float minCoord = (sourceCenters[i][j] - sourceRanges[i] - gridMin[j]) * gridInvCellSize[j];
+						float maxCoord = (sourceCenters[i][j] + sourceRanges[i] - gridMin[j]) * gridInvCellSize[j];
+						cellMin[j] = minCoord <= 0.0f ? 0 : static_cast<size_t>(minCoord);
+						cellMax[j] = maxCoord <= 0.0f ? 0 : static_cast<size_t>(maxCoord);
+						if (cellMin[j] >= gridDimensions[j]) cellMin[j] = gridDimensions[j] - 1;
+						if (cellMax[j] >= gridDimensions[j]) cellMax[j] = gridDimensions[j] - 1;
+					}
+
+					for (size_t z = cellMin[2]; z <= cellMax[2]; ++z)
+						for (size_t y = cellMin[1]; y <= cellMax[1]; ++y)
+							for (size_t x = cellMin[0]; x <= cellMax[0]; ++x)
+							{
+								const size_t list = (x + gridDimensions[0] * (y + gridDimensions[1] * z)) * NB_SOURCE_TYPES + sourceTypes[i];
+								if (pass == 0)
+									++cellOffsets[list + 1];
+								else
+									cellSources[cellOffsets[list]++] = sourceIndices[i];
+							}
+				}
+			}
+		}
+
+		for (size_t i = nbLists; i > 0; --i)
+			cellOffsets[i] = cellOffsets[i - 1];
+		cellOffsets[0] = 0;
+	}
+
+	size_t ForceField::getCellIndex(const Vector3D& pos) const
+	{
+		const size_t outsideCell = gridDimensions[0] * gridDimensions[1] * gridDimensions[2];
+		if (outsideCell == 0)
+			return 0;
+
+		size_t cell[3];
+		for (size_t i = 0; i < 3; ++i)
+		{
+			float coord = (pos[i] - gridMin[i]) * gridInvCellSize[i];
+			if (coord < 0.0f)
+				return outsideCell;
+			cell[i] = static_cast<size_t>(coord);
+			if (cell[i] >= gridDimensions[i])
+				return outsideCell;
+		}
+
+		return cell[0] + gridDimensions[0] * (cell[1] + gridDimensions[1] * cell[2]);
+	}
+
+	void ForceField::accumulatePointMasses(Vector3D& force,const Vector3D& pos,const size_t* indices,size_t nb) const
+	{
+		const PointMassArrays& pm = pointMassArrays;
+		float fx = 0.0f, fy = 0.0f, fz = 0.0f;
+		for (size_t k = 0; k < nb; ++k)
+		{
+			const size_t i = indices[k];
+			float dx = pm.x[i] - pos.x;
+			float dy = pm.y[i] - pos.y;
+			float dz = pm.z[i] - pos.z;
+			float sqrDist = dx * dx + dy * dy + dz * dz;
+			float factor = sqrDist <= pm.sqrRange[i] ? pm.mass[i] / (sqrDist + pm.sqrOffset[i]) : 0.0f;
+			fx += dx * factor;
+			fy += dy * factor;
+			fz += dz * factor;
+		}
+		force.x += fx;
+		force.y += fy;
+		force.z += fz;
+	}
+
+	void ForceField::accumulateVortices(Vector3D& force,const Vector3D& pos,const size_t* indices,size_t nb) const
+	{
+		const VortexArrays& vx = vortexArrays;
+		float fx = 0.0f, fy = 0.0f, fz = 0.0f;
+		for (size_t k = 0; k < nb; ++k)
+		{
+			const size_t i = indices[k];
+			float dx = pos.x - vx.x[i];
+			float dy = pos.y - vx.y[i];
+			float dz = pos.z - vx.z[i];
+			float sqrDist = dx * dx + dy * dy + dz * dz;
+
+			// Projects the particle on the plane orthogonal to the axis
+			float along = dx * vx.axisX[i] + dy * vx.axisY[i] + dz * vx.axisZ[i];
+			float px = dx - vx.axisX[i] * along;
+			float py = dy - vx.axisY[i] * along;
+			float pz = dz - vx.axisZ[i] * along;
+			float sqrAxisDist = px * px + py * py + pz * pz;
+
+			float factor = sqrDist <= vx.sqrRange[i] ? 1.0f / (sqrAxisDist + vx.sqrOffset[i]) : 0.0f;
+			float rotation = vx.rotationStrength[i] * factor;
+			float attraction = vx.attractionStrength[i] * factor;
+
+			// tangent = axis x projection
+			fx += (vx.axisY[i] * pz - vx.axisZ[i] * py) * rotation - px * attraction;
+			fy += (vx.axisZ[i] * px - vx.axisX[i] * pz) * rotation - py * attraction;
+			fz += (vx.axisX[i] * py - vx.axisY[i] * px) * rotation - pz * attraction;
+		}
+		force.x += fx;
+		force.y += fy;
+		force.z += fz;
+	}
+
+	void ForceField::accumulateDirectionalForces(Vector3D& force,const Vector3D& pos,const size_t* indices,size_t nb) const
+	{
+		const DirectionalForceArrays& df = directionalForceArrays;
+		float fx = 0.0f, fy = 0.0f, fz = 0.0f;
+		for (size_t k = 0; k < nb; ++k)
+		{
+			const size_t i = indices[k];
+			float dx = df.x[i] - pos.x;
+			float dy = df.y[i] - pos.y;
+			float dz = df.z[i] - pos.z;
+			float factor = dx * dx + dy * dy + dz * dz <= df.sqrRange[i] ? 1.0f : 0.0f;
+			fx += df.forceX[i] * factor;
+			fy += df.forceY[i] * factor;
+			fz += df.forceZ[i] * factor;
+		}
+		force.x += fx;
+		force.y += fy;
+		force.z += fz;
+	}
+
+	void ForceField::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		if (sourcesDirty)
+			updateSources();
+
+		if (cellSources.empty())
+			return;
+
+		const size_t* sources = &cellSources[0];
+		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		{
+			Particle& particle = *particleIt;
+			const size_t* offsets = &cellOffsets[getCellIndex(particle.position()) * NB_SOURCE_TYPES];
+
+			Vector3D force;
+			accumulatePointMasses(force,particle.position(),sources + offsets[SOURCE_POINT_MASS],offsets[SOURCE_POINT_MASS + 1] - offsets[SOURCE_POINT_MASS]);
+			accumulateVortices(force,particle.position(),sources + offsets[SOURCE_VORTEX],offsets[SOURCE_VORTEX + 1] - offsets[SOURCE_VORTEX]);
+			accumulateDirectionalForces(force,particle.position(),sources + offsets[SOURCE_DIRECTIONAL_FORCE],offsets[SOURCE_DIRECTIONAL_FORCE + 1] - offsets[SOURCE_DIRECTIONAL_FORCE]);
+
+			particle.velocity() += force * deltaTime;
+		}
+	}
+}
@@ -0,0 +1,228 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <SPARK_Core.h>
+#include "Extensions/Modifiers/SPK_GroupCollider.h"
+#include "Extensions/Modifiers/SPK_CollisionResponse.h"
+
+namespace SPK
+{
+	GroupCollider::GroupCollider(float elasticity) :
+		Modifier(MODIFIER_PRIORITY_COLLISION,false,false,false),
+		nbUpdatedGroups(0)
+	{
+		setElasticity(elasticity);
+	}
+
+	GroupCollider::GroupCollider(const GroupCollider& collider) :
+		Modifier(collider),
+		elasticity(collider.elasticity),
+		groups(),
+		nbUpdatedGroups(0)
+	{}
+
+	GroupCollider::~GroupCollider(){}
+
+	void GroupCollider::setElasticity(float elasticity)
+	{
+		if (elasticity < 0.0f)
+		{
+			SPK_LOG_WARNING("GroupCollider::setElasticity(float) - The elasticity cannot be negative, 1.0f is set")
+			elasticity = 1.0f;
+		}
+
+		this->elasticity = elasticity;
+	}
+
+	void GroupCollider::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		size_t groupIndex = findGroup(group);
+
+		if (groupIndex == groups.size()) // The group joins the set
+		{
+			groups.push_back(&group);
+			updatedGroups.push_back(0);
+		}
+		else if (updatedGroups[groupIndex] != 0)
+		{
+			// A group calling twice means that some groups of the set were not updated during the last step
+			// They are removed from the set as they may not exist anymore
+			size_t nbGroups = 0;
+			for (size_t i = 0; i < groups.size(); ++i)
+				if (updatedGroups[i] != 0)
+					groups[nbGroups++] = groups[i];
+			groups.resize(nbGroups);
+
+			resolveCollisions();
+			updatedGroups.assign(groups.size(),0);
+			nbUpdatedGroups = 0;
+			groupIndex = findGroup(group);
+		}
+
+		updatedGroups[groupIndex] = 1;
+		if (++nbUpdatedGroups == groups.size() && groups.size() > 1)
+		{
+			resolveCollisions();
+			updatedGroups.assign(groups.size(),0);
+			nbUpdatedGroups = 0;
+		}
+	}
+
+	size_t GroupCollider::findGroup(const Group& group) const
+	{
+		size_t groupIndex = 0;
+		while (groupIndex < groups.size() && groups[groupIndex] != &group)
+			++groupIndex;
+		return groupIndex;
+	}
+
+	void GroupCollider::resolveCollisions() const
+	{
+		if (groups.size() < 2)
+			return;
+
+		buildGrid();
+
+		const size_t nbParticles = groupStarts.back();
+		if (nbParticles < 2)
+			return;
+
+		for (size_t index0 = 0; index0 < nbParticles; ++index0)
+		{
+			const size_t group0 = particleGroups[index0];
+			if (group0 == 0)
+				continue; // Pairs are resolved from the particles of the group with the higher index
+
+			Particle particle0 = groups[group0]->getParticle(index0 - groupStarts[group0]);
+			const float radius0 = particleRadii[index0];
+
+			// Gets the range of the cells around the particle
+			size_t minX,minY,minZ,maxX,maxY,maxZ;
+			grid.getNeighborCells(grid.getCell(index0),minX,minY,minZ,maxX,maxY,maxZ);
+
+			for (size_t z = minZ; z <= maxZ; ++z) // For each neighboring cell in the grid
+				for (size_t y = minY; y <= maxY; ++y)
+					for (size_t x = minX; x <= maxX; ++x)
+					{
+						const size_t neighborCell = grid.getCellIndex(x,y,z);
+						const size_t end = grid.getCellEnd(neighborCell);
+
+						for (size_t j = grid.getCellStart(neighborCell); j < end; ++j) // for each particles in the cell
+						{
+							size_t index1 = grid.getSortedIndex(j);
+							if (index1 >= groupStarts[group0])
+								break; // as particles are ordered, the next ones belong to the same group or to groups with higher indices
+
+							const size_t group1 = particleGroups[index1];
+							Particle particle1 = groups[group1]->getParticle(index1 - groupStarts[group1]);
+							collide(particle0,particle1,radius0,particleRadii[index1]);
+						}
+					}
+		}
+	}
+
+	void GroupCollider::buildGrid() const
+	{
+		// Numbers the particles of all the groups
+		groupStarts.resize(groups.size() + 1);
+		groupStarts[0] = 0;
+		for (size_t i = 0; i < groups.size(); ++i)
+			groupStarts[i + 1] = groupStarts[i] + groups[i]->getNbParticles();
+
+		const size_t nbParticles = groupStarts.back();
+		if (nbParticles < 2)
+			return;
+
+		particleGroups.resize(nbParticles);
+		particleRadii.resize(nbParticles);
+		particlePositions.resize(nbParticles);
+
+		// Gathers the particles of all the groups and computes the biggest radius
+		float maxRadius = 0.0f;
+		for (size_t i = 0; i < groups.size(); ++i)
+		{
+			const Group& group = *groups[i];
+			for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+			{
+				const Particle& particle = *particleIt;
+				const size_t index = groupStarts[i] + particle.getIndex();
+
+				particleGroups[index] = i;
+				particlePositions[index] = particle.position();
+				particleRadii[index] = particle.getRadius();
+				if (particleRadii[index] > maxRadius)
+					maxRadius = particleRadii[index];
+			}
+		}
+
+		// Cells are as large as the diameter of the biggest particle so that colliding particles are in neighboring cells
+		// As the sort is stable, particles are ordered by group then by index within a cell
+		grid.build(&particlePositions[0],nbParticles,2.0f * maxRadius,MAX_CELLS_PER_PARTICLE,MAX_CELLS_PER_AXIS);
+	}
+
+	void GroupCollider::collide(Particle& particle0,Particle& particle1,float radius0,float radius1) const
+	{
+		float sqrRadius = radius0 + radius1;
+		sqrRadius *= sqrRadius;
+
+		// Gets the normal of the collision plane
+		Vector3D normal = particle0.position() - particle1.position();
+		float sqrDist = normal.getSqrNorm();
+
+		if (sqrDist >= sqrRadius) // particles are not intersecting each other
+			return;
+
+		Vector3D delta = particle0.velocity() - particle1.velocity();
+		if (dotProduct(normal,delta) >= 0.0f) // particles are not moving towards each other
+			return;
+
+		float oldSqrDist = getSqrDist(particle0.oldPosition(),particle1.oldPosition());
+		if (oldSqrDist > sqrDist)
+		{
+			// Disables the move from this frame
+			particle0.position() = particle0.oldPosition();
+			particle1.position() = particle1.oldPosition();
+
+			normal = particle0.position() - particle1.position();
+
+			if (dotProduct(normal,delta) >= 0.0f)
+				return;
+		}
+
+		normal.normalize();
+
+		// Gets the normal components of the velocities
+		Vector3D normal0 = normal * dotProduct(normal,particle0.velocity());
+		Vector3D normal1 = normal * dotProduct(normal,particle1.velocity());
+
+		// Resolves collision
+		// Both changes are computed before being applied, the same way as in the Collider
+		float m0 = particle0.getParam(PARAM_MASS);
+		float m1 = particle1.getParam(PARAM_MASS);
+		bool overlapping = oldSqrDist < sqrRadius;
+
+		Vector3D deltaVelocity0 = computeCollisionDeltaVelocity(normal,normal0,normal1,m0,m1,elasticity,overlapping);
+		Vector3D deltaVelocity1 = computeCollisionDeltaVelocity(-normal,normal1,normal0,m1,m0,elasticity,overlapping);
+
+		particle0.velocity() += deltaVelocity0;
+		particle1.velocity() += deltaVelocity1;
+	}
+}
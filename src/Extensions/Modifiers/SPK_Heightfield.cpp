@@ -0,0 +1,199 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <limits> // for max float value
+
+#include <SPARK_Core.h>
+#include "Extensions/Modifiers/SPK_Heightfield.h"
+
+namespace SPK
+{
+	Heightfield::Heightfield(const Vector3D& boundsMin,const Vector3D& boundsMax,float bouncingRatio,float friction) :
+		Modifier(MODIFIER_PRIORITY_COLLISION,false,false,false),
+		grid(2,1),
+		bouncingRatio(bouncingRatio),
+		friction(friction)
+	{
+		setBounds(boundsMin,boundsMax);
+	}
+
+	Heightfield::Heightfield(const Heightfield& heightfield) :
+		Modifier(heightfield),
+		grid(heightfield.grid),
+		boundsMin(heightfield.boundsMin),
+		boundsMax(heightfield.boundsMax),
+		bouncingRatio(heightfield.bouncingRatio),
+		friction(heightfield.friction)
+	{
+		innerUpdateTransform();
+	}
+
+	void Heightfield::setGrid(size_t width,size_t depth,const float* heights)
+	{
+		const size_t dimensions[2] = {width,depth};
+		if (!grid.setData(dimensions,heights))
+		{
+			SPK_LOG_ERROR("Heightfield::setGrid(size_t,size_t,const float*) - The grid is empty or has no data. The grid is not set");
+			return;
+		}
+
+		innerUpdateTransform();
+	}
+
+	void Heightfield::setExternalGrid(size_t width,size_t depth,const float* heights)
+	{
+		const size_t dimensions[2] = {width,depth};
+		if (!grid.setExternalData(dimensions,heights))
+		{
+			SPK_LOG_ERROR("Heightfield::setExternalGrid(size_t,size_t,const float*) - The grid is empty or has no data. The grid is not set");
+			return;
+		}
+
+		innerUpdateTransform();
+	}
+
+	bool Heightfield::loadFromFile(const std::string& path)
+	{
+		if (!grid.loadFromFile(path))
+			return false;
+
+		innerUpdateTransform();
+		return true;
+	}
+
+	void Heightfield::innerUpdateTransform()
+	{
+		transformPos(tOrigin,boundsMin);
+
+		// Edges of the box in world space
+		const Vector3D extent = boundsMax - boundsMin;
+		Vector3D edges[3];
+		transformDir(edges[0],Vector3D(extent.x,0.0f,0.0f));
+		transformDir(edges[1],Vector3D(0.0f,extent.y,0.0f));
+		transformDir(edges[2],Vector3D(0.0f,0.0f,extent.z));
+		tUp = edges[1];
+
+		if (!FieldGrid::computeBoxRows(edges,tGridRows)) // Flat box, the terrain cannot be sampled
+			return;
+
+		// Scales from [0,1] to grid coordinates along x and z, the y coordinate being a height
+		if (grid.getDimension(0) > 1)
+			tGridRows[0] *= static_cast<float>(grid.getDimension(0) - 1);
+		if (grid.getDimension(1) > 1)
+			tGridRows[2] *= static_cast<float>(grid.getDimension(1) - 1);
+	}
+
+	float Heightfield::sampleGrid(const Vector3D& pos,Vector3D* normal) const
+	{
+		const Vector3D offset = pos - tOrigin;
+
+		float coords[2];
+		size_t indices[2];
+		size_t steps[2];
+		for (size_t i = 0; i < 2; ++i)
+		{
+			const float coord = dotProduct(tGridRows[i << 1],offset); // rows 0 and 2
+			const float maxCoord = static_cast<float>(grid.getDimension(i) - 1);
+			if (coord < 0.0f || coord > maxCoord) // Out of the footprint of the grid
+				return -std::numeric_limits<float>::max();
+
+			indices[i] = static_cast<size_t>(coord);
+			if (grid.getDimension(i) > 1 && indices[i] >= grid.getDimension(i) - 1)
+				indices[i] = grid.getDimension(i) - 2;
+
+			coords[i] = coord - indices[i];
+			steps[i] = grid.getDimension(i) > 1 ? 1 : 0;
+		}
+
+		// Bilinear interpolation of the 4 surrounding nodes
+		const float* n00 = grid.getData() + indices[0] + indices[1] * grid.getDimension(0);
+		const float h00 = n00[0];
+		const float h10 = n00[steps[0]];
+		const float h01 = n00[steps[1] * grid.getDimension(0)];
+		const float h11 = n00[steps[1] * grid.getDimension(0) + steps[0]];
+
+		const float h0 = h00 + (h10 - h00) * coords[0];
+		const float h1 = h01 + (h11 - h01) * coords[0];
+		const float height = h0 + (h1 - h0) * coords[1];
+
+		if (normal != NULL)
+		{
+			// The normal is the gradient of the height above the terrain in world space
+			const float slopeX = (h10 - h00) + ((h11 - h01) - (h10 - h00)) * coords[1];
+			const float slopeZ = h1 - h0;
+			*normal = tGridRows[1] - tGridRows[0] * slopeX - tGridRows[2] * slopeZ;
+			normal->normalize();
+		}
+
+		return height - dotProduct(tGridRows[1],offset);
+	}
+
+	void Heightfield::checkBatch(const Vector3D* positions,size_t nb,float* depths,unsigned char* mask) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			depths[i] = sampleGrid(positions[i],NULL);
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = depths[i] > 0.0f ? 1 : 0;
+	}
+
+	void Heightfield::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		if (grid.getData() == NULL)
+			return;
+
+		const Vector3D* positions = static_cast<const Vector3D*>(group.getPositionAddress());
+
+		Vector3D normal;
+		float depths[BATCH_SIZE];
+		unsigned char mask[BATCH_SIZE];
+		for (size_t begin = 0; begin < group.getNbParticles(); begin += BATCH_SIZE)
+		{
+			// The particles are first checked by batch and the normal is only computed for the ones under the terrain
+			const size_t nb = group.getNbParticles() - begin < BATCH_SIZE ? group.getNbParticles() - begin : BATCH_SIZE;
+			checkBatch(positions + begin,nb,depths,mask);
+			for (size_t i = 0; i < nb; ++i)
+			{
+				if (mask[i] == 0)
+					continue;
+
+				Particle particle = group.getParticle(begin + i);
+				sampleGrid(particle.position(),&normal);
+
+				if (sampleGrid(particle.oldPosition(),NULL) > 0.0f)
+					particle.position() += tUp * depths[i]; // Lifts the particle onto the terrain
+				else
+					particle.position() = particle.oldPosition();
+
+				Vector3D& velocity = particle.velocity();
+
+				float dist = dotProduct(velocity,normal);
+
+				normal *= dist - 0.001f;
+				velocity -= normal;			// tangent component
+				velocity *= friction;
+				normal *= bouncingRatio;	// normal component
+				if (dist > 0.0f)
+					normal.revert();
+				velocity -= normal;
+			}
+		}
+	}
+}
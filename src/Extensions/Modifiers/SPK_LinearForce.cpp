@@ -130,66 +130,112 @@ namespace SPK
 		return discreteFactor;
 	}
 
-	void LinearForce::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	bool LinearForce::isFactorByParticle(const Group& group) const
 	{
 		// Optimization to compute the factor only if needed
-		bool factorByParticle = true;
 		if ((factor == FACTOR_CONSTANT || !group.isEnabled(param)) && !group.isEnabled(PARAM_MASS)) // no factor, no mass
-			factorByParticle = false;
+			return false;
 		if (param == PARAM_MASS && factor == FACTOR_LINEAR) // gravity type force
-			factorByParticle = false;
+			return false;
+		return true;
+	}
 
+	float LinearForce::getRealCoef(const Group& group) const
+	{
 		// if the param is scale, it is assumed that it is the size that matters, therefore the coef is multiplied by the physical radius
 		float realCoef = coef;
 		if (param == PARAM_SCALE)
 			for (int i = 0; i < factor; ++i)
 				realCoef *= group.getPhysicalRadius();
+		return realCoef;
+	}
+
+	bool LinearForce::isFusable(const Group& group) const
+	{
+		// Only forces that are the same for every particle can be fused
+		return getZoneTest() == ZONE_TEST_ALWAYS && !squaredSpeed && !isFactorByParticle(group);
+	}
+
+	void LinearForce::getFusedForce(FusedForce& force,const Group& group,float deltaTime) const
+	{
+		const float discreteFactor = deltaTime * getRealCoef(group);
 
+		force.type = FusedForce::FUSED_FORCE_AFFINE;
 		if (!relative)
 		{
-			const Vector3D discreteForce = tValue * deltaTime * realCoef;
-
-			if (!factorByParticle)
-			{
-				for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
-					if (checkZone(*particleIt))
-						particleIt->velocity() += discreteForce;
-			}
-			else
-			{
-				for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
-					if (checkZone(*particleIt))
-						particleIt->velocity() += discreteForce * getDiscreteFactor(*particleIt);
-			}
+			force.vector = tValue * discreteFactor;
+			force.scale = 1.0f;
 		}
 		else
 		{
-			for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
-				if (checkZone(*particleIt))
-				{
-					Particle& particle = *particleIt;
-					Vector3D relativeForce = tValue - particle.velocity();
+			// velocity += (value - velocity) * factor with the factor clamped to 1
+			const float clampedFactor = discreteFactor > 1.0f ? 1.0f : discreteFactor;
+			force.vector = tValue * clampedFactor;
+			force.scale = 1.0f - clampedFactor;
+		}
+	}
 
-					float clamp = 1.0f;
-					if (squaredSpeed)
-					{
-						Vector3D absForce(relativeForce);
-						absForce.abs();
-						clamp = 1.0f / absForce.getMax();
-						relativeForce *= relativeForce;
-					}
+	void LinearForce::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		const bool factorByParticle = isFactorByParticle(group);
+		const float realCoef = getRealCoef(group);
 
-					float discreteFactor = deltaTime * realCoef;
-					if (factorByParticle)
-						discreteFactor *= getDiscreteFactor(particle);
+		const Vector3D discreteForce = tValue * deltaTime * realCoef;
+		unsigned char mask[ZONE_BATCH_SIZE];
 
-					// the factor is clamped due to the use of a discrete time.
-					// this is to prevent odd behaviours like the air drag being so strong that particle starts going towards the opposite direction.
-					if (discreteFactor > clamp)
-						discreteFactor = clamp;
+		// The zone is tested per chunk of particles to keep the zone test out of the loops below
+		for (size_t begin = 0; begin < group.getNbParticles(); begin += ZONE_BATCH_SIZE)
+		{
+			const size_t nb = group.getNbParticles() - begin < ZONE_BATCH_SIZE ? group.getNbParticles() - begin : ZONE_BATCH_SIZE;
+			checkZoneBatch(group,begin,nb,mask);
 
-					particle.velocity() += relativeForce * discreteFactor;
+			if (!relative)
+			{
+				if (!factorByParticle)
+				{
+					for (size_t i = 0; i < nb; ++i)
+						if (mask[i] != 0)
+							group.getParticle(begin + i).velocity() += discreteForce;
 				}
+				else
+				{
+					for (size_t i = 0; i < nb; ++i)
+						if (mask[i] != 0)
+						{
+							Particle particle = group.getParticle(begin + i);
+							particle.velocity() += discreteForce * getDiscreteFactor(particle);
+						}
+				}
+			}
+			else
+			{
+				for (size_t i = 0; i < nb; ++i)
+					if (mask[i] != 0)
+					{
+						Particle particle = group.getParticle(begin + i);
+						Vector3D relativeForce = tValue - particle.velocity();
+
+						float clamp = 1.0f;
+						if (squaredSpeed)
+						{
+							Vector3D absForce(relativeForce);
+							absForce.abs();
+							clamp = 1.0f / absForce.getMax();
+							relativeForce *= relativeForce;
+						}
+
+						float discreteFactor = deltaTime * realCoef;
+						if (factorByParticle)
+							discreteFactor *= getDiscreteFactor(particle);
+
+						// the factor is clamped due to the use of a discrete time.
+						// this is to prevent odd behaviours like the air drag being so strong that particle starts going towards the opposite direction.
+						if (discreteFactor > clamp)
+							discreteFactor = clamp;
+
+						particle.velocity() += relativeForce * discreteFactor;
+					}
+			}
 		}
 	}
 }
@@ -0,0 +1,239 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath> // for std::abs
+
+#include <SPARK_Core.h>
+#include "Extensions/Modifiers/SPK_MutualGravity.h"
+
+namespace SPK
+{
+	MutualGravity::MutualGravity(float mass,float offset,float openingAngle) :
+		Modifier(MODIFIER_PRIORITY_FORCE,false,false,false),
+		mass(mass)
+	{
+		setOffset(offset);
+		setOpeningAngle(openingAngle);
+	}
+
+	MutualGravity::MutualGravity(const MutualGravity& mutualGravity) :
+		Modifier(mutualGravity),
+		mass(mutualGravity.mass),
+		offset(mutualGravity.offset),
+		openingAngle(mutualGravity.openingAngle)
+	{}
+
+	void MutualGravity::setOffset(float offset)
+	{
+		if (offset <= 0.0f)
+		{
+			SPK_LOG_WARNING("MutualGravity::setOffset(float) - Offset must be superior to 0. Offset is set to 0.01f");
+			offset = 0.01f;
+		}
+
+		this->offset = offset;
+	}
+
+	void MutualGravity::setOpeningAngle(float openingAngle)
+	{
+		if (openingAngle < 0.0f)
+		{
+			SPK_LOG_WARNING("MutualGravity::setOpeningAngle(float) - The opening angle cannot be negative. It is set to 0");
+			openingAngle = 0.0f;
+		}
+
+		this->openingAngle = openingAngle;
+	}
+
+	void MutualGravity::buildTree(const Group& group) const
+	{
+		const size_t nbParticles = group.getNbParticles();
+		const bool massEnabled = group.isEnabled(PARAM_MASS);
+
+		positions.resize(nbParticles);
+		masses.resize(nbParticles);
+		indices.resize(nbParticles);
+		tmpIndices.resize(nbParticles);
+
+		Vector3D AABBMin(group.getParticle(0).position());
+		Vector3D AABBMax(AABBMin);
+		for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		{
+			size_t index = particleIt->getIndex();
+			positions[index] = particleIt->position();
+			masses[index] = massEnabled ? mass * particleIt->getParamNC(PARAM_MASS) : mass;
+			indices[index] = index;
+			AABBMin.setMin(positions[index]);
+			AABBMax.setMax(positions[index]);
+		}
+
+		// The root cell is the cube bounding all particles
+		Vector3D size = AABBMax - AABBMin;
+		Node root;
+		root.center = (AABBMin + AABBMax) * 0.5f;
+		root.halfSize = size.getMax() * 0.5f + 0.001f;
+		root.begin = 0;
+		root.end = nbParticles;
+
+		nodes.clear();
+		nodes.push_back(root);
+		buildNode(0,0);
+
+		// Particle data are stored in tree order so that cells are contiguous in memory
+		sortedPositions.resize(nbParticles);
+		sortedMasses.resize(nbParticles);
+		for (size_t i = 0; i < nbParticles; ++i)
+		{
+			sortedPositions[i] = positions[indices[i]];
+			sortedMasses[i] = masses[indices[i]];
+		}
+	}
+
+	inline size_t MutualGravity::getOctant(const Vector3D& center,const Vector3D& pos)
+	{
+		return (pos.x >= center.x ? 1 : 0) | (pos.y >= center.y ? 2 : 0) | (pos.z >= center.z ? 4 : 0);
+	}
+
+	void MutualGravity::buildNode(size_t nodeIndex,size_t depth) const
+	{
+		// Note that the nodes vector may be reallocated within this method, so no reference to a node is kept
+		const Node node = nodes[nodeIndex];
+		float totalMass = 0.0f;
+		float totalWeight = 0.0f;
+		Vector3D massCenter;
+
+		if (node.end - node.begin <= MAX_PARTICLES_PER_LEAF || depth >= MAX_DEPTH)
+		{
+			for (size_t i = node.begin; i < node.end; ++i)
+			{
+				float particleMass = masses[indices[i]];
+				float weight = std::abs(particleMass); // absolute masses are used to locate the center so that repulsive particles are handled
+				totalMass += particleMass;
+				totalWeight += weight;
+				massCenter += positions[indices[i]] * weight;
+			}
+
+			nodes[nodeIndex].leaf = true;
+		}
+		else
+		{
+			// Sorts the particles by octant
+			size_t counts[8] = {0,0,0,0,0,0,0,0};
+			for (size_t i = node.begin; i < node.end; ++i)
+				++counts[getOctant(node.center,positions[indices[i]])];
+
+			size_t starts[8];
+			size_t offsets[8];
+			starts[0] = offsets[0] = node.begin;
+			for (size_t i = 1; i < 8; ++i)
+				starts[i] = offsets[i] = offsets[i - 1] + counts[i - 1];
+
+			for (size_t i = node.begin; i < node.end; ++i)
+				tmpIndices[offsets[getOctant(node.center,positions[indices[i]])]++] = indices[i];
+			for (size_t i = node.begin; i < node.end; ++i)
+				indices[i] = tmpIndices[i];
+
+			// Creates the children
+			const float childHalfSize = node.halfSize * 0.5f;
+			const size_t firstChild = nodes.size();
+			for (size_t i = 0; i < 8; ++i)
+				if (counts[i] > 0)
+				{
+					Node child;
+					child.center.set(
+						node.center.x + ((i & 1) != 0 ? childHalfSize : -childHalfSize),
+						node.center.y + ((i & 2) != 0 ? childHalfSize : -childHalfSize),
+						node.center.z + ((i & 4) != 0 ? childHalfSize : -childHalfSize));
+					child.halfSize = childHalfSize;
+					child.begin = starts[i];
+					child.end = starts[i] + counts[i];
+					nodes.push_back(child);
+				}
+			const size_t lastChild = nodes.size();
+
+			for (size_t i = firstChild; i < lastChild; ++i)
+			{
+				buildNode(i,depth + 1);
+				float weight = std::abs(nodes[i].mass);
+				totalMass += nodes[i].mass;
+				totalWeight += weight;
+				massCenter += nodes[i].massCenter * weight;
+			}
+
+			nodes[nodeIndex].leaf = false;
+			nodes[nodeIndex].begin = firstChild;
+			nodes[nodeIndex].end = lastChild;
+		}
+
+		nodes[nodeIndex].mass = totalMass;
+		nodes[nodeIndex].massCenter = totalWeight > 0.0f ? massCenter / totalWeight : node.center;
+	}
+
+	Vector3D MutualGravity::computeForce(const Vector3D& pos) const
+	{
+		const float sqrOffset = offset * offset;
+		const float sqrOpeningAngle = openingAngle * openingAngle;
+
+		Vector3D force;
+		size_t stack[MAX_DEPTH * 8];
+		size_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const Node& node = nodes[stack[--stackSize]];
+			if (node.leaf)
+			{
+				// The particle itself is not excluded as its contribution is a null vector
+				for (size_t i = node.begin; i < node.end; ++i)
+				{
+					Vector3D dir = sortedPositions[i] - pos;
+					force += dir * (sortedMasses[i] / (dir.getSqrNorm() + sqrOffset));
+				}
+			}
+			else
+			{
+				Vector3D dir = node.massCenter - pos;
+				float sqrDist = dir.getSqrNorm();
+				float size = node.halfSize * 2.0f;
+				if (size * size < sqrOpeningAngle * sqrDist) // The cell is far enough to be approximated
+					force += dir * (node.mass / (sqrDist + sqrOffset));
+				else
+					for (size_t i = node.begin; i < node.end; ++i)
+						stack[stackSize++] = i;
+			}
+		}
+
+		return force;
+	}
+
+	void MutualGravity::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		if (group.getNbParticles() < 2)
+			return;
+
+		buildTree(group);
+
+		// Particles are processed in tree order so that close particles traverse the tree one after the other
+		for (size_t i = 0; i < indices.size(); ++i)
+			group.getParticle(indices[i]).velocity() += computeForce(sortedPositions[i]) * deltaTime;
+	}
+}
@@ -51,13 +51,24 @@ namespace SPK
 	void Obstacle::modify(Group& group,DataSet* dataSet,float deltaTime) const
 	{
 		Vector3D normal;
-		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		unsigned char mask[ZONE_BATCH_SIZE];
+		for (size_t begin = 0; begin < group.getNbParticles(); begin += ZONE_BATCH_SIZE)
 		{
-			if (checkZone(*particleIt,&normal))
-			{ 
-				particleIt->position() = particleIt->oldPosition();
+			// The particles are first checked by batch and the normal is only computed for the ones that collide
+			const size_t nb = group.getNbParticles() - begin < ZONE_BATCH_SIZE ? group.getNbParticles() - begin : ZONE_BATCH_SIZE;
+			checkZoneBatch(group,begin,nb,mask);
+			for (size_t i = 0; i < nb; ++i)
+			{
+				if (mask[i] == 0)
+					continue;
 
-				Vector3D& velocity = particleIt->velocity();
+				Particle particle = group.getParticle(begin + i);
+				if (!checkZone(particle,&normal))
+					continue;
+
+				particle.position() = particle.oldPosition();
+
+				Vector3D& velocity = particle.velocity();
 
 				float dist = dotProduct(velocity,normal);
 
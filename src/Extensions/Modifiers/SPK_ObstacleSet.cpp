@@ -0,0 +1,311 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm> // for std::nth_element and std::sort
+#include <limits> // for max float value
+
+#include <SPARK_Core.h>
+#include "Extensions/Modifiers/SPK_ObstacleSet.h"
+
+namespace SPK
+{
+	ObstacleSet::ObstacleSet(float bouncingRatio,float friction) :
+		Modifier(MODIFIER_PRIORITY_COLLISION,false,false,false),
+		bouncingRatio(bouncingRatio),
+		friction(friction),
+		hierarchyDirty(true)
+	{}
+
+	ObstacleSet::ObstacleSet(const ObstacleSet& obstacleSet) :
+		Modifier(obstacleSet),
+		zones(),
+		bouncingRatio(obstacleSet.bouncingRatio),
+		friction(obstacleSet.friction),
+		hierarchyDirty(true)
+	{
+		for (std::vector<Ref<Zone> >::const_iterator it = obstacleSet.zones.begin(); it != obstacleSet.zones.end(); ++it)
+			zones.push_back(obstacleSet.copyChild(*it));
+	}
+
+	ObstacleSet::~ObstacleSet(){}
+
+	void ObstacleSet::addZone(const Ref<Zone>& zone)
+	{
+		if (zone)
+		{
+			zones.push_back(zone);
+			hierarchyDirty = true;
+		}
+		else
+			SPK_LOG_WARNING("ObstacleSet::addZone(const Ref<Zone>&) - Cannot add a NULL zone to the obstacle set");
+	}
+
+	void ObstacleSet::removeZone(const Ref<Zone>& zone)
+	{
+		for (std::vector<Ref<Zone> >::iterator it = zones.begin(); it != zones.end(); ++it)
+			if (*it == zone)
+			{
+				zones.erase(it);
+				hierarchyDirty = true;
+				return;
+			}
+
+		SPK_LOG_WARNING("ObstacleSet::removeZone(const Ref<Zone>&) - The zone was not found in the obstacle set and cannot be removed");
+	}
+
+	const Ref<Zone>& ObstacleSet::getZone(size_t index) const
+	{
+		SPK_ASSERT(index < getNbZones(),"ObstacleSet::getZone(size_t) - Zone index is out of bounds : " << index);
+		return zones[index];
+	}
+
+	void ObstacleSet::clearZones()
+	{
+		zones.clear();
+		hierarchyDirty = true;
+	}
+
+	Ref<SPKObject> ObstacleSet::findByName(const std::string& name)
+	{
+		Ref<SPKObject> object = Modifier::findByName(name);
+		if (object) return object;
+
+		for (std::vector<Ref<Zone> >::const_iterator it = zones.begin(); it != zones.end(); ++it)
+		{
+			object = (*it)->findByName(name);
+			if (object) return object;
+		}
+
+		return SPK_NULL_REF;
+	}
+
+	void ObstacleSet::propagateUpdateTransform()
+	{
+		for (std::vector<Ref<Zone> >::const_iterator it = zones.begin(); it != zones.end(); ++it)
+			if (!(*it)->isShared())
+				(*it)->updateTransform(this);
+	}
+
+	bool ObstacleSet::isUnbounded(const Vector3D& boundsMin,const Vector3D& boundsMax)
+	{
+		const float maxValue = std::numeric_limits<float>::max();
+		for (size_t i = 0; i < 3; ++i)
+			if (boundsMin[i] <= -maxValue || boundsMax[i] >= maxValue)
+				return true;
+		return false;
+	}
+
+	void ObstacleSet::computeZoneBounds() const
+	{
+		zoneBoundsMin.resize(zones.size());
+		zoneBoundsMax.resize(zones.size());
+		for (size_t i = 0; i < zones.size(); ++i)
+			zones[i]->computeBounds(zoneBoundsMin[i],zoneBoundsMax[i]);
+	}
+
+	void ObstacleSet::buildHierarchy() const
+	{
+		computeZoneBounds();
+
+		nodes.clear();
+		zoneIndices.clear();
+		unboundedZones.clear();
+
+		for (size_t i = 0; i < zones.size(); ++i)
+			if (isUnbounded(zoneBoundsMin[i],zoneBoundsMax[i]))
+				unboundedZones.push_back(i);
+			else
+				zoneIndices.push_back(i);
+
+		if (!zoneIndices.empty())
+		{
+			nodes.reserve(2 * zoneIndices.size());
+			nodes.push_back(Node());
+			buildNode(0,0,zoneIndices.size());
+		}
+
+		hierarchyDirty = false;
+	}
+
+	void ObstacleSet::buildNode(size_t nodeIndex,size_t begin,size_t end) const
+	{
+		// Computes the bounds of the node and the bounds of the centers of its zones
+		Vector3D boundsMin(zoneBoundsMin[zoneIndices[begin]]);
+		Vector3D boundsMax(zoneBoundsMax[zoneIndices[begin]]);
+		Vector3D centerMin((boundsMin + boundsMax) * 0.5f);
+		Vector3D centerMax(centerMin);
+		for (size_t i = begin + 1; i < end; ++i)
+		{
+			const size_t zoneIndex = zoneIndices[i];
+			boundsMin.setMin(zoneBoundsMin[zoneIndex]);
+			boundsMax.setMax(zoneBoundsMax[zoneIndex]);
+			const Vector3D center((zoneBoundsMin[zoneIndex] + zoneBoundsMax[zoneIndex]) * 0.5f);
+			centerMin.setMin(center);
+			centerMax.setMax(center);
+		}
+
+		nodes[nodeIndex].boundsMin = boundsMin;
+		nodes[nodeIndex].boundsMax = boundsMax;
+
+		if (end - begin <= MAX_ZONES_PER_LEAF)
+		{
+			nodes[nodeIndex].first = begin;
+			nodes[nodeIndex].count = end - begin;
+			return;
+		}
+
+		// Splits at the median along the axis where the centers are the most spread
+		const Vector3D spread(centerMax - centerMin);
+		size_t axis = 0;
+		if (spread.y > spread[axis]) axis = 1;
+		if (spread.z > spread[axis]) axis = 2;
+
+		const size_t middle = begin + (end - begin) / 2;
+		std::nth_element(zoneIndices.begin() + begin,zoneIndices.begin() + middle,zoneIndices.begin() + end,CompareZoneCenter(zoneBoundsMin,zoneBoundsMax,axis));
+
+		const size_t firstChild = nodes.size();
+		nodes.push_back(Node());
+		nodes.push_back(Node());
+		nodes[nodeIndex].first = firstChild;
+		nodes[nodeIndex].count = 0;
+
+		buildNode(firstChild,begin,middle);
+		buildNode(firstChild + 1,middle,end);
+	}
+
+	void ObstacleSet::refitHierarchy() const
+	{
+		computeZoneBounds();
+
+		// Children are always stored after their parent so a reverse traversal refits the nodes bottom up
+		for (size_t i = nodes.size(); i-- > 0;)
+		{
+			Node& node = nodes[i];
+			if (node.count > 0)
+			{
+				node.boundsMin = zoneBoundsMin[zoneIndices[node.first]];
+				node.boundsMax = zoneBoundsMax[zoneIndices[node.first]];
+				for (size_t j = 1; j < node.count; ++j)
+				{
+					node.boundsMin.setMin(zoneBoundsMin[zoneIndices[node.first + j]]);
+					node.boundsMax.setMax(zoneBoundsMax[zoneIndices[node.first + j]]);
+				}
+			}
+			else
+			{
+				node.boundsMin = nodes[node.first].boundsMin;
+				node.boundsMax = nodes[node.first].boundsMax;
+				node.boundsMin.setMin(nodes[node.first + 1].boundsMin);
+				node.boundsMax.setMax(nodes[node.first + 1].boundsMax);
+			}
+		}
+	}
+
+	void ObstacleSet::findCandidates(const Vector3D& segmentMin,const Vector3D& segmentMax) const
+	{
+		candidates.assign(unboundedZones.begin(),unboundedZones.end());
+
+		if (nodes.empty())
+			return;
+
+		size_t stack[MAX_STACK_SIZE];
+		size_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const Node& node = nodes[stack[--stackSize]];
+			if (!overlaps(node.boundsMin,node.boundsMax,segmentMin,segmentMax))
+				continue;
+
+			if (node.count > 0)
+			{
+				for (size_t i = 0; i < node.count; ++i)
+				{
+					const size_t zoneIndex = zoneIndices[node.first + i];
+					if (overlaps(zoneBoundsMin[zoneIndex],zoneBoundsMax[zoneIndex],segmentMin,segmentMax))
+						candidates.push_back(zoneIndex);
+				}
+			}
+			else
+			{
+				// The tree is balanced by the median split so its depth cannot exceed the stack size
+				stack[stackSize++] = node.first;
+				stack[stackSize++] = node.first + 1;
+			}
+		}
+	}
+
+	void ObstacleSet::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		if (zones.empty())
+			return;
+
+		if (hierarchyDirty)
+			buildHierarchy();
+		else
+			refitHierarchy();
+
+		Vector3D normal;
+		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		{
+			Particle& particle = *particleIt;
+			const float radius = particle.getRadius();
+
+			// Bounds of the swept sphere between the old and the current position
+			Vector3D segmentMin(particle.oldPosition());
+			Vector3D segmentMax(particle.oldPosition());
+			segmentMin.setMin(particle.position());
+			segmentMax.setMax(particle.position());
+			segmentMin -= radius;
+			segmentMax += radius;
+
+			findCandidates(segmentMin,segmentMax);
+			if (candidates.empty())
+				continue;
+
+			// Zones are tested in the order of the set so that the first one hit wins
+			if (candidates.size() > 1)
+				std::sort(candidates.begin(),candidates.end());
+
+			for (std::vector<size_t>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+			{
+				if (!zones[*it]->intersects(particle.oldPosition(),particle.position(),radius,&normal))
+					continue;
+
+				particle.position() = particle.oldPosition();
+
+				Vector3D& velocity = particle.velocity();
+
+				float dist = dotProduct(velocity,normal);
+
+				normal *= dist - 0.001f;
+				velocity -= normal;			// tangent component
+				velocity *= friction;
+				normal *= bouncingRatio;	// normal component
+				if (dist > 0.0f)
+					normal.revert();
+				velocity -= normal;
+				break;
+			}
+		}
+	}
+}
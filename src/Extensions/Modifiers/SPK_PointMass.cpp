@@ -64,4 +64,12 @@ namespace SPK
 			particle.velocity() += force;
 		}
 	}
+
+	void PointMass::getFusedForce(FusedForce& force,const Group& group,float deltaTime) const
+	{
+		force.type = FusedForce::FUSED_FORCE_POINT_MASS;
+		force.vector = tPosition;
+		force.scale = mass * deltaTime;
+		force.offset = offset * offset;
+	}
 }
@@ -0,0 +1,110 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <SPARK_Core.h>
+#include "Extensions/Modifiers/SPK_SurfaceAttractor.h"
+#include "Extensions/Zones/SPK_DistanceField.h"
+
+namespace SPK
+{
+	SurfaceAttractor::SurfaceAttractor(const Ref<Zone>& field,float strength,float damping,const Vector3D& flow) :
+		Modifier(MODIFIER_PRIORITY_FORCE,false,false,false),
+		distanceField(NULL),
+		strength(strength),
+		damping(damping)
+	{
+		setField(field);
+		setFlow(flow);
+	}
+
+	SurfaceAttractor::SurfaceAttractor(const SurfaceAttractor& attractor) :
+		Modifier(attractor),
+		distanceField(NULL),
+		strength(attractor.strength),
+		damping(attractor.damping)
+	{
+		setField(attractor.copyChild(attractor.field));
+		setFlow(attractor.flow);
+	}
+
+	void SurfaceAttractor::setField(const Ref<Zone>& field)
+	{
+		distanceField = dynamic_cast<const DistanceField*>(field.get());
+		if (field && distanceField == NULL)
+		{
+			SPK_LOG_WARNING("SurfaceAttractor::setField(const Ref<Zone>&) - The zone is not a DistanceField. The field is unset");
+			this->field.reset();
+			return;
+		}
+
+		this->field = field;
+	}
+
+	Ref<SPKObject> SurfaceAttractor::findByName(const std::string& name)
+	{
+		Ref<SPKObject> object = Modifier::findByName(name);
+		if (object) return object;
+
+		if (field)
+			return field->findByName(name);
+
+		return SPK_NULL_REF;
+	}
+
+	void SurfaceAttractor::propagateUpdateTransform()
+	{
+		if (field && !field->isShared())
+			field->updateTransform(this);
+	}
+
+	void SurfaceAttractor::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		if (distanceField == NULL)
+			return;
+
+		const Vector3D* positions = static_cast<const Vector3D*>(group.getPositionAddress());
+		const float discreteStrength = strength * deltaTime;
+		const float discreteDamping = damping * deltaTime > 1.0f ? 1.0f : damping * deltaTime; // Damping cannot revert the velocity
+		const Vector3D discreteFlow = tFlow * deltaTime;
+		const bool hasFlow = !tFlow.isNull();
+
+		float distances[BATCH_SIZE];
+		Vector3D gradients[BATCH_SIZE];
+		for (size_t begin = 0; begin < group.getNbParticles(); begin += BATCH_SIZE)
+		{
+			// The field is sampled by batch to keep the sampling out of the loop below
+			const size_t nb = group.getNbParticles() - begin < BATCH_SIZE ? group.getNbParticles() - begin : BATCH_SIZE;
+			distanceField->computeDistanceBatch(positions + begin,nb,distances,gradients);
+
+			for (size_t i = 0; i < nb; ++i)
+			{
+				Vector3D& normal = gradients[i];
+				if (!normal.normalize()) // No direction to the surface
+					continue;
+
+				Vector3D& velocity = group.getParticle(begin + i).velocity();
+				velocity -= normal * (distances[i] * discreteStrength + dotProduct(velocity,normal) * discreteDamping);
+				if (hasFlow)
+					velocity += discreteFlow - normal * dotProduct(discreteFlow,normal);
+			}
+		}
+	}
+}
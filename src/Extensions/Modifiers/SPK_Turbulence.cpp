@@ -0,0 +1,189 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath> // for std::cos, std::sqrt, std::floor and std::fmod
+
+#include <SPARK_Core.h>
+#include "Extensions/Modifiers/SPK_Turbulence.h"
+
+namespace SPK
+{
+	const float Turbulence::PI = 3.1415926535897932384626433832795f;
+
+	Turbulence::Turbulence(float strength,float frequency,const Vector3D& scroll) :
+		Modifier(MODIFIER_PRIORITY_FORCE,true,false,false),
+		strength(strength),
+		scroll(scroll)
+	{
+		setFrequency(frequency);
+		buildLattice();
+	}
+
+	Turbulence::Turbulence(const Turbulence& turbulence) :
+		Modifier(turbulence),
+		strength(turbulence.strength),
+		frequency(turbulence.frequency),
+		scroll(turbulence.scroll),
+		lattice(turbulence.lattice)
+	{}
+
+	void Turbulence::setFrequency(float frequency)
+	{
+		if (frequency < 0.0f)
+		{
+			SPK_LOG_WARNING("Turbulence::setFrequency(float) - The frequency cannot be negative. It is inverted");
+			frequency = -frequency;
+		}
+		this->frequency = frequency;
+	}
+
+	void Turbulence::createData(DataSet& dataSet,const Group& group) const
+	{
+		dataSet.init(NB_DATA);
+		dataSet.setData(SCROLL_INDEX,SPK_NEW(ScrollData));
+	}
+
+	void Turbulence::buildLattice()
+	{
+		// The noise is a vector potential made of random periodic waves.
+		// Wave vectors are integers so that the lattice tiles and the curl is computed analytically.
+		struct Wave
+		{
+			float k[3];
+			float phase;
+			float amplitude;
+		};
+
+		Wave waves[3][NB_WAVES];
+		for (size_t c = 0; c < 3; ++c)
+			for (size_t w = 0; w < NB_WAVES; ++w)
+			{
+				Wave& wave = waves[c][w];
+				float sqrNorm = 0.0f;
+				do
+				{
+					for (size_t j = 0; j < 3; ++j)
+						wave.k[j] = static_cast<float>(SPK_RANDOM(-2,3));
+					sqrNorm = wave.k[0] * wave.k[0] + wave.k[1] * wave.k[1] + wave.k[2] * wave.k[2];
+				}
+				while (sqrNorm == 0.0f);
+
+				wave.phase = SPK_RANDOM(0.0f,2.0f * PI);
+				wave.amplitude = 1.0f / sqrNorm; // The curl is proportional to the norm of the wave vector so low frequencies are favored
+			}
+
+		lattice.resize(LATTICE_SIZE * LATTICE_SIZE * LATTICE_SIZE * 3);
+		const float step = 2.0f * PI / LATTICE_SIZE;
+		float sqrSum = 0.0f;
+
+		size_t index = 0;
+		for (size_t z = 0; z < LATTICE_SIZE; ++z)
+			for (size_t y = 0; y < LATTICE_SIZE; ++y)
+				for (size_t x = 0; x < LATTICE_SIZE; ++x)
+				{
+					// gradients[c][j] is the derivative of the component c of the potential along the axis j
+					float gradients[3][3] = {{0.0f,0.0f,0.0f},{0.0f,0.0f,0.0f},{0.0f,0.0f,0.0f}};
+					for (size_t c = 0; c < 3; ++c)
+						for (size_t w = 0; w < NB_WAVES; ++w)
+						{
+							const Wave& wave = waves[c][w];
+							float derivative = wave.amplitude * std::cos(step * (wave.k[0] * x + wave.k[1] * y + wave.k[2] * z) + wave.phase);
+							for (size_t j = 0; j < 3; ++j)
+								gradients[c][j] += derivative * wave.k[j];
+						}
+
+					float curlX = gradients[2][1] - gradients[1][2];
+					float curlY = gradients[0][2] - gradients[2][0];
+					float curlZ = gradients[1][0] - gradients[0][1];
+					lattice[index++] = curlX;
+					lattice[index++] = curlY;
+					lattice[index++] = curlZ;
+					sqrSum += curlX * curlX + curlY * curlY + curlZ * curlZ;
+				}
+
+		// Normalizes the lattice so that the mean norm of the force is about 1
+		if (sqrSum > 0.0f)
+		{
+			float factor = 1.0f / std::sqrt(sqrSum / (LATTICE_SIZE * LATTICE_SIZE * LATTICE_SIZE));
+			for (size_t i = 0; i < lattice.size(); ++i)
+				lattice[i] *= factor;
+		}
+	}
+
+	void Turbulence::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		if (frequency == 0.0f)
+			return;
+
+		// The offset is kept within a period to prevent from losing precision over time
+		const float period = 1.0f / frequency;
+		Vector3D& scrollOffset = SPK_GET_DATA(ScrollData,dataSet,SCROLL_INDEX).offset;
+		scrollOffset += scroll * deltaTime;
+		for (size_t i = 0; i < 3; ++i)
+			scrollOffset[i] = std::fmod(scrollOffset[i],period);
+
+		const float scale = frequency * LATTICE_SIZE;
+		const float factor = strength * deltaTime;
+		const int mask = LATTICE_SIZE - 1;
+		const float* data = &lattice[0];
+
+		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		{
+			Particle& particle = *particleIt;
+
+			int cells[3][2];
+			float ratios[3];
+			for (size_t i = 0; i < 3; ++i)
+			{
+				float coord = (particle.position()[i] - scrollOffset[i]) * scale;
+				float cell = std::floor(coord);
+				ratios[i] = coord - cell;
+				cells[i][0] = static_cast<int>(cell) & mask;
+				cells[i][1] = (cells[i][0] + 1) & mask;
+			}
+
+			// Trilinear interpolation with wrapping
+			float weights[2][3];
+			for (size_t i = 0; i < 3; ++i)
+			{
+				weights[0][i] = 1.0f - ratios[i];
+				weights[1][i] = ratios[i];
+			}
+
+			float force[3] = {0.0f,0.0f,0.0f};
+			for (size_t corner = 0; corner < 8; ++corner)
+			{
+				const size_t cx = corner & 1;
+				const size_t cy = (corner >> 1) & 1;
+				const size_t cz = corner >> 2;
+				const float weight = weights[cx][0] * weights[cy][1] * weights[cz][2];
+				const float* node = data + ((cells[2][cz] * LATTICE_SIZE + cells[1][cy]) * LATTICE_SIZE + cells[0][cx]) * 3;
+				force[0] += node[0] * weight;
+				force[1] += node[1] * weight;
+				force[2] += node[2] * weight;
+			}
+
+			particle.velocity().x += force[0] * factor;
+			particle.velocity().y += force[1] * factor;
+			particle.velocity().z += force[2] * factor;
+		}
+	}
+}
@@ -0,0 +1,202 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <SPARK_Core.h>
+#include "Extensions/Modifiers/SPK_VectorField.h"
+
+namespace SPK
+{
+	VectorField::VectorField(const Vector3D& boundsMin,const Vector3D& boundsMax,float strength,bool relative) :
+		Modifier(MODIFIER_PRIORITY_FORCE,false,false,false),
+		grid(3,3),
+		clampBorders(false),
+		strength(strength),
+		relative(relative)
+	{
+		setBounds(boundsMin,boundsMax);
+	}
+
+	VectorField::VectorField(const VectorField& vectorField) :
+		Modifier(vectorField),
+		grid(vectorField.grid),
+		boundsMin(vectorField.boundsMin),
+		boundsMax(vectorField.boundsMax),
+		clampBorders(vectorField.clampBorders),
+		strength(vectorField.strength),
+		relative(vectorField.relative)
+	{
+		innerUpdateTransform();
+	}
+
+	void VectorField::setGrid(size_t width,size_t height,size_t depth,const float* data)
+	{
+		const size_t dimensions[3] = {width,height,depth};
+		if (!grid.setData(dimensions,data))
+		{
+			SPK_LOG_ERROR("VectorField::setGrid(size_t,size_t,size_t,const float*) - The grid is empty or has no data. The grid is not set");
+			return;
+		}
+
+		innerUpdateTransform();
+	}
+
+	void VectorField::setExternalGrid(size_t width,size_t height,size_t depth,const float* data)
+	{
+		const size_t dimensions[3] = {width,height,depth};
+		if (!grid.setExternalData(dimensions,data))
+		{
+			SPK_LOG_ERROR("VectorField::setExternalGrid(size_t,size_t,size_t,const float*) - The grid is empty or has no data. The grid is not set");
+			return;
+		}
+
+		innerUpdateTransform();
+	}
+
+	bool VectorField::loadFromFile(const std::string& path)
+	{
+		if (!grid.loadFromFile(path))
+			return false;
+
+		innerUpdateTransform();
+		return true;
+	}
+
+	void VectorField::innerUpdateTransform()
+	{
+		transformPos(tOrigin,boundsMin);
+		transformDir(tAxis[0],Vector3D(1.0f,0.0f,0.0f));
+		transformDir(tAxis[1],Vector3D(0.0f,1.0f,0.0f));
+		transformDir(tAxis[2],Vector3D(0.0f,0.0f,1.0f));
+
+		// Edges of the box in world space
+		// The scale of the transform stretches the box but must not scale the sampled vectors, so the axes are normalized afterwards
+		const Vector3D extent = boundsMax - boundsMin;
+		Vector3D edges[3];
+		for (size_t i = 0; i < 3; ++i)
+		{
+			edges[i] = tAxis[i] * extent[i];
+			tAxis[i].normalize();
+		}
+
+		if (!FieldGrid::computeBoxRows(edges,tGridRows)) // Flat box, all particles are mapped to the first nodes
+			return;
+
+		// Scales from [0,1] to grid coordinates
+		for (size_t i = 0; i < 3; ++i)
+			if (grid.getDimension(i) > 1)
+				tGridRows[i] *= static_cast<float>(grid.getDimension(i) - 1);
+	}
+
+	bool VectorField::sampleGrid(const Vector3D& pos,Vector3D& result) const
+	{
+		const Vector3D offset = pos - tOrigin;
+
+		size_t base = 0;
+		size_t steps[3];
+		float ratios[3];
+		size_t stride = 3;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			float coord = dotProduct(tGridRows[i],offset);
+			const float maxCoord = static_cast<float>(grid.getDimension(i) - 1);
+			if (coord < 0.0f || coord > maxCoord)
+			{
+				if (!clampBorders)
+					return false;
+				coord = coord < 0.0f ? 0.0f : maxCoord;
+			}
+
+			size_t index = static_cast<size_t>(coord);
+			if (grid.getDimension(i) > 1 && index >= grid.getDimension(i) - 1)
+				index = grid.getDimension(i) - 2;
+
+			ratios[i] = coord - index;
+			steps[i] = grid.getDimension(i) > 1 ? stride : 0;
+			base += index * stride;
+			stride *= grid.getDimension(i);
+		}
+
+		// Trilinear interpolation of the 8 surrounding nodes
+		const float* n000 = grid.getData() + base;
+		const float* n100 = n000 + steps[0];
+		const float* n010 = n000 + steps[1];
+		const float* n110 = n010 + steps[0];
+		const float* n001 = n000 + steps[2];
+		const float* n101 = n001 + steps[0];
+		const float* n011 = n001 + steps[1];
+		const float* n111 = n011 + steps[0];
+
+		float local[3];
+		for (size_t i = 0; i < 3; ++i)
+		{
+			float c00 = n000[i] + (n100[i] - n000[i]) * ratios[0];
+			float c10 = n010[i] + (n110[i] - n010[i]) * ratios[0];
+			float c01 = n001[i] + (n101[i] - n001[i]) * ratios[0];
+			float c11 = n011[i] + (n111[i] - n011[i]) * ratios[0];
+			float c0 = c00 + (c10 - c00) * ratios[1];
+			float c1 = c01 + (c11 - c01) * ratios[1];
+			local[i] = c0 + (c1 - c0) * ratios[2];
+		}
+
+		result = tAxis[0] * local[0] + tAxis[1] * local[1] + tAxis[2] * local[2];
+		return true;
+	}
+
+	void VectorField::sample(const Vector3D* positions,Vector3D* results,size_t nb) const
+	{
+		if (grid.getData() == NULL)
+		{
+			for (size_t i = 0; i < nb; ++i)
+				results[i].set(0.0f,0.0f,0.0f);
+			return;
+		}
+
+		for (size_t i = 0; i < nb; ++i)
+			if (!sampleGrid(positions[i],results[i]))
+				results[i].set(0.0f,0.0f,0.0f);
+	}
+
+	void VectorField::modify(Group& group,DataSet* dataSet,float deltaTime) const
+	{
+		if (grid.getData() == NULL)
+			return;
+
+		Vector3D vector;
+		if (!relative)
+		{
+			const float factor = strength * deltaTime;
+			for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+				if (sampleGrid(particleIt->position(),vector))
+					particleIt->velocity() += vector * factor;
+		}
+		else
+		{
+			// the factor is clamped due to the use of a discrete time (see LinearForce)
+			float factor = strength * deltaTime;
+			if (factor > 1.0f)
+				factor = 1.0f;
+
+			for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+				if (sampleGrid(particleIt->position(),vector))
+					particleIt->velocity() += (vector - particleIt->velocity()) * factor;
+		}
+	}
+}
@@ -19,11 +19,64 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
+#include <cmath> // for std::sqrt, std::sin, std::cos and std::floor
+#include <cstring> // for std::memcpy
+
 #include <SPARK_Core.h>
 #include "Extensions/Modifiers/SPK_Vortex.h"
 
 namespace SPK
 {
+	// Approximation of 1 / sqrt(x) with a single Newton-Raphson iteration (relative error lower than 0.2%)
+	static inline float fastInvSqrt(float x)
+	{
+		unsigned int i;
+		std::memcpy(&i,&x,sizeof(float));
+		i = 0x5F3759DF - (i >> 1);
+		float y;
+		std::memcpy(&y,&i,sizeof(float));
+		return y * (1.5f - 0.5f * x * y * y);
+	}
+
+	// Approximation of sin(x) for x in [-PI/2,PI/2] with a polynomial of order 9 (error lower than 4.10^-6)
+	static inline float fastSinPolynomial(float x)
+	{
+		const float x2 = x * x;
+		return x * (1.0f + x2 * (-1.6666667e-1f + x2 * (8.3333333e-3f + x2 * (-1.9841270e-4f + x2 * 2.7557319e-6f))));
+	}
+
+	// Approximation of sin(x) for x in [-PI,PI]
+	static inline float fastSin(float x)
+	{
+		const float PI = 3.1415926535897932384626433832795f;
+		const float HALF_PI = 0.5f * PI;
+		if (x > HALF_PI) x = PI - x;
+		else if (x < -HALF_PI) x = -PI - x;
+		return fastSinPolynomial(x);
+	}
+
+	static inline void computeSinCos(float angle,float& sinAngle,float& cosAngle,bool fast)
+	{
+		if (!fast)
+		{
+			sinAngle = std::sin(angle);
+			cosAngle = std::cos(angle);
+			return;
+		}
+
+		const float PI = 3.1415926535897932384626433832795f;
+		const float TWO_PI = 2.0f * PI;
+
+		// Reduces the angle to [-PI,PI]
+		angle -= TWO_PI * std::floor(angle / TWO_PI + 0.5f);
+		sinAngle = fastSin(angle);
+
+		// cos(x) = sin(x + PI/2)
+		angle += 0.5f * PI;
+		if (angle > PI) angle -= TWO_PI;
+		cosAngle = fastSin(angle);
+	}
+
 	Vortex::Vortex(const Vector3D& position,const Vector3D& direction,float rotationSpeed,float attractionSpeed) :
 		Modifier(MODIFIER_PRIORITY_POSITION,false,false,false),
 		rotationSpeed(rotationSpeed),
@@ -31,7 +84,8 @@ namespace SPK
 		angularSpeedEnabled(false),
 		linearSpeedEnabled(false),
 		killingParticleEnabled(false),
-		eyeRadius(0.0f)
+		eyeRadius(0.0f),
+		fastComputationEnabled(false)
 	{
 		setPosition(position);
 		setDirection(direction);
@@ -44,7 +98,8 @@ namespace SPK
 		angularSpeedEnabled(vortex.angularSpeedEnabled),
 		linearSpeedEnabled(vortex.linearSpeedEnabled),
 		killingParticleEnabled(vortex.killingParticleEnabled),
-		eyeRadius(vortex.eyeRadius)
+		eyeRadius(vortex.eyeRadius),
+		fastComputationEnabled(vortex.fastComputationEnabled)
 	{
 		setPosition(vortex.position);
 		setDirection(vortex.direction);
@@ -62,35 +117,45 @@ namespace SPK
 
 	void Vortex::modify(Group& group,DataSet* dataSet,float deltaTime) const
 	{
+		const float sqrEyeRadius = eyeRadius * eyeRadius;
+		const float rotation = rotationSpeed * deltaTime;
+		const float attraction = attractionSpeed * deltaTime;
+
+		// With an angular speed, the angle is the same for all particles
+		float cosAngle = 0.0f;
+		float sinAngle = 0.0f;
+		if (angularSpeedEnabled)
+			computeSinCos(rotation,sinAngle,cosAngle,fastComputationEnabled);
+
 		for (GroupIterator particleIt(group); !particleIt.end(); ++particleIt)
 		{
 			Particle& particle = *particleIt;
+			Vector3D& pos = particle.position();
 
-			// Distance of the projection point from the position of the vortex
-			float dist = dotProduct(tDirection,particle.position() - tPosition);
-			
-			// Position of the rotation center (orthogonal projection of the particle)
-			Vector3D rotationCenter = tDirection;
-			rotationCenter *= dist;
-			rotationCenter += tPosition;
+			// Vector from the rotation center (orthogonal projection of the particle on the eye line) to the particle
+			Vector3D radial = pos - tPosition;
+			radial -= tDirection * dotProduct(tDirection,radial);
 
 			// Distance of the particle from the eye of the vortex
-			dist = getDist(rotationCenter,particle.position());
-
-			if (dist <= eyeRadius)
+			float sqrDist = radial.getSqrNorm();
+			if (sqrDist <= sqrEyeRadius)
 			{
 				if (killingParticleEnabled)
 					particle.kill();
-				return;
+				continue;
 			}
-		
-			float angle = angularSpeedEnabled ? rotationSpeed * deltaTime : rotationSpeed * deltaTime / dist;
+
+			float invDist = fastComputationEnabled ? fastInvSqrt(sqrDist) : 1.0f / std::sqrt(sqrDist);
+			float dist = sqrDist * invDist;
+
+			if (!angularSpeedEnabled)
+				computeSinCos(rotation * invDist,sinAngle,cosAngle,fastComputationEnabled);
 
 			// Computes ortho base
-			Vector3D normal = (particle.position() - rotationCenter) / dist;
+			Vector3D normal = radial * invDist;
 			Vector3D tangent = crossProduct(tDirection,normal);
 
-			float endRadius = linearSpeedEnabled ? dist * (1.0f - attractionSpeed * deltaTime) : dist - attractionSpeed * deltaTime;
+			float endRadius = linearSpeedEnabled ? dist * (1.0f - attraction) : dist - attraction;
 			if (endRadius <= eyeRadius)
 			{
 				endRadius = eyeRadius;
@@ -98,7 +163,8 @@ namespace SPK
 					particle.kill();
 			}
 
-			particle.position() = rotationCenter + normal * endRadius * std::cos(angle) + tangent * endRadius * std::sin(angle);
+			pos -= radial; // the rotation center
+			pos += (normal * cosAngle + tangent * sinAngle) * endRadius;
 		}
 	}
 
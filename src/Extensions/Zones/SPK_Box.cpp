@@ -209,4 +209,39 @@ namespace SPK
 			tAxis[i].normalize();
 		}
 	}
+
+	void Box::containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		const Vector3D& center = getTransformedPosition();
+		for (size_t i = 0; i < nb; ++i)
+		{
+			const float radius = radii != NULL ? radii[i] : 0.0f;
+			const Vector3D d(v[i] - center);
+			const bool inX = std::abs(dotProduct(tAxis[0],d)) - radius <= halfDimensions.x;
+			const bool inY = std::abs(dotProduct(tAxis[1],d)) - radius <= halfDimensions.y;
+			const bool inZ = std::abs(dotProduct(tAxis[2],d)) - radius <= halfDimensions.z;
+			mask[i] = (inX & inY & inZ) ? 1 : 0;
+		}
+	}
+
+	void Box::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = Box::intersects(v0[i],v1[i],radii != NULL ? radii[i] : 0.0f) ? 1 : 0; // Static call to avoid the virtual dispatch
+	}
+
+	void Box::computeBounds(Vector3D& boundsMin,Vector3D& boundsMax) const
+	{
+		// The extent on a world axis is the sum of the projections of the half dimensions
+		Vector3D extent;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			Vector3D projection(tAxis[i]);
+			projection.abs();
+			extent += projection * halfDimensions[i];
+		}
+
+		boundsMin = getTransformedPosition() - extent;
+		boundsMax = getTransformedPosition() + extent;
+	}
 }
@@ -19,6 +19,8 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
+#include <cstring> // for std::memset
+
 #include <SPARK_Core.h>
 #include "Extensions/Zones/SPK_Cylinder.h"
 
@@ -145,4 +147,40 @@ namespace SPK
 		Zone::innerUpdateTransform();
 		computeTransformedBase();
 	}
+
+	void Cylinder::containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		const Vector3D& center = getTransformedPosition();
+		const float halfHeight = height * 0.5f;
+		for (size_t i = 0; i < nb; ++i)
+		{
+			const float radius = radii != NULL ? radii[i] : 0.0f;
+			const Vector3D d = v[i] - center;
+			const float tangentDist = dotProduct(d,tAxis);
+			const float normalSqrDist = (d - tangentDist * tAxis).getSqrNorm();
+			const float relRadius = this->radius - radius;
+			mask[i] = (std::abs(tangentDist) - radius <= halfHeight && normalSqrDist <= relRadius * relRadius) ? 1 : 0;
+		}
+	}
+
+	void Cylinder::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		SPK_LOG_INFO("The intersection is not implemented yet with the Cylinder Zone");
+		std::memset(mask,0,nb);
+	}
+
+	void Cylinder::computeBounds(Vector3D& boundsMin,Vector3D& boundsMax) const
+	{
+		// The extent on a world axis is the projection of the half axis plus the extent of the base disk
+		Vector3D extent;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			const float axisComponent = tAxis[i];
+			const float diskFactor = 1.0f - axisComponent * axisComponent;
+			extent[i] = std::abs(axisComponent) * height * 0.5f + radius * std::sqrt(diskFactor > 0.0f ? diskFactor : 0.0f);
+		}
+
+		boundsMin = getTransformedPosition() - extent;
+		boundsMax = getTransformedPosition() + extent;
+	}
 }
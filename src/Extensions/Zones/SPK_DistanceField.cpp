@@ -0,0 +1,396 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <limits> // for max float value
+
+#include <SPARK_Core.h>
+#include "Extensions/Zones/SPK_DistanceField.h"
+#include "Extensions/Zones/SPK_TriangleMesh.h"
+
+namespace SPK
+{
+	DistanceField::DistanceField(const Vector3D& position,const Vector3D& dimensions) :
+		Zone(position),
+		grid(3,1,2)
+	{
+		setDimensions(dimensions);
+	}
+
+	DistanceField::DistanceField(const DistanceField& field) :
+		Zone(field),
+		dimensions(field.dimensions),
+		grid(field.grid)
+	{
+		innerUpdateTransform();
+	}
+
+	void DistanceField::setDimensions(const Vector3D& dimensions)
+	{
+		this->dimensions = dimensions;
+
+		if (dimensions.x < 0.0f || dimensions.y < 0.0f || dimensions.z < 0.0f)
+		{
+			SPK_LOG_WARNING("DistanceField::setDimensions(const Vector3D&) - The dimensions cannot be negative. Values are inversed");
+			this->dimensions.abs();
+		}
+
+		innerUpdateTransform();
+	}
+
+	void DistanceField::setGrid(size_t width,size_t height,size_t depth,const float* distances)
+	{
+		const size_t gridDimensions[3] = {width,height,depth};
+		if (!grid.setData(gridDimensions,distances))
+			SPK_LOG_ERROR("DistanceField::setGrid(size_t,size_t,size_t,const float*) - The grid must have at least 2 nodes along each axis and data. The grid is not set");
+	}
+
+	void DistanceField::setExternalGrid(size_t width,size_t height,size_t depth,const float* distances)
+	{
+		const size_t gridDimensions[3] = {width,height,depth};
+		if (!grid.setExternalData(gridDimensions,distances))
+			SPK_LOG_ERROR("DistanceField::setExternalGrid(size_t,size_t,size_t,const float*) - The grid must have at least 2 nodes along each axis and data. The grid is not set");
+	}
+
+	void DistanceField::bakeFromMesh(const TriangleMesh& mesh,size_t width,size_t height,size_t depth)
+	{
+		if (width < 2 || height < 2 || depth < 2)
+		{
+			SPK_LOG_ERROR("DistanceField::bakeFromMesh(const TriangleMesh&,size_t,size_t,size_t) - The grid must have at least 2 nodes along each axis. The grid is not baked");
+			return;
+		}
+
+		if (mesh.getNbTriangles() == 0 || tScale <= 0.0f)
+		{
+			SPK_LOG_ERROR("DistanceField::bakeFromMesh(const TriangleMesh&,size_t,size_t,size_t) - The mesh or the box of the grid is empty. The grid is not baked");
+			return;
+		}
+
+		std::vector<float> bakedData(width * height * depth);
+		float* distance = &bakedData[0];
+		for (size_t k = 0; k < depth; ++k)
+			for (size_t j = 0; j < height; ++j)
+				for (size_t i = 0; i < width; ++i)
+				{
+					const Vector3D node = getTransformedPosition() + tOrigin
+						+ tEdges[0] * (static_cast<float>(i) / (width - 1))
+						+ tEdges[1] * (static_cast<float>(j) / (height - 1))
+						+ tEdges[2] * (static_cast<float>(k) / (depth - 1));
+
+					float dist = mesh.computeDistance(node);
+					if (mesh.contains(node))
+						dist = -dist;
+					*distance++ = dist / tScale; // Distances are stored in local space
+				}
+
+		const size_t gridDimensions[3] = {width,height,depth};
+		grid.swapData(gridDimensions,bakedData);
+	}
+
+	bool DistanceField::loadFromFile(const std::string& path)
+	{
+		return grid.loadFromFile(path);
+	}
+
+	bool DistanceField::saveToFile(const std::string& path) const
+	{
+		return grid.saveToFile(path);
+	}
+
+	void DistanceField::innerUpdateTransform()
+	{
+		Zone::innerUpdateTransform();
+
+		// The frame is kept relative to the transformed position so that moving the zone does not need to update it
+		transformDir(tOrigin,dimensions * -0.5f);
+		transformDir(tEdges[0],Vector3D(dimensions.x,0.0f,0.0f));
+		transformDir(tEdges[1],Vector3D(0.0f,dimensions.y,0.0f));
+		transformDir(tEdges[2],Vector3D(0.0f,0.0f,dimensions.z));
+
+		if (!FieldGrid::computeBoxRows(tEdges,tGridRows)) // Flat box, the field cannot be sampled
+		{
+			tScale = 0.0f;
+			return;
+		}
+
+		tScale = tEdges[0].getNorm() / dimensions.x;
+	}
+
+	float DistanceField::sampleField(const Vector3D& d,Vector3D* gradient) const
+	{
+		const Vector3D offset(d - tOrigin);
+
+		// Clamps the point to the grid
+		Vector3D outside(offset);
+		float coords[3];
+		size_t indices[3];
+		bool clamped[3];
+		for (size_t i = 0; i < 3; ++i)
+		{
+			float coord = dotProduct(tGridRows[i],offset);
+			clamped[i] = coord < 0.0f || coord > 1.0f;
+			if (coord < 0.0f) coord = 0.0f;
+			else if (coord > 1.0f) coord = 1.0f;
+			outside -= tEdges[i] * coord;
+
+			coord *= grid.getDimension(i) - 1;
+			indices[i] = static_cast<size_t>(coord);
+			if (indices[i] >= grid.getDimension(i) - 1)
+				indices[i] = grid.getDimension(i) - 2;
+			coords[i] = coord - indices[i];
+		}
+
+		// Trilinear interpolation of the 8 surrounding nodes
+		const size_t stepY = grid.getDimension(0);
+		const size_t stepZ = grid.getDimension(0) * grid.getDimension(1);
+		const float* n000 = grid.getData() + indices[0] + indices[1] * stepY + indices[2] * stepZ;
+		const float d000 = n000[0];
+		const float d100 = n000[1];
+		const float d010 = n000[stepY];
+		const float d110 = n000[stepY + 1];
+		const float d001 = n000[stepZ];
+		const float d101 = n000[stepZ + 1];
+		const float d011 = n000[stepZ + stepY];
+		const float d111 = n000[stepZ + stepY + 1];
+
+		const float d00 = d000 + (d100 - d000) * coords[0];
+		const float d10 = d010 + (d110 - d010) * coords[0];
+		const float d01 = d001 + (d101 - d001) * coords[0];
+		const float d11 = d011 + (d111 - d011) * coords[0];
+		const float d0 = d00 + (d10 - d00) * coords[1];
+		const float d1 = d01 + (d11 - d01) * coords[1];
+
+		const float outsideDist = outside.getNorm();
+
+		if (gradient != NULL)
+		{
+			// Partial derivatives of the interpolation in grid coordinates, null along the axes where the point is clamped
+			float slopes[3];
+			const float e0 = (d100 - d000) + ((d110 - d010) - (d100 - d000)) * coords[1];
+			const float e1 = (d101 - d001) + ((d111 - d011) - (d101 - d001)) * coords[1];
+			slopes[0] = e0 + (e1 - e0) * coords[2];
+			slopes[1] = (d10 - d00) + ((d11 - d01) - (d10 - d00)) * coords[2];
+			slopes[2] = d1 - d0;
+
+			gradient->set(0.0f,0.0f,0.0f);
+			for (size_t i = 0; i < 3; ++i)
+				if (!clamped[i])
+					*gradient += tGridRows[i] * (slopes[i] * (grid.getDimension(i) - 1) * tScale);
+
+			if (outsideDist > 0.0f)
+				*gradient += outside / outsideDist;
+		}
+
+		return (d0 + (d1 - d0) * coords[2]) * tScale + outsideDist;
+	}
+
+	float DistanceField::computeDistance(const Vector3D& v,Vector3D* gradient) const
+	{
+		if (grid.getData() == NULL)
+		{
+			if (gradient != NULL)
+				gradient->set(0.0f,0.0f,0.0f);
+			return std::numeric_limits<float>::max();
+		}
+
+		return sampleField(v - getTransformedPosition(),gradient);
+	}
+
+	void DistanceField::computeDistanceBatch(const Vector3D* v,size_t nb,float* distances,Vector3D* gradients) const
+	{
+		if (grid.getData() == NULL)
+		{
+			for (size_t i = 0; i < nb; ++i)
+			{
+				distances[i] = std::numeric_limits<float>::max();
+				gradients[i].set(0.0f,0.0f,0.0f);
+			}
+			return;
+		}
+
+		// The loop is kept free of virtual calls and branches on the state of the field
+		for (size_t i = 0; i < nb; ++i)
+			distances[i] = sampleField(v[i] - getTransformedPosition(),gradients + i);
+	}
+
+	void DistanceField::generatePosition(Vector3D& v,bool full,float radius) const
+	{
+		if (grid.getData() == NULL)
+		{
+			v = getTransformedPosition();
+			return;
+		}
+
+		Vector3D d;
+		if (full)
+		{
+			// Random positions are drawn in the grid until one is inside the shape
+			for (size_t i = 0; i < MAX_GENERATION_TRIES; ++i)
+			{
+				d = tOrigin + tEdges[0] * SPK_RANDOM(0.0f,1.0f) + tEdges[1] * SPK_RANDOM(0.0f,1.0f) + tEdges[2] * SPK_RANDOM(0.0f,1.0f);
+				if (sampleField(d,NULL) <= -radius)
+				{
+					v = getTransformedPosition() + d;
+					return;
+				}
+			}
+			// If no position was found, a position on the surface is generated
+		}
+
+		// A random position is projected onto the surface along the gradient
+		d = tOrigin + tEdges[0] * SPK_RANDOM(0.0f,1.0f) + tEdges[1] * SPK_RANDOM(0.0f,1.0f) + tEdges[2] * SPK_RANDOM(0.0f,1.0f);
+		Vector3D gradient;
+		for (size_t i = 0; i < NB_PROJECTION_STEPS; ++i)
+		{
+			const float dist = sampleField(d,&gradient) + radius;
+			if (gradient.normalize())
+				d -= gradient * dist;
+		}
+
+		v = getTransformedPosition() + d;
+	}
+
+	bool DistanceField::contains(const Vector3D& v,float radius) const
+	{
+		if (grid.getData() == NULL)
+			return false;
+
+		return sampleField(v - getTransformedPosition(),NULL) <= -radius;
+	}
+
+	bool DistanceField::intersects(const Vector3D& v0,const Vector3D& v1,float radius,Vector3D* normal) const
+	{
+		if (grid.getData() == NULL)
+			return false;
+
+		const Vector3D d0(v0 - getTransformedPosition());
+		const Vector3D direction(v1 - v0);
+		const float length = direction.getNorm();
+		if (length == 0.0f)
+			return false;
+
+		// Marches along the segment by steps of the distance to the surface
+		// As the sampled distance does not exceed the distance to the surface, no crossing is missed by a full step
+		// A minimum step ensures progress when the segment starts on the surface
+		const float minStep = 1.0f / (MAX_MARCHING_STEPS * 4);
+		float dist0 = sampleField(d0,NULL) - radius;
+		const bool outside = dist0 > 0.0f;
+		float ratio0 = 0.0f;
+		float ratio1 = 0.0f;
+		float dist1 = dist0;
+		bool crossed = false;
+
+		for (size_t i = 0; i < MAX_MARCHING_STEPS && ratio0 < 1.0f; ++i)
+		{
+			float step = std::abs(dist0) / length;
+			if (step < minStep) step = minStep;
+			ratio1 = ratio0 + step < 1.0f ? ratio0 + step : 1.0f;
+
+			dist1 = sampleField(d0 + direction * ratio1,NULL) - radius;
+			if ((dist1 > 0.0f) != outside)
+			{
+				crossed = true;
+				break;
+			}
+
+			ratio0 = ratio1;
+			dist0 = dist1;
+		}
+
+		bool bisect = false;
+		if (!crossed)
+		{
+			if (ratio0 >= 1.0f)
+				return false;
+
+			// The marching stopped before the end of the segment, the crossing is searched between the last sample and the end
+			ratio1 = 1.0f;
+			dist1 = sampleField(d0 + direction,NULL) - radius;
+			if ((dist1 > 0.0f) == outside)
+				return false;
+			bisect = true;
+		}
+
+		if (normal != NULL)
+		{
+			// The remaining interval may be large so it is narrowed down first
+			if (bisect)
+				for (size_t i = 0; i < NB_BISECTION_STEPS; ++i)
+				{
+					const float ratio = (ratio0 + ratio1) * 0.5f;
+					const float dist = sampleField(d0 + direction * ratio,NULL) - radius;
+					if ((dist > 0.0f) == outside)
+					{
+						ratio0 = ratio;
+						dist0 = dist;
+					}
+					else
+					{
+						ratio1 = ratio;
+						dist1 = dist;
+					}
+				}
+
+			// The crossing is refined linearly between the 2 last samples
+			const float ratio = ratio0 + (ratio1 - ratio0) * dist0 / (dist0 - dist1);
+			sampleField(d0 + direction * ratio,normal);
+			normalizeOrRandomize(*normal);
+			if (!outside)
+				normal->revert();
+		}
+
+		return true;
+	}
+
+	Vector3D DistanceField::computeNormal(const Vector3D& v) const
+	{
+		Vector3D normal(v - getTransformedPosition());
+		if (grid.getData() != NULL)
+			sampleField(v - getTransformedPosition(),&normal);
+		normalizeOrRandomize(normal);
+		return normal;
+	}
+
+	void DistanceField::containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = DistanceField::contains(v[i],radii != NULL ? radii[i] : 0.0f) ? 1 : 0; // Static call to avoid the virtual dispatch
+	}
+
+	void DistanceField::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = DistanceField::intersects(v0[i],v1[i],radii != NULL ? radii[i] : 0.0f) ? 1 : 0; // Static call to avoid the virtual dispatch
+	}
+
+	void DistanceField::computeBounds(Vector3D& boundsMin,Vector3D& boundsMax) const
+	{
+		boundsMin = boundsMax = getTransformedPosition() + tOrigin;
+		for (size_t i = 1; i < 8; ++i)
+		{
+			Vector3D corner(getTransformedPosition() + tOrigin);
+			for (size_t j = 0; j < 3; ++j)
+				if ((i >> j) & 1)
+					corner += tEdges[j];
+			boundsMin.setMin(corner);
+			boundsMax.setMax(corner);
+		}
+	}
+}
@@ -66,4 +66,28 @@ namespace SPK
 		transformDir(tNormal,normal);
 		tNormal.normalize();
 	}
+
+	void Plane::containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		const float offset = dotProduct(tNormal,getTransformedPosition());
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = dotProduct(tNormal,v[i]) - offset <= (radii != NULL ? radii[i] : 0.0f) ? 1 : 0;
+	}
+
+	void Plane::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		const float offset = dotProduct(tNormal,getTransformedPosition());
+		for (size_t i = 0; i < nb; ++i)
+		{
+			// Same tests as intersects(const Vector3D&,const Vector3D&,float,Vector3D*)
+			const float radius = radii != NULL ? radii[i] : 0.0f;
+			const float dist0 = dotProduct(tNormal,v0[i]) - offset;
+			const float dist1 = dotProduct(tNormal,v1[i]) - offset;
+			const float shiftedDist1 = dist1 > 0.0f ? dist1 - radius : dist1 + radius;
+			const bool alreadyIntersecting = std::abs(dist0) < radius;
+			const bool endIntersecting = std::abs(dist1) < radius;
+			const bool crossing = (dist0 < 0.0f) != (shiftedDist1 < 0.0f);
+			mask[i] = (!alreadyIntersecting && (endIntersecting || crossing)) ? 1 : 0;
+		}
+	}
 }
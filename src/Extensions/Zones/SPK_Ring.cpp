@@ -20,6 +20,7 @@
 //////////////////////////////////////////////////////////////////////////////////
 
 #include <algorithm> // for std::swap
+#include <cstring> // for std::memset
 
 #include <SPARK_Core.h>
 #include "Extensions/Zones/SPK_Ring.h"
@@ -141,4 +142,29 @@ namespace SPK
 		transformDir(tNormal,normal);
 		tNormal.normalize();
 	}
+
+	void Ring::containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		std::memset(mask,0,nb);
+	}
+
+	void Ring::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = Ring::intersects(v0[i],v1[i],radii != NULL ? radii[i] : 0.0f) ? 1 : 0; // Static call to avoid the virtual dispatch
+	}
+
+	void Ring::computeBounds(Vector3D& boundsMin,Vector3D& boundsMax) const
+	{
+		// The extent of a disk on a world axis depends on the angle between the axis and the normal
+		Vector3D extent;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			const float diskFactor = 1.0f - tNormal[i] * tNormal[i];
+			extent[i] = maxRadius * std::sqrt(diskFactor > 0.0f ? diskFactor : 0.0f);
+		}
+
+		boundsMin = getTransformedPosition() - extent;
+		boundsMax = getTransformedPosition() + extent;
+	}
 }
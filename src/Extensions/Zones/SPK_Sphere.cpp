@@ -113,4 +113,39 @@ namespace SPK
 			normal.revert();
 		return normal;
 	}
+
+	void Sphere::containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		const Vector3D& center = getTransformedPosition();
+		for (size_t i = 0; i < nb; ++i)
+		{
+			const float relRadius = this->radius - (radii != NULL ? radii[i] : 0.0f);
+			const float dx = v[i].x - center.x;
+			const float dy = v[i].y - center.y;
+			const float dz = v[i].z - center.z;
+			mask[i] = dx * dx + dy * dy + dz * dz <= relRadius * relRadius ? 1 : 0;
+		}
+	}
+
+	void Sphere::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		const Vector3D& center = getTransformedPosition();
+		for (size_t i = 0; i < nb; ++i)
+		{
+			const float radius = radii != NULL ? radii[i] : 0.0f;
+			const float r2 = this->radius * this->radius + radius * radius;
+			const float s2 = 2.0f * this->radius * radius;
+			const float dist0 = getSqrDist(center,v0[i]);
+			const float dist1 = getSqrDist(center,v1[i]);
+
+			// Same tests as intersects(const Vector3D&,const Vector3D&,float,Vector3D*)
+			mask[i] = (dist0 > r2 + s2 ? dist1 <= r2 + s2 : (dist0 < r2 - s2 && dist1 >= r2 - s2)) ? 1 : 0;
+		}
+	}
+
+	void Sphere::computeBounds(Vector3D& boundsMin,Vector3D& boundsMax) const
+	{
+		boundsMin = getTransformedPosition() - radius;
+		boundsMax = getTransformedPosition() + radius;
+	}
 }
@@ -0,0 +1,653 @@
+//////////////////////////////////////////////////////////////////////////////////
+// SPARK particle engine														//
+// Copyright (C) 2008-2013 - Julien Fryer - julienfryer@gmail.com				//
+//																				//
+// This software is provided 'as-is', without any express or implied			//
+// warranty.  In no event will the authors be held liable for any damages		//
+// arising from the use of this software.										//
+//																				//
+// Permission is granted to anyone to use this software for any purpose,		//
+// including commercial applications, and to alter it and redistribute it		//
+// freely, subject to the following restrictions:								//
+//																				//
+// 1. The origin of this software must not be misrepresented; you must not		//
+//    claim that you wrote the original software. If you use this software		//
+//    in a product, an acknowledgment in the product documentation would be		//
+//    appreciated but is not required.											//
+// 2. Altered source versions must be plainly marked as such, and must not be	//
+//    misrepresented as being the original software.							//
+// 3. This notice may not be removed or altered from any source distribution.	//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm> // for std::nth_element and std::upper_bound
+#include <fstream>
+#include <limits> // for max float value
+
+#include <SPARK_Core.h>
+#include "Extensions/Zones/SPK_TriangleMesh.h"
+
+namespace SPK
+{
+	TriangleMesh::TriangleMesh(const Vector3D& position) :
+		Zone(position)
+	{}
+
+	TriangleMesh::TriangleMesh(const TriangleMesh& mesh) :
+		Zone(mesh),
+		file(mesh.file),
+		vertices(mesh.vertices),
+		indices(mesh.indices),
+		nodes(mesh.nodes),
+		tVertices(mesh.tVertices),
+		cumulatedAreas(mesh.cumulatedAreas)
+	{}
+
+	void TriangleMesh::setMesh(const Vector3D* vertices,size_t nbVertices,const unsigned int* indices,size_t nbTriangles)
+	{
+		if (vertices == NULL || indices == NULL || nbVertices == 0 || nbTriangles == 0)
+		{
+			SPK_LOG_ERROR("TriangleMesh::setMesh(const Vector3D*,size_t,const unsigned int*,size_t) - The mesh is empty or has no data. The mesh is not set");
+			return;
+		}
+
+		for (size_t i = 0; i < nbTriangles * 3; ++i)
+			if (indices[i] >= nbVertices)
+			{
+				SPK_LOG_ERROR("TriangleMesh::setMesh(const Vector3D*,size_t,const unsigned int*,size_t) - The index " << indices[i] << " is out of bounds. The mesh is not set");
+				return;
+			}
+
+		this->vertices.assign(vertices,vertices + nbVertices);
+		this->indices.assign(indices,indices + nbTriangles * 3);
+		file.clear();
+
+		buildHierarchy();
+		innerUpdateTransform();
+	}
+
+	bool TriangleMesh::loadFromFile(const std::string& path)
+	{
+		std::ifstream stream(path.c_str(),std::ios::in | std::ios::binary);
+		if (!stream)
+		{
+			SPK_LOG_ERROR("TriangleMesh::loadFromFile(const std::string&) - Unable to open the file " << path);
+			return false;
+		}
+
+		unsigned int header[3];
+		stream.read(reinterpret_cast<char*>(header),sizeof(header));
+		if (!stream || header[0] == 0 || header[1] == 0 || header[2] == 0)
+		{
+			SPK_LOG_ERROR("TriangleMesh::loadFromFile(const std::string&) - Invalid header in the file " << path);
+			return false;
+		}
+
+		const size_t nbVertices = header[0];
+		const size_t nbTriangles = header[1];
+		const size_t nbNodes = header[2];
+
+		std::vector<float> fileVertices(nbVertices * 3);
+		std::vector<unsigned int> fileIndices(nbTriangles * 3);
+		std::vector<unsigned int> fileNodes(nbNodes * 2);
+		stream.read(reinterpret_cast<char*>(&fileVertices[0]),fileVertices.size() * sizeof(float));
+		stream.read(reinterpret_cast<char*>(&fileIndices[0]),fileIndices.size() * sizeof(unsigned int));
+		stream.read(reinterpret_cast<char*>(&fileNodes[0]),fileNodes.size() * sizeof(unsigned int));
+		if (!stream)
+		{
+			SPK_LOG_ERROR("TriangleMesh::loadFromFile(const std::string&) - The file " << path << " is too short");
+			return false;
+		}
+
+		// Checks the integrity of the data
+		for (size_t i = 0; i < fileIndices.size(); ++i)
+			if (fileIndices[i] >= nbVertices)
+			{
+				SPK_LOG_ERROR("TriangleMesh::loadFromFile(const std::string&) - The file " << path << " has an index out of bounds");
+				return false;
+			}
+
+		// Children must be stored after their parent and the depth must fit in the traversal stacks
+		std::vector<size_t> depths(nbNodes,0);
+		for (size_t i = 0; i < nbNodes; ++i)
+		{
+			const size_t first = fileNodes[i * 2];
+			const size_t count = fileNodes[i * 2 + 1];
+			if (count == 0 && first > i && first + 1 < nbNodes)
+				depths[first] = depths[first + 1] = depths[i] + 1;
+			if ((count == 0 && (first <= i || first + 1 >= nbNodes)) || (count != 0 && first + count > nbTriangles) || depths[i] >= MAX_STACK_SIZE - 1)
+			{
+				SPK_LOG_ERROR("TriangleMesh::loadFromFile(const std::string&) - The file " << path << " has an invalid hierarchy");
+				return false;
+			}
+		}
+
+		vertices.resize(nbVertices);
+		for (size_t i = 0; i < nbVertices; ++i)
+			vertices[i].set(fileVertices[i * 3],fileVertices[i * 3 + 1],fileVertices[i * 3 + 2]);
+
+		indices.swap(fileIndices);
+
+		nodes.resize(nbNodes);
+		for (size_t i = 0; i < nbNodes; ++i)
+		{
+			nodes[i].first = fileNodes[i * 2];
+			nodes[i].count = fileNodes[i * 2 + 1];
+		}
+
+		innerUpdateTransform();
+		file = path;
+		return true;
+	}
+
+	bool TriangleMesh::saveToFile(const std::string& path) const
+	{
+		if (nodes.empty())
+		{
+			SPK_LOG_ERROR("TriangleMesh::saveToFile(const std::string&) - The mesh is empty and cannot be saved");
+			return false;
+		}
+
+		std::ofstream stream(path.c_str(),std::ios::out | std::ios::binary);
+		if (!stream)
+		{
+			SPK_LOG_ERROR("TriangleMesh::saveToFile(const std::string&) - Unable to open the file " << path);
+			return false;
+		}
+
+		unsigned int header[3] = {
+			static_cast<unsigned int>(vertices.size()),
+			static_cast<unsigned int>(getNbTriangles()),
+			static_cast<unsigned int>(nodes.size())};
+		stream.write(reinterpret_cast<const char*>(header),sizeof(header));
+
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			const float vertex[3] = {vertices[i].x,vertices[i].y,vertices[i].z};
+			stream.write(reinterpret_cast<const char*>(vertex),sizeof(vertex));
+		}
+
+		stream.write(reinterpret_cast<const char*>(&indices[0]),indices.size() * sizeof(unsigned int));
+
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			const unsigned int node[2] = {static_cast<unsigned int>(nodes[i].first),static_cast<unsigned int>(nodes[i].count)};
+			stream.write(reinterpret_cast<const char*>(node),sizeof(node));
+		}
+
+		if (!stream)
+		{
+			SPK_LOG_ERROR("TriangleMesh::saveToFile(const std::string&) - Unable to write the file " << path);
+			return false;
+		}
+
+		return true;
+	}
+
+	float TriangleMesh::computeDistance(const Vector3D& v) const
+	{
+		const Vector3D d(v - getTransformedPosition());
+
+		Vector3D closestPoint;
+		size_t triangle;
+		if (nodes.empty() || !findClosestPoint(d,std::numeric_limits<float>::max(),closestPoint,triangle))
+			return std::numeric_limits<float>::max();
+
+		return getDist(d,closestPoint);
+	}
+
+	void TriangleMesh::buildHierarchy()
+	{
+		const size_t nbTriangles = getNbTriangles();
+
+		std::vector<Vector3D> centers(nbTriangles);
+		std::vector<size_t> order(nbTriangles);
+		for (size_t i = 0; i < nbTriangles; ++i)
+		{
+			centers[i] = (vertices[indices[i * 3]] + vertices[indices[i * 3 + 1]] + vertices[indices[i * 3 + 2]]) / 3.0f;
+			order[i] = i;
+		}
+
+		nodes.clear();
+		nodes.push_back(Node());
+		buildNode(0,0,nbTriangles,centers,order);
+
+		// Reorders the triangles so that the triangles of a leaf are contiguous
+		std::vector<unsigned int> sortedIndices(indices.size());
+		for (size_t i = 0; i < nbTriangles; ++i)
+			for (size_t j = 0; j < 3; ++j)
+				sortedIndices[i * 3 + j] = indices[order[i] * 3 + j];
+		indices.swap(sortedIndices);
+	}
+
+	void TriangleMesh::buildNode(size_t nodeIndex,size_t begin,size_t end,const std::vector<Vector3D>& centers,std::vector<size_t>& order)
+	{
+		if (end - begin <= MAX_TRIANGLES_PER_LEAF)
+		{
+			nodes[nodeIndex].first = begin;
+			nodes[nodeIndex].count = end - begin;
+			return;
+		}
+
+		// Splits at the median of the centers along the longest axis
+		// The depth of the hierarchy is therefore logarithmic which bounds the size of the traversal stacks
+		Vector3D centersMin(centers[order[begin]]);
+		Vector3D centersMax(centers[order[begin]]);
+		for (size_t i = begin + 1; i < end; ++i)
+		{
+			centersMin.setMin(centers[order[i]]);
+			centersMax.setMax(centers[order[i]]);
+		}
+
+		const Vector3D extent(centersMax - centersMin);
+		size_t axis = 0;
+		if (extent.y > extent.x) axis = 1;
+		if (extent.z > extent[axis]) axis = 2;
+
+		const size_t middle = (begin + end) >> 1;
+		std::nth_element(order.begin() + begin,order.begin() + middle,order.begin() + end,CompareTriangleCenter(centers,axis));
+
+		// Children are stored after their parent so that the hierarchy can be refitted from the end
+		const size_t childIndex = nodes.size();
+		nodes.push_back(Node());
+		nodes.push_back(Node());
+		nodes[nodeIndex].first = childIndex;
+		nodes[nodeIndex].count = 0;
+
+		buildNode(childIndex,begin,middle,centers,order);
+		buildNode(childIndex + 1,middle,end,centers,order);
+	}
+
+	void TriangleMesh::refitHierarchy()
+	{
+		for (size_t i = nodes.size(); i > 0; --i)
+		{
+			Node& node = nodes[i - 1];
+			if (node.count == 0)
+			{
+				const Node& child0 = nodes[node.first];
+				const Node& child1 = nodes[node.first + 1];
+				node.boundsMin = child0.boundsMin;
+				node.boundsMax = child0.boundsMax;
+				node.boundsMin.setMin(child1.boundsMin);
+				node.boundsMax.setMax(child1.boundsMax);
+			}
+			else
+			{
+				node.boundsMin = node.boundsMax = tVertices[indices[node.first * 3]];
+				for (size_t j = node.first * 3 + 1; j < (node.first + node.count) * 3; ++j)
+				{
+					node.boundsMin.setMin(tVertices[indices[j]]);
+					node.boundsMax.setMax(tVertices[indices[j]]);
+				}
+			}
+		}
+	}
+
+	void TriangleMesh::innerUpdateTransform()
+	{
+		Zone::innerUpdateTransform();
+
+		// Vertices are kept relative to the transformed position so that moving the zone does not need to update them
+		tVertices.resize(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i)
+			transformDir(tVertices[i],vertices[i]);
+
+		refitHierarchy();
+
+		// Cumulated areas are used to pick triangles uniformly on the surface
+		const size_t nbTriangles = getNbTriangles();
+		cumulatedAreas.resize(nbTriangles);
+		float totalArea = 0.0f;
+		for (size_t i = 0; i < nbTriangles; ++i)
+		{
+			const Vector3D& a = tVertices[indices[i * 3]];
+			totalArea += crossProduct(tVertices[indices[i * 3 + 1]] - a,tVertices[indices[i * 3 + 2]] - a).getNorm() * 0.5f;
+			cumulatedAreas[i] = totalArea;
+		}
+	}
+
+	void TriangleMesh::generatePosition(Vector3D& v,bool full,float radius) const
+	{
+		if (cumulatedAreas.empty() || cumulatedAreas.back() <= 0.0f)
+		{
+			v = getTransformedPosition();
+			return;
+		}
+
+		if (full)
+		{
+			// Random positions are drawn in the bounds until one is inside the mesh
+			const Node& root = nodes[0];
+			for (size_t i = 0; i < MAX_GENERATION_TRIES; ++i)
+			{
+				v = getTransformedPosition() + SPK_RANDOM(root.boundsMin,root.boundsMax);
+				if (TriangleMesh::contains(v,radius))
+					return;
+			}
+			// If no position was found, a position on the surface is generated
+		}
+
+		size_t triangle = std::upper_bound(cumulatedAreas.begin(),cumulatedAreas.end(),SPK_RANDOM(0.0f,cumulatedAreas.back())) - cumulatedAreas.begin();
+		if (triangle >= getNbTriangles())
+			triangle = getNbTriangles() - 1;
+
+		float u = SPK_RANDOM(0.0f,1.0f);
+		float w = SPK_RANDOM(0.0f,1.0f);
+		if (u + w > 1.0f)
+		{
+			u = 1.0f - u;
+			w = 1.0f - w;
+		}
+
+		const Vector3D& a = tVertices[indices[triangle * 3]];
+		const Vector3D& b = tVertices[indices[triangle * 3 + 1]];
+		const Vector3D& c = tVertices[indices[triangle * 3 + 2]];
+		v = getTransformedPosition() + a + (b - a) * u + (c - a) * w;
+	}
+
+	bool TriangleMesh::contains(const Vector3D& v,float radius) const
+	{
+		if (nodes.empty())
+			return false;
+
+		const Vector3D d(v - getTransformedPosition());
+		if (!isInside(d))
+			return false;
+
+		// The sphere is contained if no triangle is closer than its radius
+		if (radius > 0.0f)
+		{
+			Vector3D closestPoint;
+			size_t triangle;
+			if (findClosestPoint(d,radius * radius,closestPoint,triangle))
+				return false;
+		}
+
+		return true;
+	}
+
+	bool TriangleMesh::intersects(const Vector3D& v0,const Vector3D& v1,float radius,Vector3D* normal) const
+	{
+		if (nodes.empty())
+			return false;
+
+		return intersectsSegment(v0 - getTransformedPosition(),v1 - getTransformedPosition(),radius,normal);
+	}
+
+	Vector3D TriangleMesh::computeNormal(const Vector3D& v) const
+	{
+		const Vector3D d(v - getTransformedPosition());
+
+		Vector3D closestPoint;
+		size_t triangle = 0;
+		if (nodes.empty() || !findClosestPoint(d,std::numeric_limits<float>::max(),closestPoint,triangle))
+		{
+			Vector3D normal(d);
+			normalizeOrRandomize(normal);
+			return normal;
+		}
+
+		// The normal goes from the closest point of the surface towards the point
+		Vector3D normal(d - closestPoint);
+		if (!normal.normalize()) // The point is on the surface
+			normal = getTriangleNormal(triangle);
+		return normal;
+	}
+
+	void TriangleMesh::containsBatch(const Vector3D* v,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = TriangleMesh::contains(v[i],radii != NULL ? radii[i] : 0.0f) ? 1 : 0; // Static call to avoid the virtual dispatch
+	}
+
+	void TriangleMesh::intersectsBatch(const Vector3D* v0,const Vector3D* v1,const float* radii,size_t nb,unsigned char* mask) const
+	{
+		for (size_t i = 0; i < nb; ++i)
+			mask[i] = TriangleMesh::intersects(v0[i],v1[i],radii != NULL ? radii[i] : 0.0f) ? 1 : 0; // Static call to avoid the virtual dispatch
+	}
+
+	void TriangleMesh::computeBounds(Vector3D& boundsMin,Vector3D& boundsMax) const
+	{
+		boundsMin = boundsMax = getTransformedPosition();
+		if (!nodes.empty())
+		{
+			boundsMin += nodes[0].boundsMin;
+			boundsMax += nodes[0].boundsMax;
+		}
+	}
+
+	bool TriangleMesh::intersectsSegment(const Vector3D& d0,const Vector3D& d1,float radius,Vector3D* normal) const
+	{
+		Vector3D segmentMin(d0);
+		Vector3D segmentMax(d0);
+		segmentMin.setMin(d1);
+		segmentMax.setMax(d1);
+		segmentMin -= radius;
+		segmentMax += radius;
+
+		const Vector3D direction(d1 - d0);
+		float minRatio = std::numeric_limits<float>::max();
+		bool intersect = false;
+
+		size_t stack[MAX_STACK_SIZE];
+		size_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const Node& node = nodes[stack[--stackSize]];
+			if (segmentMin.x > node.boundsMax.x || segmentMin.y > node.boundsMax.y || segmentMin.z > node.boundsMax.z
+				|| segmentMax.x < node.boundsMin.x || segmentMax.y < node.boundsMin.y || segmentMax.z < node.boundsMin.z)
+				continue;
+
+			if (node.count == 0)
+			{
+				stack[stackSize++] = node.first;
+				stack[stackSize++] = node.first + 1;
+				continue;
+			}
+
+			for (size_t i = node.first; i < node.first + node.count; ++i)
+			{
+				const Vector3D& a = tVertices[indices[i * 3]];
+				const Vector3D& b = tVertices[indices[i * 3 + 1]];
+				const Vector3D& c = tVertices[indices[i * 3 + 2]];
+
+				Vector3D triangleNormal(crossProduct(b - a,c - a));
+				if (!triangleNormal.normalize()) // Degenerated triangle
+					continue;
+
+				// The triangle is moved towards the start of the segment by the radius
+				if (dotProduct(d0 - a,triangleNormal) < 0.0f)
+					triangleNormal.revert();
+				const Vector3D offset(triangleNormal * radius);
+
+				float ratio;
+				if (intersectsTriangle(d0,direction,a + offset,b + offset,c + offset,ratio) && ratio <= 1.0f && ratio < minRatio)
+				{
+					minRatio = ratio;
+					intersect = true;
+					if (normal != NULL)
+						*normal = triangleNormal;
+				}
+			}
+		}
+
+		return intersect;
+	}
+
+	bool TriangleMesh::isInside(const Vector3D& d) const
+	{
+		// The direction is not aligned with the axes to avoid going along the edges of axis aligned meshes
+		// As all its components are positive, the entry distance of a slab is always given by its minimum
+		const Vector3D direction(0.6f,0.64f,0.48f);
+		const Vector3D invDirection(1.0f / direction.x,1.0f / direction.y,1.0f / direction.z);
+
+		size_t nbCrossings = 0;
+
+		size_t stack[MAX_STACK_SIZE];
+		size_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const Node& node = nodes[stack[--stackSize]];
+
+			// Slab test of the ray against the bounds of the node
+			float entry = 0.0f;
+			float exit = std::numeric_limits<float>::max();
+			for (size_t i = 0; i < 3; ++i)
+			{
+				const float t0 = (node.boundsMin[i] - d[i]) * invDirection[i];
+				const float t1 = (node.boundsMax[i] - d[i]) * invDirection[i];
+				if (t0 > entry) entry = t0;
+				if (t1 < exit) exit = t1;
+			}
+
+			if (entry > exit)
+				continue;
+
+			if (node.count == 0)
+			{
+				stack[stackSize++] = node.first;
+				stack[stackSize++] = node.first + 1;
+				continue;
+			}
+
+			for (size_t i = node.first; i < node.first + node.count; ++i)
+			{
+				float ratio;
+				if (intersectsTriangle(d,direction,tVertices[indices[i * 3]],tVertices[indices[i * 3 + 1]],tVertices[indices[i * 3 + 2]],ratio))
+					++nbCrossings;
+			}
+		}
+
+		return (nbCrossings & 1) != 0;
+	}
+
+	bool TriangleMesh::findClosestPoint(const Vector3D& d,float maxSqrDist,Vector3D& closestPoint,size_t& triangle) const
+	{
+		float minSqrDist = maxSqrDist;
+		bool found = false;
+
+		size_t stack[MAX_STACK_SIZE];
+		size_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const Node& node = nodes[stack[--stackSize]];
+			if (getSqrDistToBox(d,node.boundsMin,node.boundsMax) >= minSqrDist)
+				continue;
+
+			if (node.count == 0)
+			{
+				stack[stackSize++] = node.first;
+				stack[stackSize++] = node.first + 1;
+				continue;
+			}
+
+			for (size_t i = node.first; i < node.first + node.count; ++i)
+			{
+				const Vector3D point(computeClosestPoint(d,tVertices[indices[i * 3]],tVertices[indices[i * 3 + 1]],tVertices[indices[i * 3 + 2]]));
+				const float sqrDist = getSqrDist(point,d);
+				if (sqrDist < minSqrDist)
+				{
+					minSqrDist = sqrDist;
+					closestPoint = point;
+					triangle = i;
+					found = true;
+				}
+			}
+		}
+
+		return found;
+	}
+
+	Vector3D TriangleMesh::getTriangleNormal(size_t triangle) const
+	{
+		const Vector3D& a = tVertices[indices[triangle * 3]];
+		Vector3D normal(crossProduct(tVertices[indices[triangle * 3 + 1]] - a,tVertices[indices[triangle * 3 + 2]] - a));
+		normalizeOrRandomize(normal);
+		return normal;
+	}
+
+	bool TriangleMesh::intersectsTriangle(const Vector3D& origin,const Vector3D& direction,const Vector3D& a,const Vector3D& b,const Vector3D& c,float& ratio)
+	{
+		// Moller-Trumbore algorithm
+		const Vector3D edge0(b - a);
+		const Vector3D edge1(c - a);
+		const Vector3D p(crossProduct(direction,edge1));
+
+		const float det = dotProduct(edge0,p);
+		if (det == 0.0f) // The ray is parallel to the triangle
+			return false;
+
+		const float invDet = 1.0f / det;
+		const Vector3D s(origin - a);
+		const float u = dotProduct(s,p) * invDet;
+		if (u < 0.0f || u > 1.0f)
+			return false;
+
+		const Vector3D q(crossProduct(s,edge0));
+		const float v = dotProduct(direction,q) * invDet;
+		if (v < 0.0f || u + v > 1.0f)
+			return false;
+
+		ratio = dotProduct(edge1,q) * invDet;
+		return ratio >= 0.0f;
+	}
+
+	Vector3D TriangleMesh::computeClosestPoint(const Vector3D& p,const Vector3D& a,const Vector3D& b,const Vector3D& c)
+	{
+		// Finds the region of the triangle (vertex, edge or face) where the projection of p lies
+		const Vector3D ab(b - a);
+		const Vector3D ac(c - a);
+
+		const Vector3D ap(p - a);
+		const float d1 = dotProduct(ab,ap);
+		const float d2 = dotProduct(ac,ap);
+		if (d1 <= 0.0f && d2 <= 0.0f)
+			return a;
+
+		const Vector3D bp(p - b);
+		const float d3 = dotProduct(ab,bp);
+		const float d4 = dotProduct(ac,bp);
+		if (d3 >= 0.0f && d4 <= d3)
+			return b;
+
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+			return a + ab * (d1 / (d1 - d3));
+
+		const Vector3D cp(p - c);
+		const float d5 = dotProduct(ab,cp);
+		const float d6 = dotProduct(ac,cp);
+		if (d6 >= 0.0f && d5 <= d6)
+			return c;
+
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+			return a + ac * (d2 / (d2 - d6));
+
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+			return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+		const float invSum = 1.0f / (va + vb + vc);
+		return a + ab * (vb * invSum) + ac * (vc * invSum);
+	}
+
+	float TriangleMesh::getSqrDistToBox(const Vector3D& p,const Vector3D& boxMin,const Vector3D& boxMax)
+	{
+		float sqrDist = 0.0f;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			if (p[i] < boxMin[i])
+				sqrDist += (boxMin[i] - p[i]) * (boxMin[i] - p[i]);
+			else if (p[i] > boxMax[i])
+				sqrDist += (p[i] - boxMax[i]) * (p[i] - boxMax[i]);
+		}
+		return sqrDist;
+	}
+}
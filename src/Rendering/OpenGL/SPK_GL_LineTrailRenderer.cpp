@@ -19,8 +19,6 @@
 // 3. This notice may not be removed or altered from any source distribution.	//
 //////////////////////////////////////////////////////////////////////////////////
 
-#include <cstring> // for memmove and memcpy
-
 #include <SPARK_Core.h>
 #include "Rendering/OpenGL/SPK_GL_LineTrailRenderer.h"
 
@@ -67,10 +65,10 @@ namespace GL
 	void GLLineTrailRenderer::createData(DataSet& dataSet,const Group& group) const
 	{
 		dataSet.init(NB_DATA);
-		dataSet.setData(VERTEX_BUFFER_INDEX,SPK_NEW(Vector3DArrayData,group.getCapacity(),nbSamples + 2));
-		dataSet.setData(COLOR_BUFFER_INDEX,SPK_NEW(ColorArrayData,group.getCapacity(),nbSamples + 2));
+		dataSet.setData(POSITION_DATA_INDEX,SPK_NEW(Vector3DArrayData,group.getCapacity(),nbSamples));
+		dataSet.setData(COLOR_DATA_INDEX,SPK_NEW(ColorArrayData,group.getCapacity(),nbSamples));
 		dataSet.setData(AGE_DATA_INDEX,SPK_NEW(FloatArrayData,group.getCapacity(),nbSamples));
-		dataSet.setData(START_ALPHA_DATA_INDEX,SPK_NEW(ArrayData<unsigned char>,group.getCapacity(),nbSamples));
+		dataSet.setData(HEAD_DATA_INDEX,SPK_NEW(ArrayData<size_t>,group.getCapacity(),1));
 
 		// Inits the buffers
 		for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
@@ -90,85 +88,102 @@ namespace GL
 	void GLLineTrailRenderer::init(const Particle& particle,DataSet* dataSet) const
 	{
 		size_t index = particle.getIndex();
-		Vector3D* vertexIt = SPK_GET_DATA(Vector3DArrayData,dataSet,VERTEX_BUFFER_INDEX).getParticleData(index);
-		Color* colorIt = SPK_GET_DATA(ColorArrayData,dataSet,COLOR_BUFFER_INDEX).getParticleData(index);
+		Vector3D* positionIt = SPK_GET_DATA(Vector3DArrayData,dataSet,POSITION_DATA_INDEX).getParticleData(index);
+		Color* colorIt = SPK_GET_DATA(ColorArrayData,dataSet,COLOR_DATA_INDEX).getParticleData(index);
 		float* ageIt = SPK_GET_DATA(FloatArrayData,dataSet,AGE_DATA_INDEX).getParticleData(index);
-		unsigned char* startAlphaIt = SPK_GET_DATA(ArrayData<unsigned char>,dataSet,START_ALPHA_DATA_INDEX).getParticleData(index);
 
 		// Gets the particle's values
 		const Vector3D& pos = particle.position();
 		const Color& color = particle.getColor();
 		float age = particle.getAge();
 
-		// Inits position
-		for (size_t i = 0; i < nbSamples + 2; ++i)
-			*(vertexIt++) = pos;
-
-		// Inits color
-		*(colorIt++) = degeneratedColor; // degenerate pre vertex
+		// Inits the samples
 		for (size_t i = 0; i < nbSamples; ++i)
+		{
+			*(positionIt++) = pos;
 			*(colorIt++) = color;
-		*colorIt = degeneratedColor; // degenerate post vertex
-
-		// Inits age
-		for (size_t i = 0; i < nbSamples; ++i)
 			*(ageIt++) = age;
+		}
 
-		// Inits start alpha
-		for (size_t i = 0; i < nbSamples; ++i)
-			*(startAlphaIt++) = color.a;
+		SPK_GET_DATA(ArrayData<size_t>,dataSet,HEAD_DATA_INDEX).getData()[index] = 0;
 	}
 
 	void GLLineTrailRenderer::update(const Group& group,DataSet* dataSet) const
 	{
-		Vector3D* vertexIt = SPK_GET_DATA(Vector3DArrayData,dataSet,VERTEX_BUFFER_INDEX).getData();
-		Color* colorIt = SPK_GET_DATA(ColorArrayData,dataSet,COLOR_BUFFER_INDEX).getData();
-		float* ageIt = SPK_GET_DATA(FloatArrayData,dataSet,AGE_DATA_INDEX).getData();
-		unsigned char* startAlphaIt = SPK_GET_DATA(ArrayData<unsigned char>,dataSet,START_ALPHA_DATA_INDEX).getData();
+		Vector3D* positions = SPK_GET_DATA(Vector3DArrayData,dataSet,POSITION_DATA_INDEX).getData();
+		Color* colors = SPK_GET_DATA(ColorArrayData,dataSet,COLOR_DATA_INDEX).getData();
+		float* ages = SPK_GET_DATA(FloatArrayData,dataSet,AGE_DATA_INDEX).getData();
+		size_t* heads = SPK_GET_DATA(ArrayData<size_t>,dataSet,HEAD_DATA_INDEX).getData();
 
 		float ageStep = duration / (nbSamples - 1);
-		for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		for (size_t i = 0; i < group.getNbParticles(); ++i)
 		{
-			const Particle& particle = *particleIt;
+			const Particle particle = group.getParticle(i);
 			float age = particle.getAge();
 
-			if (age - *(ageIt + 1) >= ageStep) // shifts the data by one
-			{
-				std::memmove(vertexIt + 2,vertexIt + 1,(nbSamples - 1) * sizeof(Vector3D));
-				std::memmove(colorIt + 2,colorIt + 1,(nbSamples - 1) * sizeof(Color));
-				std::memmove(ageIt + 1,ageIt,(nbSamples - 1) * sizeof(float));
-				std::memmove(startAlphaIt + 1,startAlphaIt,(nbSamples - 1) * sizeof(unsigned char));
+			// The sample i of the ring is at (head + i) % nbSamples
+			size_t& head = heads[i];
+			const size_t offset = i * nbSamples;
+			const size_t previous = head + 1 < nbSamples ? head + 1 : 0;
 
-				// post degenerated vertex copy
-				std::memcpy(vertexIt + (nbSamples + 1),vertexIt + nbSamples,sizeof(Vector3D));
-			}
+			if (age - ages[offset + previous] >= ageStep) // the current sample is kept and a new one is started over the oldest
+				head = head > 0 ? head - 1 : nbSamples - 1;
 
 			// Updates the current sample
-			*(vertexIt++) = particle.position();
-			std::memcpy(vertexIt,vertexIt - 1,sizeof(Vector3D));
-			vertexIt += nbSamples + 1;
+			positions[offset + head] = particle.position();
+			colors[offset + head] = particle.getColor();
+			ages[offset + head] = age;
+		}
+	}
 
-			++colorIt; // skips post degenerated vertex color
-			*(colorIt++) = particle.getColor();
-			*(startAlphaIt++) = particle.getColor().a;
+	void GLLineTrailRenderer::fillBuffers(const Group& group,const DataSet* dataSet,Vector3D* vertices,Color* colors) const
+	{
+		const Vector3D* positions = SPK_GET_DATA(const Vector3DArrayData,dataSet,POSITION_DATA_INDEX).getData();
+		const Color* sampleColors = SPK_GET_DATA(const ColorArrayData,dataSet,COLOR_DATA_INDEX).getData();
+		const float* ages = SPK_GET_DATA(const FloatArrayData,dataSet,AGE_DATA_INDEX).getData();
+		const size_t* heads = SPK_GET_DATA(const ArrayData<size_t>,dataSet,HEAD_DATA_INDEX).getData();
 
-			*(ageIt++) = age;
+		for (size_t i = 0; i < group.getNbParticles(); ++i)
+		{
+			const size_t offset = i * nbSamples;
+			const size_t head = heads[i];
+			const float age = ages[offset + head];
+
+			*(vertices++) = positions[offset + head]; // degenerate pre vertex
+			*(colors++) = degeneratedColor;
 
-			// Updates alpha
-			for (size_t i = 0; i < nbSamples - 1; ++i)
+			// Unrolls the ring from the newest sample to the oldest
+			for (size_t j = 0, index = head; j < nbSamples; ++j)
 			{
-				float ratio = 1.0f - (age - *(ageIt++)) / duration;
-				(colorIt++)->a = static_cast<unsigned char>(*(startAlphaIt++) * (ratio > 0.0f ? ratio : 0.0f));
+				*(vertices++) = positions[offset + index];
+
+				float ratio = 1.0f - (age - ages[offset + index]) / duration;
+				*colors = sampleColors[offset + index];
+				(colors++)->a = static_cast<unsigned char>(sampleColors[offset + index].a * (ratio > 0.0f ? ratio : 0.0f));
+
+				if (++index == nbSamples)
+					index = 0;
 			}
-			++colorIt;
+
+			*vertices = *(vertices - 1); // degenerate post vertex
+			++vertices;
+			*(colors++) = degeneratedColor;
 		}
 	}
 
 	void GLLineTrailRenderer::render(const Group& group,const DataSet* dataSet,RenderBuffer* renderBuffer) const
 	{
-		// RenderBuffer is not used as dataset already contains organized data for rendering
-		const Vector3D* vertexBuffer = SPK_GET_DATA(const Vector3DArrayData,dataSet,VERTEX_BUFFER_INDEX).getData();
-		const Color* colorBuffer = SPK_GET_DATA(const ColorArrayData,dataSet,COLOR_BUFFER_INDEX).getData();
+		// RenderBuffer is not used as the trails are built from the data set
+		if (group.getNbParticles() == 0)
+			return;
+
+		const size_t nbVertices = group.getNbParticles() * (nbSamples + 2);
+		if (vertexBuffer.size() < nbVertices)
+		{
+			vertexBuffer.resize(nbVertices);
+			colorBuffer.resize(nbVertices);
+		}
+		fillBuffers(group,dataSet,&vertexBuffer[0],&colorBuffer[0]);
 
 		initBlending();
 		initRenderingOptions();
@@ -181,10 +196,10 @@ namespace GL
 		glEnableClientState(GL_VERTEX_ARRAY);
 		glEnableClientState(GL_COLOR_ARRAY);
 
-		glVertexPointer(3,GL_FLOAT,0,vertexBuffer);
-		glColorPointer(4,GL_UNSIGNED_BYTE,0,colorBuffer);
+		glVertexPointer(3,GL_FLOAT,0,&vertexBuffer[0]);
+		glColorPointer(4,GL_UNSIGNED_BYTE,0,&colorBuffer[0]);
 
-		glDrawArrays(GL_LINE_STRIP,0,group.getNbParticles() * (nbSamples + 2));
+		glDrawArrays(GL_LINE_STRIP,0,nbVertices);
 
 		glDisableClientState(GL_VERTEX_ARRAY);
 		glDisableClientState(GL_COLOR_ARRAY);
@@ -192,18 +207,14 @@ namespace GL
 
 	void GLLineTrailRenderer::computeAABB(Vector3D& AABBMin,Vector3D& AABBMax,const Group& group,const DataSet* dataSet) const
 	{
-		const Vector3D* vertexIt = SPK_GET_DATA(const Vector3DArrayData,dataSet,VERTEX_BUFFER_INDEX).getData();
+		// The order of the samples does not matter here so the rings are read as they are
+		const Vector3D* positionIt = SPK_GET_DATA(const Vector3DArrayData,dataSet,POSITION_DATA_INDEX).getData();
+		const Vector3D* positionEnd = positionIt + group.getNbParticles() * nbSamples;
 
-		for (ConstGroupIterator particleIt(group); !particleIt.end(); ++particleIt)
+		for (; positionIt != positionEnd; ++positionIt)
 		{
-			++vertexIt; // skips pre degenerated vertex
-			for (size_t i = 0; i < nbSamples; ++i)
-			{
-				AABBMin.setMin(*vertexIt);
-				AABBMax.setMax(*vertexIt);
-				++vertexIt;
-			}
-			++vertexIt; // skips post degenerated vertex
+			AABBMin.setMin(*positionIt);
+			AABBMax.setMax(*positionIt);
 		}
 	}
 }}